@@ -0,0 +1,136 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "AsyncStateWriter.h"
+#include "DisplayInterface.h"
+#include "Logger.h"
+#include "StateCompressor.h"
+
+
+AsyncStateWriter::AsyncStateWriter(DisplayInterface *displayInterface, const LoggerConfig *loggerConfig) :
+    displayInterface(displayInterface),
+    loggerConfig(loggerConfig),
+    thread(),
+    jobs(),
+    writing(false),
+    quit(false)
+{
+
+}
+
+
+AsyncStateWriter::~AsyncStateWriter()
+{
+    if (!thread.joinable())
+        return;
+
+    // Pending saves are still written, so quitting right after saving doesn't lose the save.
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    jobAdded.notify_one();
+
+    thread.join();
+}
+
+
+void AsyncStateWriter::Write(const std::string &filename, std::vector<uint8_t> &&snapshot)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push(Job{filename, std::move(snapshot)});
+
+        if (!thread.joinable())
+            thread = std::thread(&AsyncStateWriter::ThreadFunc, this);
+    }
+    jobAdded.notify_one();
+}
+
+
+void AsyncStateWriter::Flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    jobFinished.wait(lock, [this]() {return jobs.empty() && !writing;});
+}
+
+
+bool AsyncStateWriter::WriteFile(const std::string &filename, const std::vector<uint8_t> &snapshot)
+{
+    std::vector<uint8_t> compressed;
+    StateCompressor::Compress(snapshot.data(), snapshot.size(), compressed);
+
+    // Open a temp file so that errors writing don't mess up an existing save file. The temp file is next to the save
+    // file, so instances saving at the same time don't use the same directory, and the rename stays on one filesystem.
+    std::vector<char> tempFilenameBuf(filename.begin(), filename.end());
+    const char tempSuffix[] = ".XXXXXX";
+    tempFilenameBuf.insert(tempFilenameBuf.end(), tempSuffix, tempSuffix + sizeof(tempSuffix));
+    char *tempFilename = tempFilenameBuf.data();
+    int fd = mkstemp(tempFilename);
+    FILE *file = fd < 0 ? NULL : fdopen(fd, "w");
+    if (file == NULL)
+    {
+        LogError("Error opening save state file %s: %s", tempFilename, strerror(errno));
+        if (fd >= 0)
+        {
+            close(fd);
+            unlink(tempFilename);
+        }
+        return false;
+    }
+
+    bool success = fwrite(compressed.data(), compressed.size(), 1, file) == 1;
+    success &= fclose(file) == 0;
+
+    if (success == false)
+    {
+        LogError("Error writing save state file %s", tempFilename);
+        unlink(tempFilename);
+        return false;
+    }
+
+    if (rename(tempFilename, filename.c_str()))
+    {
+        LogError("Error renaming temp save state file %s to %s: %s", tempFilename, filename.c_str(), strerror(errno));
+        unlink(tempFilename);
+        return false;
+    }
+
+    LogError("Saved state to %s, compressed %zu bytes to %zu", filename.c_str(), snapshot.size(), compressed.size());
+
+    return true;
+}
+
+
+void AsyncStateWriter::ThreadFunc()
+{
+    Logger::SetThreadConfig(loggerConfig);
+
+    while (true)
+    {
+        Job job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAdded.wait(lock, [this]() {return quit || !jobs.empty();});
+            if (jobs.empty())
+                return;
+
+            job = std::move(jobs.front());
+            jobs.pop();
+            writing = true;
+        }
+
+        bool success = WriteFile(job.filename, job.snapshot);
+        displayInterface->SaveStateComplete(job.filename, success);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            writing = false;
+        }
+        jobFinished.notify_all();
+    }
+}
\ No newline at end of file
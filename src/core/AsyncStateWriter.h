@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gbemu.h"
+
+class DisplayInterface;
+struct LoggerConfig;
+
+
+// Writes save state files on a background thread, so the emulation thread only waits while the snapshot is taken.
+// Snapshots are compressed with StateCompressor on the writer thread as well. Each file is written to a temp file next
+// to it and renamed over it, so a failed write never damages an existing save. When a queued write is done,
+// SaveStateComplete() is called on the DisplayInterface from the writer thread.
+class AsyncStateWriter
+{
+public:
+    AsyncStateWriter(DisplayInterface *displayInterface, const LoggerConfig *loggerConfig);
+    ~AsyncStateWriter();
+
+    // Queues a snapshot to be written to filename. The writer thread is started on the first call.
+    void Write(const std::string &filename, std::vector<uint8_t> &&snapshot);
+
+    // Blocks until all queued snapshots have been written.
+    void Flush();
+
+    // Compresses and writes a snapshot on the calling thread. Returns false and logs the reason on error.
+    static bool WriteFile(const std::string &filename, const std::vector<uint8_t> &snapshot);
+
+    // Don't allow copy and assignment.
+    AsyncStateWriter(const AsyncStateWriter&) = delete;
+    void operator=(const AsyncStateWriter&) = delete;
+
+private:
+    struct Job
+    {
+        std::string filename;
+        std::vector<uint8_t> snapshot;
+    };
+
+    void ThreadFunc();
+
+    DisplayInterface *displayInterface;
+    const LoggerConfig *loggerConfig;
+
+    std::thread thread;
+    std::queue<Job> jobs;
+    bool writing;
+    bool quit;
+
+    std::mutex mutex;
+    std::condition_variable jobAdded;
+    std::condition_variable jobFinished;
+};
\ No newline at end of file
@@ -108,9 +108,15 @@ Audio::Audio(IoRegisterSubject *ioRegisterSubject, TimerSubject *timerSubject,
     channel2("2"),
     channel3(),
     channel4(),
+    savedChannel1("1"),
+    savedChannel2("2"),
+    savedChannel3(),
+    savedChannel4(),
     sampleCounter(0),
     bufferSize(0),
     masterVolume(0),
+    outputEnabled(true),
+    timeScale(0),
     regNR10(ioRegisterSubject->AttachIoRegister(eRegNR10, this)),
     regNR11(ioRegisterSubject->AttachIoRegister(eRegNR11, this)),
     regNR12(ioRegisterSubject->AttachIoRegister(eRegNR12, this)),
@@ -168,6 +174,24 @@ Audio::~Audio()
 }
 
 
+void Audio::SaveChannels()
+{
+    savedChannel1 = channel1;
+    savedChannel2 = channel2;
+    savedChannel3 = channel3;
+    savedChannel4 = channel4;
+}
+
+
+void Audio::RestoreChannels()
+{
+    channel1 = savedChannel1;
+    channel2 = savedChannel2;
+    channel3 = savedChannel3;
+    channel4 = savedChannel4;
+}
+
+
 bool Audio::WriteByte(uint16_t address, uint8_t byte)
 {
     LogAudio("Audio::WriteByte %04X, %02X", address, byte);
@@ -441,6 +465,9 @@ uint8_t Audio::ReadByte(uint16_t address) const
 
 void Audio::UpdateTimer(uint value)
 {
+    if (!outputEnabled)
+        return;
+
     sampleCounter += value;
 
     if ((*regNR52 & eNR52AllSoundOn) == 0 || audioInterface->GetAudioEnabled() == false)
@@ -504,8 +531,18 @@ void Audio::UpdateTimer(uint value)
 }
 
 
+void Audio::SetTimeScale(double scale)
+{
+    timeScale = scale;
+    clocksPerSample = (CLOCKS_PER_SECOND / audioInterface->GetAudioSampleRate()) * (scale > 0 ? scale : 1);
+}
+
+
 void Audio::UpdateGameSpeed(int value)
 {
+    if (timeScale > 0)
+        return;
+
     if (value == 0)
     {
         // Figure out what to do with this.
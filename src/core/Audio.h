@@ -17,6 +17,20 @@ public:
           AudioInterface *audioInterface, GameSpeedSubject *gameSpeedSubject);
     virtual ~Audio();
 
+    // Audio state isn't part of snapshots. While output is disabled, the channels don't advance and no samples are
+    // produced, so frames that are run and then undone don't change the sound.
+    void SetOutputEnabled(bool enabled) {outputEnabled = enabled;}
+
+    // Register writes still trigger notes and reload counters while output is disabled. To undo frames, save the
+    // channels before running them, and restore the channels after the registers are restored from a snapshot.
+    void SaveChannels();
+    void RestoreChannels();
+
+    // Plays the sound scale times faster than the game makes it, by taking samples further apart, so audio keeps up
+    // when the game runs faster than normal. Game speed updates are ignored while a scale is set. 0 goes back to
+    // following them, starting from normal speed.
+    void SetTimeScale(double scale);
+
     // Inherited from IoRegisterProxy.
     virtual bool WriteByte(uint16_t address, uint8_t byte);
     virtual uint8_t ReadByte(uint16_t address) const;
@@ -35,6 +49,11 @@ private:
     WaveformChannel channel3;
     NoiseChannel channel4;
 
+    SquareWaveChannel savedChannel1;
+    SquareWaveChannel savedChannel2;
+    WaveformChannel savedChannel3;
+    NoiseChannel savedChannel4;
+
     uint32_t sampleCounter;
 
     std::array<int16_t, AudioInterface::BUFFER_LEN> soundBuffer;
@@ -43,6 +62,8 @@ private:
     uint32_t clocksPerSample;
 
     uint8_t masterVolume;
+    bool outputEnabled;
+    double timeScale;
 
     uint8_t *regNR10; // Sound mode 1, sweep
     uint8_t *regNR11; // Sound mode 1, length/wave pattern duty
@@ -22,6 +22,9 @@ public:
     virtual Channels GetEnabledAudioChannels() = 0;
     virtual uint8_t GetAudioVolume() = 0;
     virtual int GetGameSpeed() = 0;
+    // How full the output's buffer is, from 0 to 1, or a negative value if it isn't known. FramePacer uses this to
+    // follow the audio device's clock.
+    virtual double GetAudioBufferFill() {return -1;}
 
 protected:
     ~AudioInterface() {}
@@ -7,6 +7,7 @@
 #include "MemoryByteProxy.h"
 #include "RegisterByteProxy.h"
 #include "Timer.h"
+#include "TraceRecorder.h"
 
 const char *Cpu::regNameMap8Bit[8] = {"B", "C", "D", "E", "H", "L", "(HL)", "A"};
 const char *Cpu::regNameMap16Bit[4] = {"BC", "DE", "HL", "SP"};
@@ -21,7 +22,8 @@ Cpu::Cpu(Interrupt *interrupts, Memory *memory, Timer *timer) :
     timer(timer),
     enableInterruptsDelay(false),
     halted(false),
-    haltBug(false)
+    haltBug(false),
+    traceRecorder(NULL)
 {
     regMap8Bit[0] = &reg.b;
     regMap8Bit[1] = &reg.c;
@@ -246,6 +248,21 @@ void Cpu::ProcessInterrupt(eInterruptTypes intType)
 }
 
 
+void Cpu::RecordTrace()
+{
+    const uint16_t pc = reg.pc;
+
+    // Read the bytes one at a time, so an opcode at the end of memory wraps around.
+    const uint8_t opcode[3] = {
+        memory->ReadRawByte(pc),
+        memory->ReadRawByte(pc + 1),
+        memory->ReadRawByte(pc + 2)
+    };
+
+    traceRecorder->Record(reg, opcode, memory->GetCurRomBank(), timer->GetClockCount());
+}
+
+
 void Cpu::ProcessOpCode()
 {
     // Check for any waiting interrupts and process.
@@ -280,6 +297,9 @@ void Cpu::ProcessOpCode()
         enableInterruptsDelay = false;
     }
 
+    if (traceRecorder)
+        RecordTrace();
+
     uint8_t opcode = ReadPC8Bit();
 
     switch (opcode)
@@ -1581,38 +1601,38 @@ void Cpu::ProcessOpCode()
 }
 
 
-bool Cpu::SaveState(FILE *file)
+bool Cpu::SaveState(StateWriter &writer)
 {
-    if (!fwrite(&reg, sizeof(reg), 1, file))
+    if (!writer.Write(&reg, sizeof(reg)))
         return false;
 
-    if (!fwrite(&enableInterruptsDelay, sizeof(enableInterruptsDelay), 1, file))
+    if (!writer.Write(&enableInterruptsDelay, sizeof(enableInterruptsDelay)))
         return false;
 
-    if (!fwrite(&halted, sizeof(halted), 1, file))
+    if (!writer.Write(&halted, sizeof(halted)))
         return false;
 
-    if (!fwrite(&haltBug, sizeof(haltBug), 1, file))
+    if (!writer.Write(&haltBug, sizeof(haltBug)))
         return false;
 
     return true;
 }
 
 
-bool Cpu::LoadState(uint16_t version, FILE *file)
+bool Cpu::LoadState(uint16_t version, StateReader &reader)
 {
     (void)version;
 
-    if (!fread(&reg, sizeof(reg), 1, file))
+    if (!reader.Read(&reg, sizeof(reg)))
         return false;
 
-    if (!fread(&enableInterruptsDelay, sizeof(enableInterruptsDelay), 1, file))
+    if (!reader.Read(&enableInterruptsDelay, sizeof(enableInterruptsDelay)))
         return false;
 
-    if (!fread(&halted, sizeof(halted), 1, file))
+    if (!reader.Read(&halted, sizeof(halted)))
         return false;
 
-    if (!fread(&haltBug, sizeof(haltBug), 1, file))
+    if (!reader.Read(&haltBug, sizeof(haltBug)))
         return false;
 
     return true;
@@ -6,6 +6,7 @@
 #include "AbsByteProxy.h"
 #include "Interrupt.h"
 #include "Logger.h"
+#include "StateBuffer.h"
 
 // Yes, I know that this is probably Undefined Behavior in Standard C++. Type punning works in C (at least in GCC), but I'm having
 // trouble nailing down whether it is accepted in G++. And I know about the the "warning: ISO C++ prohibits anonymous structs"
@@ -84,6 +85,7 @@ typedef std::unique_ptr<AbsByteProxy> ByteProxy;
 class Interrupt;
 class Memory;
 class Timer;
+class TraceRecorder;
 
 class Cpu
 {
@@ -107,6 +109,10 @@ public:
 
     void ProcessOpCode();
 
+    // When set, each instruction is recorded just before it's executed. Interrupt dispatch and halted cycles aren't
+    // instructions, so they aren't recorded.
+    void SetTraceRecorder(TraceRecorder *traceRecorder) {this->traceRecorder = traceRecorder;}
+
     inline void ClearFlags()
     {
         reg.flags.z = reg.flags.n = reg.flags.h = reg.flags.c = 0;
@@ -118,8 +124,8 @@ public:
                reg.a, reg.b, reg.c, reg.d, reg.e, reg.h, reg.l, reg.pc, reg.sp, reg.flags.z, reg.flags.n, reg.flags.h, reg.flags.c/*, interrupts->Enabled()*/);
     }
 
-    bool SaveState(FILE *file);
-    bool LoadState(uint16_t version, FILE *file);
+    bool SaveState(StateWriter &writer);
+    bool LoadState(uint16_t version, StateReader &reader);
 
     Registers reg;
 
@@ -128,6 +134,7 @@ private:
     void NotYetImplemented();
 
     void ProcessInterrupt(eInterruptTypes intType);
+    void RecordTrace();
 
     Interrupt *interrupts;
     Memory *memory;
@@ -135,6 +142,7 @@ private:
     bool enableInterruptsDelay;
     bool halted;
     bool haltBug;
+    TraceRecorder *traceRecorder;
 
     uint8_t *regMap8Bit[8];
     uint16_t *regMap16Bit[4];
@@ -1,22 +1,19 @@
 #include <algorithm>
 #include <memory>
 #include <sstream>
+#include <string.h>
 #include <unistd.h>
 
 #include "Display.h"
 #include "DisplayInterface.h"
-#include "Globals.h"
 #include "Logger.h"
 #include "Memory.h"
-
-const uint TILE_DATA_SIZE = 16; // Tile is 16 bytes.
-const uint TILE_PIXEL_SIZE = 8; // Tile is 8x8 pixels.
+#include "TripleFrameBuffer.h"
 
 const uint REAL_SCREEN_SIZE = 256;
 const uint REAL_TILES_PER_SCREEN = REAL_SCREEN_SIZE / TILE_PIXEL_SIZE;
 
 const uint16_t BG_TILE_MAP[] = {0x9800, 0x9C00};
-const uint16_t BG_DATA_OFFSET[] = {0x8800, 0x8000};
 const uint16_t OAM_RAM = 0xFE00;
 const uint16_t OAM_LEN = 0x00A0;
 
@@ -24,12 +21,9 @@ const uint16_t CLOCKS_PER_SCANLINE = 456;
 const uint8_t MODE2_CLOCKS = 80;
 const uint8_t MODE3_BASE_CLOCKS = 168;
 
-const uint8_t MAX_SPRITES_PER_SCANLINE = 10;
 const uint8_t SPRITE_X_DISPLAY_OFFSET = 8;
 const uint8_t SPRITE_Y_DISPLAY_OFFSET = 16;
 
-const uint8_t palette[4][3] = {{0xFF, 0xFF, 0xFF}, {0xB0, 0xB0, 0xB0}, {0x68, 0x68, 0x68}, {0x00, 0x00, 0x00}};
-
 enum LCDCBits
 {
     eLCDCBGEnabled = 0x01,
@@ -60,7 +54,8 @@ enum SpriteAttrBits
 };
 
 
-Display::Display(Memory *memory, Interrupt *interrupts, DisplayInterface *displayInterface, TimerSubject *timerSubject) :
+Display::Display(Memory *memory, Interrupt *interrupts, DisplayInterface *displayInterface, TimerSubject *timerSubject,
+                 TripleFrameBuffer *frameBuffers) :
     memory(memory),
     interrupts(interrupts),
     regLCDC(memory->AttachIoRegister(eRegLCDC, this)),
@@ -76,49 +71,72 @@ Display::Display(Memory *memory, Interrupt *interrupts, DisplayInterface *displa
     regWX(memory->AttachIoRegister(eRegWX, this)),
     displayMode(eMode0HBlank),
     mode3Clocks(MODE3_BASE_CLOCKS),
+    ownedFrameBuffers(frameBuffers ? NULL : new TripleFrameBuffer()),
+    frameBuffers(frameBuffers ? frameBuffers : ownedFrameBuffers),
+    frameBuffer(this->frameBuffers->GetBackBuffer()),
+    tileCache(memory),
+    applyPalette(ScanlineCompositor::GetApplyPalette(ScanlineCompositor::GetBestVersion())),
+    spriteLines(),
+    spriteLinesSize(0),
+    drawnLines(),
+    changedLines(),
+    publishedFrame(NULL),
     counter(0),
+    frameCount(0),
+    renderEnabled(true),
     displayInterface(displayInterface)
 {
     timerSubject->AttachObserver(this);
+
+    UpdatePalettes();
+
+    // Nothing has been shown yet, so the first frame is all new.
+    changedLines.set();
 }
 
 
 Display::~Display()
 {
-
+    delete ownedFrameBuffers;
 }
 
 
-bool Display::SaveState(FILE *file)
+bool Display::SaveState(StateWriter &writer)
 {
-    if (!fwrite(&displayMode, sizeof(displayMode), 1, file))
+    if (!writer.Write(&displayMode, sizeof(displayMode)))
         return false;
 
-    if (!fwrite(&counter, sizeof(counter), 1, file))
+    if (!writer.Write(&counter, sizeof(counter)))
         return false;
 
     return true;
 }
 
 
-bool Display::LoadState(uint16_t version, FILE *file)
+bool Display::LoadState(uint16_t version, StateReader &reader)
 {
     (void)version;
 
-    if (!fread(&displayMode, sizeof(displayMode), 1, file))
+    if (!reader.Read(&displayMode, sizeof(displayMode)))
         return false;
 
-    if (!fread(&counter, sizeof(counter), 1, file))
+    if (!reader.Read(&counter, sizeof(counter)))
         return false;
 
-    // Update framebuffer so the first frame isn't garbage.
-    for (uint i = 0; i < SCREEN_Y; i++)
-        DrawScanline(i);
+    // The palette registers were loaded with the rest of memory, without going through WriteByte().
+    UpdatePalettes();
 
     return true;
 }
 
 
+void Display::RedrawFrame()
+{
+    for (uint i = 0; i < SCREEN_Y; i++)
+        DrawScanline(i);
+}
+
+
 bool Display::WriteByte(uint16_t address, uint8_t byte)
 {
     LogInstruction("Display::WriteByte %04X, %02X", address, byte);
@@ -152,12 +170,15 @@ bool Display::WriteByte(uint16_t address, uint8_t byte)
             return true;
         case eRegBGP:
             *regBGP = byte;
+            bgPalette.SetRegister(byte);
             return true;
         case eRegOBP0:
             *regOBP0 = byte;
+            obp0Palette.SetRegister(byte);
             return true;
         case eRegOBP1:
             *regOBP1 = byte;
+            obp1Palette.SetRegister(byte);
             return true;
         case eRegWY:
             *regWY = byte;
@@ -250,6 +271,44 @@ void Display::UpdateTimer(uint value)
 }
 
 
+void Display::UpdateSpriteLines()
+{
+    const uint8_t spriteSize = (*regLCDC & eLCDCSpriteSize) ? 16 : 8;
+    if (!memory->IsOamDirty() && spriteLinesSize == spriteSize)
+        return;
+
+    for (SpriteLine &spriteLine : spriteLines)
+        spriteLine.count = 0;
+
+    // Each scanline gets the first 10 sprites in OAM that are on it. They're kept sorted so the sprite with the lowest
+    // X is drawn last, and for sprites with the same X, the one with the lowest OAM index. Sprites are added in OAM
+    // order, so a new sprite goes before the ones with the same X.
+    const uint8_t * const oamRam = memory->GetBytePtr(OAM_RAM);
+    for (uint8_t i = 0; i < OAM_LEN; i += 4)
+    {
+        const int yPos = oamRam[i + 0] - SPRITE_Y_DISPLAY_OFFSET;
+        const uint8_t x = oamRam[i + 1];
+        const int firstLine = std::max(yPos, 0);
+        const int endLine = std::min(yPos + spriteSize, (int)SCREEN_Y);
+
+        for (int scanline = firstLine; scanline < endLine; scanline++)
+        {
+            SpriteLine &spriteLine = spriteLines[scanline];
+            if (spriteLine.count == MAX_SPRITES_PER_SCANLINE)
+                continue;
+
+            uint8_t pos = spriteLine.count++;
+            for (; pos > 0 && oamRam[spriteLine.sprites[pos - 1] + 1] <= x; pos--)
+                spriteLine.sprites[pos] = spriteLine.sprites[pos - 1];
+            spriteLine.sprites[pos] = i;
+        }
+    }
+
+    memory->ClearOamDirty();
+    spriteLinesSize = spriteSize;
+}
+
+
 uint16_t Display::GetMode3ClockCount(uint8_t scanline)
 {
     uint16_t base = MODE3_BASE_CLOCKS;
@@ -262,23 +321,20 @@ uint16_t Display::GetMode3ClockCount(uint8_t scanline)
         base += 6;
 
     // Add delay for each sprite on this scanline.
-    const uint8_t spriteSize = (*regLCDC & eLCDCSpriteSize) ? 16 : 8;
     const uint8_t * const oamRam = memory->GetBytePtr(OAM_RAM);
-    for (uint8_t i = 0; i < OAM_LEN; i += 4)
+    const SpriteLine &spriteLine = spriteLines[scanline];
+    for (uint n = 0; n < spriteLine.count; n++)
     {
-        const int16_t yPos = oamRam[i + 0] - SPRITE_Y_DISPLAY_OFFSET;
-        const int16_t xPos = oamRam[i + 1] - SPRITE_X_DISPLAY_OFFSET;
-        if (scanline >= yPos && scanline < (yPos + spriteSize))
-        {
-            uint8_t scx;
-            if ((*regLCDC & eLCDCWindowEnable) && (scanline >= *regWY))
-                scx = 255 - *regWX;
-            else
-                scx = *regSCX;
-
-            // The delay depends on where in the X position the sprite is in relation to tile boundaries.
-            base += 11 - std::min(5, (xPos + scx) & 7);
-        }
+        const int16_t xPos = oamRam[spriteLine.sprites[n] + 1] - SPRITE_X_DISPLAY_OFFSET;
+
+        uint8_t scx;
+        if ((*regLCDC & eLCDCWindowEnable) && (scanline >= *regWY))
+            scx = 255 - *regWX;
+        else
+            scx = *regSCX;
+
+        // The delay depends on where in the X position the sprite is in relation to tile boundaries.
+        base += 11 - std::min(5, (xPos + scx) & 7);
     }
 
     return base;
@@ -296,9 +352,13 @@ void Display::SetMode(DisplayModes mode)
     *regSTAT &= 0xFC;
     *regSTAT |= mode;
 
-    // Figure out how long mode 3 will last. Do this during the first mode (mode 2) per scanline.
+    // Find the sprites on the scanline, and figure out how long mode 3 will last. Do this during the first mode
+    // (mode 2) per scanline.
     if (displayMode == eMode2SearchingOAM)
+    {
+        UpdateSpriteLines();
         mode3Clocks = GetMode3ClockCount(*regLY);
+    }
 }
 
 
@@ -306,7 +366,7 @@ void Display::UpdateScanline()
 {
     counter = 0;
 
-    if (*regLY < 144)
+    if (*regLY < 144 && renderEnabled)
         DrawScanline(*regLY);
 
     *regLY = (*regLY + 1) % 154;
@@ -347,52 +407,60 @@ bool Display::GetStatCheck()
 }
 
 
+void Display::SetShades(Palette::Shades shades)
+{
+    bgPalette.SetShades(shades);
+    obp0Palette.SetShades(shades);
+    obp1Palette.SetShades(shades);
+}
+
+
+void Display::UpdatePalettes()
+{
+    bgPalette.SetRegister(*regBGP);
+    obp0Palette.SetRegister(*regOBP0);
+    obp1Palette.SetRegister(*regOBP1);
+}
+
+
 void Display::DrawScanline(uint8_t scanline)
 {
     if (*regLCDC & eLCDCBGEnabled)
+    {
         DrawBackgroundScanline(scanline, *regSCX, *regSCY);
+    }
+    else
+    {
+        // The background is blank while it's disabled. The back buffer still holds an older frame, so the line has
+        // to be cleared rather than left alone.
+        std::fill_n(&frameBuffer[scanline * SCREEN_X], SCREEN_X, bgPalette.GetShadeColor(0));
+        std::fill_n(&bgColorMap[scanline * SCREEN_X], SCREEN_X, 0);
+    }
     if (*regLCDC & eLCDCWindowEnable)
         DrawWindowScanline(scanline, *regWX, *regWY);
     if (*regLCDC & eLCDCSpriteEnabled)
         DrawSprites(scanline);
+
+    // Keep track of the lines that changed, so a frame that's the same as the last one doesn't have to be shown again.
+    const uint32_t * const line = &frameBuffer[scanline * SCREEN_X];
+    uint32_t * const drawnLine = &drawnLines[scanline * SCREEN_X];
+    if (memcmp(line, drawnLine, SCREEN_X * sizeof(uint32_t)) != 0)
+    {
+        memcpy(drawnLine, line, SCREEN_X * sizeof(uint32_t));
+        changedLines[scanline] = true;
+    }
 }
 
 
 void Display::DrawBackgroundScanline(uint8_t scanline, uint8_t scrollX, uint8_t scrollY)
 {
-    const uint16_t tilesetDataOffset = (*regLCDC & eLCDCWindowTileset) ? BG_DATA_OFFSET[1] : BG_DATA_OFFSET[0];
-    const uint8_t * const tilesetData = memory->GetBytePtr(tilesetDataOffset);
     const uint16_t tileMapOffset = (*regLCDC & eLCDCBGTileMap) ? BG_TILE_MAP[1] : BG_TILE_MAP[0];
     const uint8_t * const tileMap = memory->GetBytePtr(tileMapOffset);
 
-    const uint y = scanline + scrollY;
-    const uint8_t tileY = (y / TILE_PIXEL_SIZE) & (REAL_TILES_PER_SCREEN - 1);
-
-    for (uint i = 0; i < SCREEN_X; i++)
-    {
-        const uint x = i + scrollX;
-        const uint8_t tileX = (x / TILE_PIXEL_SIZE) & (REAL_TILES_PER_SCREEN - 1);
-
-        uint8_t tileId = tileMap[tileX + (tileY * REAL_TILES_PER_SCREEN)];
-        if (tilesetDataOffset == BG_DATA_OFFSET[0])
-        {
-            // When BG data is 0x8800, tile id is a signed byte with 0 in the middle of the range.
-            tileId = (int8_t)tileId + 0x80;
-        }
-
-        const uint16_t tileDataOffset = (tileId * TILE_DATA_SIZE) + ((y & 7) * 2);
-        const uint8_t *tileData = &tilesetData[tileDataOffset];
-        const uint8_t lowBit = ((tileData[0] >> (7 - (x & 7))) & 0x01);
-        const uint8_t highBit = ((tileData[1] >> (7 - (x & 7))) & 0x01);
-        const uint8_t pixelVal = lowBit | (highBit << 1);
-        const uint8_t * const color = palette[(*regBGP >> (pixelVal * 2)) & 0x03];
-        const uint16_t pixelOffset = (scanline * SCREEN_X) + i;
-
-        // Save palette index for this pixel to use later for sprite priority.
-        bgColorMap[pixelOffset] = pixelVal;
+    const uint y = (scanline + scrollY) & (REAL_SCREEN_SIZE - 1);
+    const uint8_t tileY = y / TILE_PIXEL_SIZE;
 
-        frameBuffer[pixelOffset] = (color[0] << 16) | (color[1] << 8) | color[2];
-    }
+    DrawTileMapLine(scanline, 0, &tileMap[tileY * REAL_TILES_PER_SCREEN], scrollX, y & 7);
 }
 
 
@@ -405,89 +473,66 @@ void Display::DrawWindowScanline(uint8_t scanline, uint8_t windowX, uint8_t wind
 
     // wx is offset by 7.
     int wx = windowX - 7;
+    if (wx >= (int)SCREEN_X)
+        return;
 
-    const uint16_t tilesetDataOffset = (*regLCDC & eLCDCWindowTileset) ? BG_DATA_OFFSET[1] : BG_DATA_OFFSET[0];
-    const uint8_t * const tilesetData = memory->GetBytePtr(tilesetDataOffset);
     const uint16_t tileMapOffset = (*regLCDC & eLCDCWindowTileMap) ? BG_TILE_MAP[1] : BG_TILE_MAP[0];
     const uint8_t * const tileMap = memory->GetBytePtr(tileMapOffset);
 
     const uint y = scanline - windowY;
     const uint8_t tileY = (y / TILE_PIXEL_SIZE);
 
-    for (uint i = std::max(0, wx); i < SCREEN_X; i++)
-    {
-        const uint x = i - wx;
-        const uint8_t tileX = x / TILE_PIXEL_SIZE;
+    const uint startX = std::max(0, wx);
+    DrawTileMapLine(scanline, startX, &tileMap[tileY * REAL_TILES_PER_SCREEN], startX - wx, y & 7);
+}
 
-        uint8_t tileId = tileMap[tileX + (tileY * REAL_TILES_PER_SCREEN)];
-        if (tilesetDataOffset == BG_DATA_OFFSET[0])
-        {
-            // When BG data is 0x8800, tile id is a signed byte with 0 in the middle of the range.
-            tileId = (int8_t)tileId + 0x80;
-        }
 
-        const uint16_t tileDataOffset = (tileId * TILE_DATA_SIZE) + ((y & 7) * 2);
-        const uint8_t *tileData = &tilesetData[tileDataOffset];
-        const uint8_t lowBit = ((tileData[0] >> (7 - (x & 7))) & 0x01);
-        const uint8_t highBit = ((tileData[1] >> (7 - (x & 7))) & 0x01);
-        const uint8_t pixelVal = lowBit | (highBit << 1);
-        const uint8_t * const color = palette[(*regBGP >> (pixelVal * 2)) & 0x03];
-        const uint16_t pixelOffset = (scanline * SCREEN_X) + i;
+void Display::DrawTileMapLine(uint8_t scanline, uint startX, const uint8_t *tileMapRow, uint mapX, uint tileRow)
+{
+    const bool signedTileIds = (*regLCDC & eLCDCWindowTileset) == 0;
+    uint8_t * const colorLine = &bgColorMap[scanline * SCREEN_X];
+    uint32_t * const pixelLine = &frameBuffer[scanline * SCREEN_X];
 
-        // Save palette index for this pixel to use later for sprite priority.
-        bgColorMap[pixelOffset] = pixelVal;
+    // Copy the palette index of each pixel a tile at a time, and keep them for sprite priority.
+    for (uint i = startX; i < SCREEN_X;)
+    {
+        const uint x = (mapX + i - startX) & (REAL_SCREEN_SIZE - 1);
+
+        // When BG data is 0x8800, tile id is a signed byte with 0 in the middle of the range, at 0x9000.
+        const uint8_t tileId = tileMapRow[x / TILE_PIXEL_SIZE];
+        const uint tile = signedTileIds ? 0x100 + (int8_t)tileId : tileId;
 
-        frameBuffer[pixelOffset] = (color[0] << 16) | (color[1] << 8) | color[2];
+        const uint8_t * const pixels = tileCache.GetRow(tile, tileRow);
+        const uint count = std::min(TILE_PIXEL_SIZE - (x & 7), SCREEN_X - i);
+        memcpy(&colorLine[i], &pixels[x & 7], count);
+        i += count;
     }
+
+    applyPalette(&colorLine[startX], bgPalette.GetColors(), &pixelLine[startX], SCREEN_X - startX);
 }
 
 
 void Display::DrawSprites(uint8_t scanline)
 {
-    const uint8_t spriteSize = (*regLCDC & eLCDCSpriteSize) ? 16 : 8;
-    const uint8_t * const oamRam = memory->GetBytePtr(OAM_RAM);
-    const uint8_t * const spriteData = memory->GetBytePtr(BG_DATA_OFFSET[1]);
-
-    std::vector<SpriteData> sprites;
-    sprites.reserve(MAX_SPRITES_PER_SCANLINE);
+    // The sprites are usually found in mode 2 already, but OAM can change before the scanline is drawn, and frames
+    // redrawn after loading a state don't go through mode 2.
+    UpdateSpriteLines();
 
-    uint8_t spriteCount = 0;
-
-    // Find all sprites on scanline.
-    for (uint8_t i = 0; i < OAM_LEN; i += 4)
-    {
-        const int16_t yPos = oamRam[i + 0] - SPRITE_Y_DISPLAY_OFFSET;
-        const int16_t xPos = oamRam[i + 1] - SPRITE_X_DISPLAY_OFFSET;
-
-        // Add sprites that are on this scanline.
-        if (scanline >= yPos && scanline < (yPos + spriteSize))
-        {
-            // GB can only display 10 sprites per scanline.
-            spriteCount++;
-            if (spriteCount > MAX_SPRITES_PER_SCANLINE)
-                break;
-
-            // Sprites with a 0 x position aren't displayed, but still count towards the number of sprites drawn.
-            if (xPos + SPRITE_X_DISPLAY_OFFSET > 0)
-                sprites.push_back({xPos, i});
-        }
-    }
-
-    // Return if there are no sprites to draw on this scanline.
-    if (sprites.size() == 0)
-        return;
-
-    // Sort sprites according to x and i priority.
-    std::sort(sprites.begin(), sprites.end(), Display::SpriteSort);
+    const uint8_t spriteSize = spriteLinesSize;
+    const uint8_t * const oamRam = memory->GetBytePtr(OAM_RAM);
+    const SpriteLine &spriteLine = spriteLines[scanline];
 
-    for (const SpriteData &sprite : sprites)
+    // Sprites with a 0 x position aren't displayed, but still count towards the 10 on the scanline. They're entirely
+    // off the left side, so nothing of them is drawn.
+    for (uint n = 0; n < spriteLine.count; n++)
     {
-        const uint8_t i = sprite.i;
+        const uint8_t i = spriteLine.sprites[n];
         const int16_t yPos = oamRam[i + 0] - SPRITE_Y_DISPLAY_OFFSET;
         const int16_t xPos = oamRam[i + 1] - SPRITE_X_DISPLAY_OFFSET;
         uint8_t spriteId = oamRam[i + 2];
         const uint8_t spriteAttr = oamRam[i + 3];
-        const uint8_t paletteReg = (spriteAttr & eSpriteAttrPalette) ? *regOBP1 : *regOBP0;
+        const uint32_t * const colors =
+            (spriteAttr & eSpriteAttrPalette) ? obp1Palette.GetColors() : obp0Palette.GetColors();
         const bool flipX = spriteAttr & eSpriteAttrFlipX;
         const bool flipY = spriteAttr & eSpriteAttrFlipY;
         const bool bgPriority = spriteAttr & eSpriteAttrBgPriority;
@@ -499,47 +544,61 @@ void Display::DrawSprites(uint8_t scanline)
         uint8_t line = (scanline - yPos); // TODO: is this right?
         if (flipY)
             line = (spriteSize - 1) - line;
-        const uint16_t spriteDataOffset = (spriteId * TILE_DATA_SIZE) + (line * 2);
-        const uint8_t * const tileData = &spriteData[spriteDataOffset];
+
+        // The bottom half of an 8x16 sprite is the next tile.
+        const uint tile = spriteId + line / TILE_PIXEL_SIZE;
+        const uint8_t * const pixels = tileCache.GetRow(tile, line % TILE_PIXEL_SIZE, flipX);
 
         for (uint i = 0; i < TILE_PIXEL_SIZE; i++)
         {
-            // xPos can be < 0 if the sprite is only partially on-screen.
-            if (xPos + (int)i < 0)
+            // Sprites can be partly off either side of the screen.
+            const int x = xPos + (int)i;
+            if (x < 0 || x >= (int)SCREEN_X)
                 continue;
 
-            uint x = i;
-            if (flipX)
-                x = (TILE_PIXEL_SIZE - 1) - i;
-            const uint8_t lowBit = ((tileData[0] >> (7 - x)) & 0x01);
-            const uint8_t highBit = ((tileData[1] >> (7 - x)) & 0x01);
-            const uint8_t pixelVal = lowBit | (highBit << 1);
-
             // Sprite color 0 is transparent.
+            const uint8_t pixelVal = pixels[i];
             if (pixelVal == 0)
                 continue;
 
-            const uint8_t * const color = palette[(paletteReg >> (pixelVal * 2)) & 0x03];
-            const uint16_t pixelOffset = (scanline * SCREEN_X) + xPos + i;
+            const uint16_t pixelOffset = (scanline * SCREEN_X) + x;
 
             // Only draw pixel if background doesn't have priority, or background is 0.
             if (!bgPriority || (bgPriority && bgColorMap[pixelOffset] == 0))
-                frameBuffer[pixelOffset] = (color[0] << 16) | (color[1] << 8) | color[2];
+                frameBuffer[pixelOffset] = colors[pixelVal];
         }
     }
 }
 
 
-void Display::DrawScreen()
+void Display::PresentFrame()
 {
-    displayInterface->FrameReady(frameBuffer);
+    PublishFrame();
+
+    // The frame that carries on from here is drawn into a different buffer, which needs the lines above LY as well.
+    RedrawFrame();
 }
 
 
-bool Display::SpriteSort(const SpriteData &a, const SpriteData &b)
+void Display::DrawScreen()
 {
-    if (a.x == b.x)
-        return a.i > b.i;
+    frameCount++;
+    if (!renderEnabled)
+        return;
 
-    return a.x > b.x;
-}
\ No newline at end of file
+    // The back buffer holds the same frame as the last one published, so that one stays the newest frame.
+    if (changedLines.none() && publishedFrame != NULL)
+        displayInterface->FrameUnchanged(publishedFrame);
+    else
+        PublishFrame();
+}
+
+
+void Display::PublishFrame()
+{
+    const ScanlineMask publishedLines = changedLines;
+    publishedFrame = frameBuffers->Publish(publishedLines);
+    frameBuffer = frameBuffers->GetBackBuffer();
+    changedLines.reset();
+    displayInterface->FrameReady(publishedFrame, publishedLines);
+}
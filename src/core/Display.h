@@ -1,24 +1,53 @@
 #pragma once
 
+#include <bitset>
+
 #include "gbemu.h"
 #include "IoRegisterProxy.h"
 #include "Interrupt.h"
+#include "Palette.h"
+#include "ScanlineCompositor.h"
+#include "StateBuffer.h"
+#include "TileCache.h"
 #include "TimerObserver.h"
 
 class DisplayInterface;
 class Memory;
+class TripleFrameBuffer;
 
 const uint SCREEN_X = 160;
 const uint SCREEN_Y = 144;
+const uint8_t MAX_SPRITES_PER_SCANLINE = 10;
+
+// One bit per scanline of a frame, such as the lines that changed since the frame before.
+typedef std::bitset<SCREEN_Y> ScanlineMask;
 
 class Display : public IoRegisterProxy, public TimerObserver
 {
 public:
-    Display(Memory *memory, Interrupt *interrupts, DisplayInterface *displayInterface, TimerSubject *timerSubject);
+    // Frames are drawn straight into the back buffer of frameBuffers, and published to it when they're finished. If
+    // frameBuffers is NULL, the display keeps its own.
+    Display(Memory *memory, Interrupt *interrupts, DisplayInterface *displayInterface, TimerSubject *timerSubject,
+            TripleFrameBuffer *frameBuffers = NULL);
     virtual ~Display();
 
-    bool SaveState(FILE *file);
-    bool LoadState(uint16_t version, FILE *file);
+    bool SaveState(StateWriter &writer);
+    bool LoadState(uint16_t version, StateReader &reader);
+
+    // The frame buffer isn't part of the state. After loading a state, this redraws it from the current VRAM and
+    // registers, so the first frame isn't garbage.
+    void RedrawFrame();
+
+    // Publishes the frame buffer and passes it to the DisplayInterface again, without counting it as a new frame. This
+    // always publishes it, even if it's the same as the last frame.
+    void PresentFrame();
+
+    // While rendering is disabled, scanlines aren't drawn and finished frames aren't passed to the DisplayInterface,
+    // but frames are still counted. Timing and interrupts are the same either way.
+    void SetRenderEnabled(bool enabled) {renderEnabled = enabled;}
+
+    // Colors the 4 shades are drawn in. Takes effect from the next scanline.
+    void SetShades(Palette::Shades shades);
 
     // Inherited from IoRegisterProxy.
     virtual bool WriteByte(uint16_t address, uint8_t byte);
@@ -27,6 +56,11 @@ public:
     // Inherited from TimerObserver.
     virtual void UpdateTimer(uint value);
 
+    // Number of frames drawn since the display was created.
+    uint64_t GetFrameCount() const {return frameCount;}
+    // The frame count isn't part of the state, so it's put back by hand when frames are run and then undone.
+    void SetFrameCount(uint64_t frameCount) {this->frameCount = frameCount;}
+
 private:
     enum DisplayModes
     {
@@ -36,12 +70,15 @@ private:
         eMode3TranferData = 3,
     };
 
-    struct SpriteData
+    // Sprites on a scanline, as OAM offsets, in the order they're drawn. Ones drawn later are on top.
+    struct SpriteLine
     {
-        int16_t x;
-        uint8_t i;
+        uint8_t count;
+        uint8_t sprites[MAX_SPRITES_PER_SCANLINE];
     };
 
+    // Finds the sprites on every scanline again if OAM or the sprite size changed since they were last found.
+    void UpdateSpriteLines();
     uint16_t GetMode3ClockCount(uint8_t scanline);
     void SetMode(DisplayModes mode);
     void UpdateScanline();
@@ -53,10 +90,13 @@ private:
     void DrawWindowScanline(uint8_t scanline, uint8_t windowX, uint8_t windowY);
     void DrawSprites(uint8_t scanline);
     void DrawTileLine(uint8_t byte1, uint8_t byte2, uint8_t xPos, uint8_t yPos, uint8_t paletteReg, bool flipX, bool bgPriority, bool isBg);
+    // Draws a line of background or window tiles from startX to the end of the line. tileMapRow is the row of the
+    // tile map the line is in, mapX the X position in it that's drawn at startX, and tileRow the row in those tiles.
+    void DrawTileMapLine(uint8_t scanline, uint startX, const uint8_t *tileMapRow, uint mapX, uint tileRow);
+    void UpdatePalettes();
 
     void DrawScreen();
-
-    static bool SpriteSort(const SpriteData &a, const SpriteData &b);
+    void PublishFrame();
 
     Memory *memory;
     Interrupt *interrupts;
@@ -76,10 +116,28 @@ private:
     DisplayModes displayMode;
     uint16_t mode3Clocks;
 
-    uint32_t frameBuffer[SCREEN_X * SCREEN_Y];
+    TripleFrameBuffer *ownedFrameBuffers;
+    TripleFrameBuffer *frameBuffers;
+    uint32_t *frameBuffer;  // Back buffer of frameBuffers, the frame being drawn.
     uint8_t bgColorMap[SCREEN_X * SCREEN_Y];
+    TileCache tileCache;
+    // Colors of BGP, OBP0 and OBP1, updated when they're written.
+    Palette bgPalette;
+    Palette obp0Palette;
+    Palette obp1Palette;
+    ScanlineCompositor::ApplyPaletteFunc applyPalette;
+    SpriteLine spriteLines[SCREEN_Y];
+    uint8_t spriteLinesSize;  // Sprite height spriteLines was found with, or 0 if it has to be found again.
+
+    // Every line as it was last drawn, and which lines have been drawn differently since the last frame was published.
+    // Frames without changed lines aren't published again, see DisplayInterface::FrameUnchanged().
+    uint32_t drawnLines[SCREEN_X * SCREEN_Y];
+    ScanlineMask changedLines;
+    const uint32_t *publishedFrame;  // NULL until a frame has been published.
 
     uint16_t counter;
+    uint64_t frameCount;
+    bool renderEnabled;
 
     DisplayInterface *displayInterface;
 };
\ No newline at end of file
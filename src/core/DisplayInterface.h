@@ -1,14 +1,24 @@
 #pragma once
 
 #include "gbemu.h"
+#include "Display.h"
 
 class DisplayInterface
 {
 public:
     DisplayInterface() {}
 
-    virtual void FrameReady(uint32_t *frameBuffer) = 0;
+    // Called on the emulator thread for every finished frame. frameBuffer isn't drawn over until the next call. To show
+    // frames on another thread, take them from EmulatorMgr::AcquireFrame() instead of copying them here. changedLines
+    // are the lines that differ from the frame passed last time, so a copy of the frame only needs those updated.
+    virtual void FrameReady(const uint32_t *frameBuffer, const ScanlineMask &changedLines) = 0;
+    // Called instead of FrameReady() for a finished frame that's the same as the last one. It isn't published to
+    // EmulatorMgr::AcquireFrame() again, so anything that shows, records or sends frames can skip it. frameBuffer is
+    // the last frame. By default, it's passed to FrameReady() like any other frame.
+    virtual void FrameUnchanged(const uint32_t *frameBuffer) {FrameReady(frameBuffer, ScanlineMask());}
     virtual void RequestMessageBox(const std::string &message) = 0;
+    // Called from the save state writer thread when a save state file has been written, or failed to be.
+    virtual void SaveStateComplete(const std::string &filename, bool success) = 0;
 
 protected:
     ~DisplayInterface() {}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+#include "gbemu.h"
+
+struct LoggerConfig;
+
+// Settings that belong to one emulator instance instead of the whole process, so several instances can run at the
+// same time without sharing log output or clobbering each other's files.
+struct EmulatorContext
+{
+    // Logger config used while this instance is running. NULL uses the default config.
+    const LoggerConfig *loggerConfig = NULL;
+
+    // Serial output is appended to this file when there is no SerialInterface. Empty discards serial output.
+    std::string serialFilename = "serial.txt";
+
+    // When false, battery backed RAM isn't loaded from or saved to disk.
+    bool persistRam = true;
+};
\ No newline at end of file
@@ -1,8 +1,11 @@
+#include <algorithm>
+#include <chrono>
 #include <iterator>
 #include <fstream>
-#include <unistd.h>
+#include <stdexcept>
 
 #include "gbemu.h"
+#include "AsyncStateWriter.h"
 #include "Audio.h"
 #include "Cpu.h"
 #include "DebuggerInterface.h"
@@ -11,38 +14,173 @@
 #include "EmulatorMgr.h"
 #include "InfoInterface.h"
 #include "Input.h"
+#include "LinkInterface.h"
+#include "Logger.h"
 #include "Memory.h"
+#include "Movie.h"
+#include "RewindBuffer.h"
 #include "Serial.h"
+#include "SerialFileWriter.h"
+#include "StateBuffer.h"
+#include "StateCompressor.h"
+#include "StateHash.h"
 #include "Timer.h"
+#include "TraceRecorder.h"
+#include "TripleFrameBuffer.h"
+
+// Snapshots and save state files start with a magic number and a version.
+const char STATE_MAGIC[4] = {'Z', 'L', 'G', 'B'};
+const uint16_t STATE_VERSION = 3;
+const size_t STATE_HEADER_SIZE = sizeof(STATE_MAGIC) + sizeof(STATE_VERSION);
+
+// Since version 3 the header is followed by one chunk per object, in this order. The ROM chunk holds the hash of the
+// game, so a state for a different game is rejected. Chunks with other tags are skipped when loading.
+enum StateChunk
+{
+    eChunkRom,
+    eChunkMemory,
+    eChunkInterrupts,
+    eChunkTimer,
+    eChunkDisplay,
+    eChunkInput,
+    eChunkSerial,
+    eChunkCpu,
+    eChunkCount
+};
+
+const char STATE_CHUNK_TAGS[eChunkCount][STATE_CHUNK_TAG_SIZE + 1] = {
+    "ROM ", "MEM ", "INT ", "TIMR", "DISP", "INPT", "SERL", "CPU "
+};
+
+const double FRAME_NANOSECONDS = CLOCKS_PER_FRAME * 1e9 / CLOCKS_PER_SECOND;
+
+// While fast-forwarding with audio, the speed the audio is played at is measured over this many frames.
+const uint FAST_FORWARD_SPEED_FRAMES = 16;
+
+
+template <typename T>
+static bool WriteChunk(StateWriter &writer, StateChunk chunk, T *object)
+{
+    size_t chunkStart;
+    if (!writer.BeginChunk(STATE_CHUNK_TAGS[chunk], chunkStart) || !object->SaveState(writer))
+        return false;
+
+    writer.EndChunk(chunkStart);
+    return true;
+}
+
+
+// Saves a machine in the current format. Used for the running machine, and for the scratch machine that converts old
+// save states.
+static bool WriteState(StateWriter &writer, Memory *memory, Interrupt *interrupts, Timer *timer, Display *display,
+                       Input *input, Serial *serial, Cpu *cpu)
+{
+    bool success = true;
+
+    success &= writer.Write(STATE_MAGIC, sizeof(STATE_MAGIC));
+    success &= writer.Write(&STATE_VERSION, sizeof(STATE_VERSION));
+
+    size_t chunkStart;
+    const uint64_t romHash = memory->GetRomHash();
+    success &= writer.BeginChunk(STATE_CHUNK_TAGS[eChunkRom], chunkStart);
+    success &= writer.Write(&romHash, sizeof(romHash));
+    writer.EndChunk(chunkStart);
+
+    success &= WriteChunk(writer, eChunkMemory, memory);
+    success &= WriteChunk(writer, eChunkInterrupts, interrupts);
+    success &= WriteChunk(writer, eChunkTimer, timer);
+    success &= WriteChunk(writer, eChunkDisplay, display);
+    success &= WriteChunk(writer, eChunkInput, input);
+    success &= WriteChunk(writer, eChunkSerial, serial);
+    success &= WriteChunk(writer, eChunkCpu, cpu);
+
+    return success;
+}
+
+
+// Checks a chunk holds at least as much as the object saves, so loading it can't run out of data part way.
+template <typename T>
+static bool ChunkFits(const StateReader &chunk, T *object)
+{
+    StateWriter counter(NULL, 0);
+    object->SaveState(counter);
+    return chunk.GetRemaining() >= counter.GetSize();
+}
 
 
 EmulatorMgr::EmulatorMgr(DisplayInterface *displayInterface, AudioInterface *audioInterface, InfoInterface *infoInterface,
-                         DebuggerInterface *debuggerInterface, GameSpeedSubject *gameSpeedSubject) :
+                         DebuggerInterface *debuggerInterface, GameSpeedSubject *gameSpeedSubject,
+                         SerialInterface *serialInterface, const EmulatorContext &context) :
     paused(false),
     quit(false),
+    runThread(true),
     runBootRom(false),
     displayInterface(displayInterface),
     audioInterface(audioInterface),
     infoInterface(infoInterface),
     debuggerInterface(debuggerInterface),
     gameSpeedSubject(gameSpeedSubject),
+    serialInterface(serialInterface),
+    context(context),
     audio(NULL),
-    buttons(),
+    buttonData(0),
     cpu(NULL),
     display(NULL),
     input(NULL),
     interrupts(NULL),
     memory(NULL),
     serial(NULL),
-    timer(NULL)
+    timer(NULL),
+    stateWriter(new AsyncStateWriter(displayInterface, context.loggerConfig)),
+    frameBuffers(new TripleFrameBuffer()),
+    framePacer(audioInterface),
+    shades(Palette::eShadesGray),
+    traceRecorder(NULL),
+    serialFileWriter(NULL),
+    linkInterface(NULL),
+    linkCheckpoint(),
+    linkCheckpointFrameCount(0),
+    linkCheckpointLastFrameCount(0),
+    linkCheckpointClockCount(0),
+    linkCheckpointMovieButtons(),
+    lastFrameCount(0),
+    rewindBuffer(NULL),
+    rewinding(false),
+    runAheadFrames(0),
+    runAheadSnapshot(),
+    runAheadStats(),
+    fastForward(false),
+    fastForwardInterval(DEFAULT_FAST_FORWARD_INTERVAL),
+    fastForwardAudio(false),
+    fastForwardFrames(0),
+    fastForwardSpeedStart(),
+    movie(NULL),
+    movieActive(false),
+    movieRecording(false),
+    movieFilename(),
+    movieButtons(),
+    stateHashRecorder(NULL),
+    stateHashSnapshot()
 {
-
+    // Without a frontend endpoint, serial output goes to a file, which is how test ROMs report their results.
+    if (serialInterface == NULL && !context.serialFilename.empty())
+    {
+        serialFileWriter = new SerialFileWriter(context.serialFilename);
+        this->serialInterface = serialFileWriter;
+    }
 }
 
 
 EmulatorMgr::~EmulatorMgr()
 {
     EndEmulation();
+    StopTrace();
+    StopStateHashing();
+
+    delete stateWriter;
+    delete frameBuffers;
+    delete rewindBuffer;
+    delete serialFileWriter;
 }
 
 
@@ -62,8 +200,10 @@ void EmulatorMgr::LoadBootRom(const std::string &filename)
 }
 
 
-bool EmulatorMgr::LoadRom(const std::string &filename)
+bool EmulatorMgr::LoadRom(const std::string &filename, bool startThread)
 {
+    ScopedLoggerConfig loggerConfig(context.loggerConfig);
+
     EndEmulation();
 
     std::ifstream file(filename, std::ios::binary);
@@ -74,14 +214,18 @@ bool EmulatorMgr::LoadRom(const std::string &filename)
     ramFilename = romFilename + ".ram";
 
     quit = false;
+    runThread = startThread;
 
     memory = new Memory(infoInterface, debuggerInterface);
     interrupts = new Interrupt(memory);
     timer = new Timer(memory, interrupts);
-    display = new Display(memory, interrupts, displayInterface, timer);
+    display = new Display(memory, interrupts, displayInterface, timer, frameBuffers);
+    display->SetShades(shades);
     input = new Input(memory, interrupts);
-    serial = new Serial(memory, interrupts, timer);
+    serial = new Serial(memory, interrupts, timer, serialInterface);
+    serial->SetLinkInterface(linkInterface);
     cpu = new Cpu(interrupts, memory, timer);
+    cpu->SetTraceRecorder(traceRecorder);
     audio = new Audio(memory, timer, audioInterface, gameSpeedSubject);
 
     // This can't be done in the Memory constructor since Timer doesn't exist yet.
@@ -96,9 +240,13 @@ bool EmulatorMgr::LoadRom(const std::string &filename)
         memory->SetRomMemory(gameRomMemory);
         SetBootState(memory, cpu);
     }
-    memory->LoadRam(ramFilename);
+    if (context.persistRam)
+        memory->LoadRam(ramFilename);
 
-    workThread = std::thread(&EmulatorMgr::ThreadFunc, this);
+    ResetRewind();
+
+    if (runThread)
+        workThread = std::thread(&EmulatorMgr::ThreadFunc, this);
 
     return true;
 }
@@ -107,7 +255,7 @@ bool EmulatorMgr::LoadRom(const std::string &filename)
 void EmulatorMgr::ResetEmulation()
 {
     EndEmulation();
-    LoadRom(romFilename.c_str());
+    LoadRom(romFilename.c_str(), runThread);
 }
 
 
@@ -119,200 +267,520 @@ void EmulatorMgr::PauseEmulation(bool pause)
 
 void EmulatorMgr::EndEmulation()
 {
+    {
+        std::lock_guard<std::mutex> lock(saveStateMutex);
+        EndMovie();
+    }
+
     if (workThread.joinable())
     {
         quit = true;
         workThread.join();
     }
+    else if (memory != NULL)
+    {
+        // There is no worker thread to clean up after itself.
+        ScopedLoggerConfig loggerConfig(context.loggerConfig);
+        quit = true;
+        if (context.persistRam)
+            memory->SaveRam(ramFilename);
+        DeleteObjects();
+    }
 }
 
 
 void EmulatorMgr::ButtonPressed(Buttons::Button button)
 {
-    uint8_t oldButtonData = buttons.data;
+    // Set bit for button. The worker thread can read the buttons at any time, so the change is made in one step.
+    const uint8_t oldButtonData = buttonData.fetch_or(button);
 
-    // Set bit for button.
-    buttons.data |= button;
-
-    if (input && buttons.data != oldButtonData)
-        input->SetButtons(buttons);
+    // A movie hands buttons to the game at the end of each frame instead.
+    if (input && !movieActive && (oldButtonData | button) != oldButtonData)
+        input->SetButtons(GetButtons());
 }
 
 
 void EmulatorMgr::ButtonReleased(Buttons::Button button)
 {
-    uint8_t oldButtonData = buttons.data;
-
     // Clear bit for button.
-    buttons.data &= ~button;
+    const uint8_t oldButtonData = buttonData.fetch_and(~button);
 
-    if (input && buttons.data != oldButtonData)
-        input->SetButtons(buttons);
+    if (input && !movieActive && (oldButtonData & ~button) != oldButtonData)
+        input->SetButtons(GetButtons());
 }
 
 
-void EmulatorMgr::SaveState(int slot)
+uint64_t EmulatorMgr::Run(uint64_t maxClocks, uint64_t maxFrames)
 {
-    // Lock mutex to make the worker thread wait while the state is saved.
-    std::lock_guard<std::mutex> lock(saveStateMutex);
+    if (cpu == NULL || workThread.joinable())
+        return 0;
+
+    ScopedLoggerConfig loggerConfig(context.loggerConfig);
 
-    // Open a temp file so that errors writing don't mess up an existing save file.
-    char tempFilename[] = "tmpsav.XXXXXX";
-    int fd = mkstemp(tempFilename);
-    FILE *file = fdopen(fd, "w");
-    if (file == NULL)
+    quit = false;
+
+    const uint64_t startClocks = timer->GetClockCount();
+    const uint64_t endClocks = maxClocks ? startClocks + maxClocks : UINT64_MAX;
+    const uint64_t endFrames = maxFrames ? display->GetFrameCount() + maxFrames : UINT64_MAX;
+
+    try
     {
-        LogError("Error opening save state file %s: %s", tempFilename, strerror(errno));
-        displayInterface->RequestMessageBox("Error opening save state file");
-        return;
+        while (!quit && timer->GetClockCount() < endClocks && display->GetFrameCount() < endFrames)
+        {
+            cpu->ProcessOpCode();
+            if (linkInterface && linkInterface->GetRequest() != LinkInterface::eLinkRequestNone)
+                HandleLinkRequest();
+            if (display->GetFrameCount() != lastFrameCount)
+                FrameCompleted();
+        }
+    }
+    catch (const std::exception& e)
+    {
+        quit = true;
+        displayInterface->RequestMessageBox(e.what());
     }
 
-    bool success = true;
+    return timer->GetClockCount() - startClocks;
+}
 
-    // Write header.
-    if (!fwrite("ZLGB", 4, 1, file))
-        success = false;
 
-    // Write version.
-    const uint16_t version = 2;
-    if (!fwrite(&version, sizeof(version), 1, file))
-        success = false;
+const uint32_t *EmulatorMgr::AcquireFrame(ScanlineMask *changedLines)
+{
+    return frameBuffers->Acquire(changedLines);
+}
 
-    // Write data.
-    success &= memory->SaveState(file);
-    success &= interrupts->SaveState(file);
-    success &= timer->SaveState(file);
-    success &= display->SaveState(file);
-    success &= input->SaveState(file);
-    success &= serial->SaveState(file);
-    success &= cpu->SaveState(file);
 
-    fclose(file);
+uint64_t EmulatorMgr::GetDroppedFrames() const
+{
+    return frameBuffers->GetDroppedFrames();
+}
 
-    if (success == false)
-    {
-        LogError("Error saving state");
-        displayInterface->RequestMessageBox("Error saving state");
-        //unlink(tempFilename);
-        return;
-    }
+
+void EmulatorMgr::SaveState(int slot)
+{
+    ScopedLoggerConfig loggerConfig(context.loggerConfig);
 
     std::string saveFilename = romFilename + ".sav" + std::to_string(slot);
-    if (rename(tempFilename, saveFilename.c_str()))
+    std::vector<uint8_t> snapshot;
+    if (CaptureSnapshot(snapshot))
+        stateWriter->Write(saveFilename, std::move(snapshot));
+}
+
+
+bool EmulatorMgr::SaveStateToFile(const std::string &saveFilename)
+{
+    ScopedLoggerConfig loggerConfig(context.loggerConfig);
+
+    std::vector<uint8_t> snapshot;
+    if (!CaptureSnapshot(snapshot))
+        return false;
+
+    if (!AsyncStateWriter::WriteFile(saveFilename, snapshot))
     {
-        LogError("Error renaming temp save state file %s to %s: %s", tempFilename, saveFilename.c_str(), strerror(errno));
-        displayInterface->RequestMessageBox("Error renaming temp save state file");
-        return;
+        displayInterface->RequestMessageBox("Error saving state");
+        return false;
     }
 
-    LogError("Saved state to %s", saveFilename.c_str());
+    return true;
 }
 
 
 void EmulatorMgr::LoadState(int slot)
 {
     std::string loadFilename = romFilename + ".sav" + std::to_string(slot);
-    FILE *file = fopen(loadFilename.c_str(), "rb");
-    if (file == NULL)
+    LoadStateFromFile(loadFilename);
+}
+
+
+bool EmulatorMgr::LoadStateFromFile(const std::string &loadFilename)
+{
+    ScopedLoggerConfig loggerConfig(context.loggerConfig);
+
+    // A save to the same file may still be being written.
+    stateWriter->Flush();
+
+    std::ifstream file(loadFilename, std::ios::binary);
+    if (!file)
     {
         LogError("Error opening save state file %s: %s", loadFilename.c_str(), strerror(errno));
         displayInterface->RequestMessageBox("Error opening save state file");
-        return;
+        return false;
+    }
+    std::vector<uint8_t> snapshot((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Save states are written compressed. Files from before that are read as they are.
+    if (StateCompressor::IsCompressed(snapshot.data(), snapshot.size()))
+    {
+        std::vector<uint8_t> compressed;
+        compressed.swap(snapshot);
+        if (!StateCompressor::Decompress(compressed.data(), compressed.size(), snapshot))
+        {
+            LogError("Error decompressing save state file %s", loadFilename.c_str());
+            displayInterface->RequestMessageBox("Error decompressing save state file.");
+            return false;
+        }
     }
 
     // Read header.
-    const int headerLen = 4;
-    char header[headerLen + 1] = {0};
-    size_t cnt = fread(header, 1, headerLen, file);
-    if (cnt != headerLen)
+    if (snapshot.size() < STATE_HEADER_SIZE)
     {
-        LogError("Error reading header from save state file. Only read %u bytes.", cnt);
+        LogError("Error reading header from save state file. Only read %zu bytes.", snapshot.size());
         displayInterface->RequestMessageBox("Error reading header from save state file.");
-        fclose(file);
-        return;
+        return false;
     }
-    if (strcmp(header, "ZLGB"))
+    if (memcmp(&snapshot[0], STATE_MAGIC, sizeof(STATE_MAGIC)))
     {
-        LogError("Save state header doesn't match expected value: %s", header);
+        LogError("Save state header doesn't match expected value");
         displayInterface->RequestMessageBox("Save state header doesn't match expected value.");
-        fclose(file);
-        return;
+        return false;
     }
 
     // Get version.
-    uint16_t version = 0;
-    if (!fread(&version, 2, 1, file))
-    {
-        LogError("Error reading version from state file.");
-        displayInterface->RequestMessageBox("Error reading version from state file.");
-        fclose(file);
-        return;
-    }
+    uint16_t version;
+    memcpy(&version, &snapshot[sizeof(STATE_MAGIC)], sizeof(version));
     if (version == 0x3130)
     {
         // The first version of the save state format saved the version as ASCII "01".
         version = 1;
     }
 
-    // Create new objects so if there is an error loading, the current game doesn't get killed.
-    Memory *newMemory = new Memory(infoInterface, debuggerInterface);
-    Interrupt *newInterrupts = new Interrupt(newMemory);
-    Timer *newTimer = new Timer(newMemory, newInterrupts);
-    Display *newDisplay = new Display(newMemory, newInterrupts, displayInterface, newTimer);
-    Input *newInput = new Input(newMemory, newInterrupts);
-    Serial *newSerial = new Serial(newMemory, newInterrupts, newTimer);
-    Cpu *newCpu = new Cpu(newInterrupts, newMemory, newTimer);
-    Audio *newAudio = new Audio(newMemory, newTimer, audioInterface, gameSpeedSubject);
-
-    // This can't be done in the memory constructor since Timer doesn't exist yet.
-    newTimer->AttachObserver(newMemory);
-
-    newMemory->SetRomMemory(gameRomMemory);
-
-    bool success = true;
+    // Older versions are converted to the current one first. After that the snapshot only has to pass the checks in
+    // ReadSnapshot(), which happen before anything is restored, so a bad file never leaves the game half loaded.
+    if (version < STATE_VERSION && !ConvertSnapshot(version, snapshot))
+    {
+        LogError("Error converting save state version %u", version);
+        displayInterface->RequestMessageBox("Error loading state");
+        return false;
+    }
 
-    // Load data.
-    success &= newMemory->LoadState(version, file);
-    success &= newInterrupts->LoadState(version, file);
-    success &= newTimer->LoadState(version, file);
-    success &= newDisplay->LoadState(version, file);
-    success &= newInput->LoadState(version, file);
-    success &= newSerial->LoadState(version, file);
-    success &= newCpu->LoadState(version, file);
+    bool success;
+    {
+        // Lock mutex to make the worker thread wait, so the state is restored between instructions. The machine and
+        // the worker thread are kept, so audio carries on without restarting.
+        std::lock_guard<std::mutex> lock(saveStateMutex);
 
-    fclose(file);
+        success = ReadSnapshot(snapshot.data(), snapshot.size());
+        if (success)
+            StateLoaded();
+    }
 
     if (success == false)
     {
         LogError("Error loading state");
         displayInterface->RequestMessageBox("Error loading state");
-        return;
+        return false;
     }
 
-    // End the current game.
-    EndEmulation();
+    LogError("Loaded save file %s", loadFilename.c_str());
 
-    // Replace pointers with new objects.
-    memory = newMemory;
-    interrupts = newInterrupts;
-    timer = newTimer;
-    display = newDisplay;
-    input = newInput;
-    serial = newSerial;
-    cpu = newCpu;
-    audio = newAudio;
-
-    // Start emulation.
-    paused = false;
-    quit = false;
-    workThread = std::thread(&EmulatorMgr::ThreadFunc, this);
+    return true;
+}
 
-    LogError("Loaded save file %s", loadFilename.c_str());
+
+size_t EmulatorMgr::GetSnapshotSize()
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+    return GetSnapshotSizeLocked();
+}
+
+
+size_t EmulatorMgr::SaveSnapshot(uint8_t *buffer, size_t size)
+{
+    // Lock mutex to make the worker thread wait while the snapshot is taken.
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+    return WriteSnapshot(buffer, size);
+}
+
+
+bool EmulatorMgr::LoadSnapshot(const uint8_t *buffer, size_t size)
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    if (!ReadSnapshot(buffer, size))
+        return false;
+
+    StateLoaded();
+    return true;
+}
+
+
+void EmulatorMgr::SetRewindBuffer(size_t bufferSize, uint keyframeInterval)
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    delete rewindBuffer;
+    rewindBuffer = bufferSize ? new RewindBuffer(bufferSize, keyframeInterval) : NULL;
+    ResetRewind();
+}
+
+
+void EmulatorMgr::SetRewinding(bool rewinding)
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+    this->rewinding = rewinding;
+}
+
+
+bool EmulatorMgr::RewindFrame()
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+    return StepBackFrame();
+}
+
+
+RewindBuffer::Stats EmulatorMgr::GetRewindStats()
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+    return rewindBuffer ? rewindBuffer->GetStats() : RewindBuffer::Stats();
+}
+
+
+void EmulatorMgr::SetRunAhead(uint frames)
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    runAheadFrames = frames;
+    runAheadStats = RunAheadStats();
+    runAheadStats.frames = frames;
+}
+
+
+EmulatorMgr::RunAheadStats EmulatorMgr::GetRunAheadStats()
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    RunAheadStats stats = runAheadStats;
+    if (stats.framesRun)
+    {
+        // Each host frame has to fit the real frame, the save and restore, and the frames ahead.
+        const double frameNanoseconds = (double)stats.totalFrameNanoseconds / stats.framesRun;
+        const double overheadNanoseconds = (double)(stats.totalNanoseconds - stats.totalFrameNanoseconds) / stats.hostFrames;
+        const double frames = (FRAME_NANOSECONDS - overheadNanoseconds) / frameNanoseconds - 1;
+        stats.affordableFrames = frames > 0 ? (uint)frames : 0;
+    }
+
+    return stats;
+}
+
+
+void EmulatorMgr::SetFastForward(bool enabled, uint renderInterval, bool compressAudio)
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    fastForward = enabled;
+    fastForwardInterval = renderInterval;
+    fastForwardAudio = compressAudio;
+    fastForwardFrames = 0;
+    fastForwardSpeedStart = std::chrono::steady_clock::now();
+
+    // The frame in progress is only partly drawn when fast-forward starts, so it isn't shown. When fast-forward ends,
+    // drawing starts again with the next frame, in FrameCompleted().
+    if (display && enabled)
+        display->SetRenderEnabled(false);
+
+    if (audio)
+    {
+        audio->SetOutputEnabled(!enabled || compressAudio);
+        audio->SetTimeScale(enabled && compressAudio ? 1 : 0);
+    }
+}
+
+
+void EmulatorMgr::SetShades(Palette::Shades shades)
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    this->shades = shades;
+    if (display)
+        display->SetShades(shades);
+}
+
+
+void EmulatorMgr::SetLinkInterface(LinkInterface *linkInterface)
+{
+    // Lock mutex to make the worker thread wait while the link is swapped.
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    this->linkInterface = linkInterface;
+    if (serial)
+        serial->SetLinkInterface(linkInterface);
+}
+
+
+bool EmulatorMgr::StartTrace(const std::string &filename)
+{
+    // Lock mutex to make the worker thread wait while the recorder is swapped.
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    delete traceRecorder;
+    traceRecorder = new TraceRecorder();
+
+    if (!traceRecorder->Open(filename))
+    {
+        delete traceRecorder;
+        traceRecorder = NULL;
+    }
+
+    if (cpu)
+        cpu->SetTraceRecorder(traceRecorder);
+
+    return traceRecorder != NULL;
+}
+
+
+void EmulatorMgr::StopTrace()
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    delete traceRecorder;
+    traceRecorder = NULL;
+
+    if (cpu)
+        cpu->SetTraceRecorder(NULL);
+}
+
+
+bool EmulatorMgr::StartStateHashing(const std::string &filename)
+{
+    ScopedLoggerConfig loggerConfig(context.loggerConfig);
+    // Lock mutex to make the worker thread wait while the recorder is swapped.
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    delete stateHashRecorder;
+    stateHashRecorder = new StateHashRecorder();
+
+    const std::vector<std::string> tags(std::begin(STATE_CHUNK_TAGS), std::end(STATE_CHUNK_TAGS));
+    if (!stateHashRecorder->Open(filename, tags))
+    {
+        delete stateHashRecorder;
+        stateHashRecorder = NULL;
+        return false;
+    }
+
+    if (cpu)
+        RecordStateHash();
+
+    return true;
+}
+
+
+bool EmulatorMgr::StopStateHashing()
+{
+    ScopedLoggerConfig loggerConfig(context.loggerConfig);
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    const bool success = stateHashRecorder == NULL || stateHashRecorder->Close();
+    delete stateHashRecorder;
+    stateHashRecorder = NULL;
+
+    return success;
+}
+
+
+bool EmulatorMgr::StartMovieRecording(const std::string &filename, bool fromPowerOn)
+{
+    ScopedLoggerConfig loggerConfig(context.loggerConfig);
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    EndMovie();
+    if (cpu == NULL)
+        return false;
+
+    std::vector<uint8_t> startState;
+    bool success;
+    if (fromPowerOn)
+    {
+        success = GetPowerOnSnapshot(startState);
+    }
+    else
+    {
+        startState.resize(GetSnapshotSizeLocked());
+        success = WriteSnapshot(startState.data(), startState.size()) == startState.size();
+    }
+
+    // Carry on from the snapshot rather than the current state, so recording and playback start out the same even in
+    // state that isn't part of a snapshot.
+    if (!success || !ReadSnapshot(startState.data(), startState.size()))
+    {
+        LogError("Error saving the start state for movie %s", filename.c_str());
+        return false;
+    }
+
+    movie = new Movie();
+    movie->StartRecording(startState, memory->GetRomHash(), fromPowerOn);
+    movieRecording = true;
+    movieActive = true;
+    movieFilename = filename;
+
+    movieButtons = GetButtons();
+    input->SetButtons(movieButtons);
+    display->RedrawFrame();
+    display->PresentFrame();
+    ResetRewind();
+
+    return true;
+}
+
+
+bool EmulatorMgr::StartMoviePlayback(const std::string &filename)
+{
+    ScopedLoggerConfig loggerConfig(context.loggerConfig);
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    EndMovie();
+    if (cpu == NULL)
+        return false;
+
+    Movie *newMovie = new Movie();
+    if (!newMovie->Load(filename))
+    {
+        delete newMovie;
+        return false;
+    }
+
+    const std::vector<uint8_t> &startState = newMovie->GetStartState();
+    if (newMovie->GetRomHash() != memory->GetRomHash() || !ReadSnapshot(startState.data(), startState.size()))
+    {
+        LogError("Movie %s was recorded with a different game", filename.c_str());
+        delete newMovie;
+        return false;
+    }
+
+    movie = newMovie;
+    movieRecording = false;
+    movieActive = true;
+
+    display->RedrawFrame();
+    display->PresentFrame();
+    ResetRewind();
+
+    AdvanceMovie();
+
+    return true;
+}
+
+
+bool EmulatorMgr::StopMovie()
+{
+    ScopedLoggerConfig loggerConfig(context.loggerConfig);
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    return EndMovie();
+}
+
+
+uint64_t EmulatorMgr::GetMovieFrameCount()
+{
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    return movie ? movie->GetFrameCount() : 0;
 }
 
 
 void EmulatorMgr::ThreadFunc()
 {
+    Logger::SetThreadConfig(context.loggerConfig);
+
     try
     {
         if (infoInterface)
@@ -324,15 +792,33 @@ void EmulatorMgr::ThreadFunc()
         while (!quit)
         {
             // Block this thread while state is being saved.
-            std::lock_guard<std::mutex> lock(saveStateMutex);
+            std::unique_lock<std::mutex> lock(saveStateMutex);
 
-            // Run multiple instruction per mutex lock to reduce the impact of locking the mutex.
-            for (int i = 0; i < 100; i++)
+            // While rewinding, step back a frame at a time at the frame rate, instead of running.
+            if (rewinding && !paused)
             {
-                if (!paused && debuggerInterface->ShouldRun(cpu->reg.pc))
+                StepBackFrame();
+                lock.unlock();
+                framePacer.WaitForNextFrame();
+                continue;
+            }
+
+            // Run multiple instruction per mutex lock to reduce the impact of locking the mutex. The end of a frame
+            // ends the batch, so the wait for the next frame doesn't hold the mutex.
+            bool frameDone = false;
+            for (int i = 0; i < 100 && !frameDone; i++)
+            {
+                if (!paused && (!debuggerInterface || debuggerInterface->ShouldRun(cpu->reg.pc)))
                 {
                     cpu->ProcessOpCode();
-                    if (debuggerInterface->GetDebuggingEnabled())
+                    if (linkInterface && linkInterface->GetRequest() != LinkInterface::eLinkRequestNone)
+                        HandleLinkRequest();
+                    if (display->GetFrameCount() != lastFrameCount)
+                    {
+                        FrameCompleted();
+                        frameDone = true;
+                    }
+                    if (debuggerInterface && debuggerInterface->GetDebuggingEnabled())
                         debuggerInterface->SetCurrentOp(cpu->reg.pc);
                     cpu->PrintState();
                     //timer->PrintTimerData();
@@ -343,15 +829,30 @@ void EmulatorMgr::ThreadFunc()
                     std::this_thread::sleep_for(std::chrono::milliseconds(1));
                 }
             }
+
+            if (frameDone)
+            {
+                const bool paced = !fastForward;
+                lock.unlock();
+                if (paced)
+                    framePacer.WaitForNextFrame();
+            }
         }
 
-        memory->SaveRam(ramFilename);
+        if (context.persistRam)
+            memory->SaveRam(ramFilename);
     }
     catch(const std::exception& e)
     {
         displayInterface->RequestMessageBox(e.what());
     }
 
+    DeleteObjects();
+}
+
+
+void EmulatorMgr::DeleteObjects()
+{
     if (infoInterface)
         infoInterface->SetMemory(NULL);
     if (debuggerInterface)
@@ -376,6 +877,436 @@ void EmulatorMgr::ThreadFunc()
 }
 
 
+size_t EmulatorMgr::GetSnapshotSizeLocked()
+{
+    if (cpu == NULL)
+        return 0;
+
+    // The size only depends on the game, so count the bytes a snapshot would take without writing them.
+    StateWriter writer(NULL, 0);
+    WriteState(writer, memory, interrupts, timer, display, input, serial, cpu);
+    return writer.GetSize();
+}
+
+
+size_t EmulatorMgr::WriteSnapshot(uint8_t *buffer, size_t size)
+{
+    if (cpu == NULL)
+        return 0;
+
+    StateWriter writer(buffer, size);
+    bool success = WriteState(writer, memory, interrupts, timer, display, input, serial, cpu);
+
+    return success ? writer.GetSize() : 0;
+}
+
+
+bool EmulatorMgr::ReadSnapshot(const uint8_t *buffer, size_t size)
+{
+    // Check everything that can fail up front, so the current state is never left half restored.
+    if (cpu == NULL || size < STATE_HEADER_SIZE || memcmp(buffer, STATE_MAGIC, sizeof(STATE_MAGIC)) ||
+        memcmp(&buffer[sizeof(STATE_MAGIC)], &STATE_VERSION, sizeof(STATE_VERSION)))
+        return false;
+
+    StateReader reader(&buffer[STATE_HEADER_SIZE], size - STATE_HEADER_SIZE);
+    StateReader chunks[eChunkCount];
+    bool found[eChunkCount] = {};
+
+    while (reader.GetRemaining() > 0)
+    {
+        char tag[STATE_CHUNK_TAG_SIZE];
+        StateReader chunk;
+        if (!reader.ReadChunk(tag, chunk))
+            return false;
+
+        for (int i = 0; i < eChunkCount; i++)
+        {
+            if (memcmp(tag, STATE_CHUNK_TAGS[i], STATE_CHUNK_TAG_SIZE) == 0)
+            {
+                chunks[i] = chunk;
+                found[i] = true;
+                break;
+            }
+        }
+    }
+
+    if (std::find(std::begin(found), std::end(found), false) != std::end(found))
+        return false;
+
+    uint64_t romHash;
+    if (!chunks[eChunkRom].Read(&romHash, sizeof(romHash)) || romHash != memory->GetRomHash())
+        return false;
+
+    if (!ChunkFits(chunks[eChunkMemory], memory) || !ChunkFits(chunks[eChunkInterrupts], interrupts) ||
+        !ChunkFits(chunks[eChunkTimer], timer) || !ChunkFits(chunks[eChunkDisplay], display) ||
+        !ChunkFits(chunks[eChunkInput], input) || !ChunkFits(chunks[eChunkSerial], serial) ||
+        !ChunkFits(chunks[eChunkCpu], cpu))
+        return false;
+
+    bool success = true;
+
+    success &= memory->LoadState(STATE_VERSION, chunks[eChunkMemory]);
+    success &= interrupts->LoadState(STATE_VERSION, chunks[eChunkInterrupts]);
+    success &= timer->LoadState(STATE_VERSION, chunks[eChunkTimer]);
+    success &= display->LoadState(STATE_VERSION, chunks[eChunkDisplay]);
+    success &= input->LoadState(STATE_VERSION, chunks[eChunkInput]);
+    success &= serial->LoadState(STATE_VERSION, chunks[eChunkSerial]);
+    success &= cpu->LoadState(STATE_VERSION, chunks[eChunkCpu]);
+
+    return success;
+}
+
+
+bool EmulatorMgr::CaptureSnapshot(std::vector<uint8_t> &snapshot)
+{
+    // Lock mutex to make the worker thread wait while the snapshot is taken. Nothing else is done under the lock.
+    std::lock_guard<std::mutex> lock(saveStateMutex);
+
+    snapshot.resize(GetSnapshotSizeLocked());
+    if (snapshot.empty() || WriteSnapshot(snapshot.data(), snapshot.size()) != snapshot.size())
+    {
+        LogError("Error saving state");
+        displayInterface->RequestMessageBox("Error saving state");
+        return false;
+    }
+
+    return true;
+}
+
+
+bool EmulatorMgr::ConvertSnapshot(uint16_t version, std::vector<uint8_t> &snapshot)
+{
+    // Load the old state into a scratch machine for the current game, and save it again in the current format.
+    Memory tempMemory;
+    Interrupt tempInterrupts(&tempMemory);
+    Timer tempTimer(&tempMemory, &tempInterrupts);
+    Display tempDisplay(&tempMemory, &tempInterrupts, NULL, &tempTimer);
+    Input tempInput(&tempMemory, &tempInterrupts);
+    Serial tempSerial(&tempMemory, &tempInterrupts, &tempTimer);
+    Cpu tempCpu(&tempInterrupts, &tempMemory, &tempTimer);
+
+    tempMemory.SetRomMemory(gameRomMemory);
+
+    StateReader reader(&snapshot[STATE_HEADER_SIZE], snapshot.size() - STATE_HEADER_SIZE);
+    bool success = true;
+
+    success &= tempMemory.LoadState(version, reader);
+    success &= tempInterrupts.LoadState(version, reader);
+    success &= tempTimer.LoadState(version, reader);
+    success &= tempDisplay.LoadState(version, reader);
+    success &= tempInput.LoadState(version, reader);
+    success &= tempSerial.LoadState(version, reader);
+    success &= tempCpu.LoadState(version, reader);
+
+    if (success == false)
+        return false;
+
+    StateWriter counter(NULL, 0);
+    WriteState(counter, &tempMemory, &tempInterrupts, &tempTimer, &tempDisplay, &tempInput, &tempSerial, &tempCpu);
+    snapshot.resize(counter.GetSize());
+
+    StateWriter writer(snapshot.data(), snapshot.size());
+    return WriteState(writer, &tempMemory, &tempInterrupts, &tempTimer, &tempDisplay, &tempInput, &tempSerial, &tempCpu);
+}
+
+
+bool EmulatorMgr::GetPowerOnSnapshot(std::vector<uint8_t> &snapshot)
+{
+    // Set up a scratch machine for the current game the same way LoadRom() does, without battery backed RAM.
+    Memory tempMemory;
+    Interrupt tempInterrupts(&tempMemory);
+    Timer tempTimer(&tempMemory, &tempInterrupts);
+    Display tempDisplay(&tempMemory, &tempInterrupts, NULL, &tempTimer);
+    Input tempInput(&tempMemory, &tempInterrupts);
+    Serial tempSerial(&tempMemory, &tempInterrupts, &tempTimer);
+    Cpu tempCpu(&tempInterrupts, &tempMemory, &tempTimer);
+
+    tempTimer.AttachObserver(&tempMemory);
+
+    if (runBootRom)
+    {
+        tempMemory.SetRomMemory(bootRomMemory, gameRomMemory);
+    }
+    else
+    {
+        tempMemory.SetRomMemory(gameRomMemory);
+        SetBootState(&tempMemory, &tempCpu);
+    }
+
+    StateWriter counter(NULL, 0);
+    WriteState(counter, &tempMemory, &tempInterrupts, &tempTimer, &tempDisplay, &tempInput, &tempSerial, &tempCpu);
+    snapshot.resize(counter.GetSize());
+
+    StateWriter writer(snapshot.data(), snapshot.size());
+    return WriteState(writer, &tempMemory, &tempInterrupts, &tempTimer, &tempDisplay, &tempInput, &tempSerial, &tempCpu);
+}
+
+
+void EmulatorMgr::StateLoaded()
+{
+    // A movie can't carry on from a different state.
+    EndMovie();
+
+    // Buttons held now take priority over the ones held when the state was saved.
+    input->SetButtons(GetButtons());
+
+    display->RedrawFrame();
+    display->PresentFrame();
+
+    // History from before the load would rewind into a different timeline.
+    ResetRewind();
+
+    paused = false;
+}
+
+
+void EmulatorMgr::HandleLinkRequest()
+{
+    if (linkInterface->GetRequest() == LinkInterface::eLinkRequestCheckpoint)
+    {
+        // The link asks for a checkpoint on every transfer with a predicted reply. The buffer only grows once.
+        linkCheckpoint.resize(GetSnapshotSizeLocked());
+        if (!WriteSnapshot(linkCheckpoint.data(), linkCheckpoint.size()))
+            throw std::runtime_error("Error saving link checkpoint");
+        linkCheckpointFrameCount = display->GetFrameCount();
+        linkCheckpointLastFrameCount = lastFrameCount;
+        linkCheckpointClockCount = timer->GetClockCount();
+        linkCheckpointMovieButtons = movieButtons;
+
+        linkInterface->CheckpointSaved();
+    }
+    else
+    {
+        // Frames completed since the checkpoint will be run again, so take back what they added to the movie, the
+        // state hashes, and the rewind history. The instruction that saved the checkpoint may have ended a frame that
+        // was only completed after it, so this counts from lastFrameCount rather than the display's frame count.
+        const uint64_t frames = lastFrameCount - linkCheckpointLastFrameCount;
+        if (frames > 0)
+        {
+            if (movie && movieRecording)
+                movie->UnrecordFrames(frames);
+            else if (movie)
+                movie->UnplayFrames(frames);
+
+            if (stateHashRecorder)
+            {
+                const uint64_t records = stateHashRecorder->GetRecordCount();
+                stateHashRecorder->Truncate(records - std::min(frames, records));
+            }
+
+            for (uint64_t i = 0; rewindBuffer && i < frames; i++)
+                rewindBuffer->StepBack();
+        }
+
+        if (!ReadSnapshot(linkCheckpoint.data(), linkCheckpoint.size()))
+            throw std::runtime_error("Error restoring link checkpoint");
+        display->SetFrameCount(linkCheckpointFrameCount);
+        timer->SetClockCount(linkCheckpointClockCount);
+        lastFrameCount = linkCheckpointLastFrameCount;
+        movieButtons = linkCheckpointMovieButtons;
+
+        // Buttons pressed since the checkpoint were undone by the restore.
+        if (movie == NULL)
+            input->SetButtons(GetButtons());
+
+        // The transfer wrote the predicted byte to SB. Replace it with the byte the peer really sent.
+        memory->WriteByte(eRegSB, linkInterface->RolledBack());
+    }
+}
+
+
+void EmulatorMgr::FrameCompleted()
+{
+    lastFrameCount = display->GetFrameCount();
+
+    if (movie)
+        AdvanceMovie();
+
+    if (stateHashRecorder)
+        RecordStateHash();
+
+    if (rewindBuffer)
+        CaptureRewindFrame();
+
+    // Whether the next frame is drawn only changes here, so a frame is never drawn from the middle.
+    if (fastForward)
+        FastForwardFrame();
+    else if (runAheadFrames)
+        RunAhead();
+    else
+        display->SetRenderEnabled(true);
+}
+
+
+void EmulatorMgr::ResetRewind()
+{
+    if (cpu == NULL)
+        return;
+
+    lastFrameCount = display->GetFrameCount();
+    if (rewindBuffer)
+        rewindBuffer->Reset(GetSnapshotSizeLocked());
+}
+
+
+void EmulatorMgr::CaptureRewindFrame()
+{
+    uint8_t *snapshot = rewindBuffer->BeginCapture();
+    WriteSnapshot(snapshot, GetSnapshotSizeLocked());
+    rewindBuffer->EndCapture();
+}
+
+
+bool EmulatorMgr::StepBackFrame()
+{
+    // The movie would have to be cut back as well, and transfers the link peer has seen can't be undone.
+    if (movie || linkInterface)
+        return false;
+
+    const uint8_t *snapshot = rewindBuffer ? rewindBuffer->StepBack() : NULL;
+    if (snapshot == NULL || !ReadSnapshot(snapshot, GetSnapshotSizeLocked()))
+        return false;
+
+    // Show the frame that was drawn when the snapshot was captured.
+    display->RedrawFrame();
+    display->PresentFrame();
+
+    return true;
+}
+
+
+void EmulatorMgr::RunAhead()
+{
+    // Frames ahead would send link transfers that can't be undone, and would step past breakpoints.
+    if (linkInterface || (debuggerInterface && debuggerInterface->GetDebuggingEnabled()))
+    {
+        display->SetRenderEnabled(true);
+        return;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    runAheadSnapshot.resize(GetSnapshotSizeLocked());
+    if (!WriteSnapshot(runAheadSnapshot.data(), runAheadSnapshot.size()))
+        throw std::runtime_error("Error saving run-ahead snapshot");
+
+    audio->SetOutputEnabled(false);
+    audio->SaveChannels();
+    serial->SetSerialInterface(NULL);
+    cpu->SetTraceRecorder(NULL);
+
+    // Only the last frame ahead is drawn. The LCD can be turned off while running ahead, so stop after a frame's worth
+    // of clocks even if no frame was drawn.
+    const auto framesStart = std::chrono::steady_clock::now();
+    const uint64_t frameCount = display->GetFrameCount();
+    const uint64_t startClocks = timer->GetClockCount();
+    for (uint i = 1; i <= runAheadFrames; i++)
+    {
+        display->SetRenderEnabled(i == runAheadFrames);
+        while (display->GetFrameCount() < frameCount + i && timer->GetClockCount() < startClocks + i * CLOCKS_PER_FRAME)
+            cpu->ProcessOpCode();
+    }
+    const auto framesEnd = std::chrono::steady_clock::now();
+
+    if (!ReadSnapshot(runAheadSnapshot.data(), runAheadSnapshot.size()))
+        throw std::runtime_error("Error restoring run-ahead snapshot");
+    audio->RestoreChannels();
+    display->SetFrameCount(frameCount);
+    timer->SetClockCount(startClocks);
+
+    // Buttons pressed while running ahead were undone by the restore. A movie only changes buttons between frames.
+    if (movie == NULL)
+        input->SetButtons(GetButtons());
+
+    audio->SetOutputEnabled(true);
+    serial->SetSerialInterface(serialInterface);
+    cpu->SetTraceRecorder(traceRecorder);
+
+    // The next real frame is only run for its state, the frame ahead of it is the one that's shown.
+    display->SetRenderEnabled(false);
+
+    const uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    runAheadStats.hostFrames++;
+    runAheadStats.framesRun += runAheadFrames;
+    runAheadStats.lastNanoseconds = nanoseconds;
+    runAheadStats.totalNanoseconds += nanoseconds;
+    runAheadStats.maxNanoseconds = std::max(runAheadStats.maxNanoseconds, nanoseconds);
+    runAheadStats.totalFrameNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        framesEnd - framesStart).count();
+}
+
+
+void EmulatorMgr::FastForwardFrame()
+{
+    // Decide whether the frame that starts now is drawn.
+    fastForwardFrames++;
+    display->SetRenderEnabled(fastForwardInterval && fastForwardFrames % fastForwardInterval == 0);
+
+    // A ROM loaded since fast-forward started has new audio.
+    audio->SetOutputEnabled(fastForwardAudio);
+    if (fastForwardAudio && fastForwardFrames % FAST_FORWARD_SPEED_FRAMES == 0)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const double nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            now - fastForwardSpeedStart).count();
+        fastForwardSpeedStart = now;
+
+        // A machine that can't run the game faster than normal keeps the audio at normal speed.
+        audio->SetTimeScale(std::max(FAST_FORWARD_SPEED_FRAMES * FRAME_NANOSECONDS / nanoseconds, 1.0));
+    }
+}
+
+
+void EmulatorMgr::RecordStateHash()
+{
+    // The buffer only grows once, so hashing doesn't allocate after the first frame.
+    stateHashSnapshot.resize(GetSnapshotSizeLocked());
+    if (!WriteSnapshot(stateHashSnapshot.data(), stateHashSnapshot.size()))
+        throw std::runtime_error("Error saving snapshot for the state hash");
+
+    StateReader chunks(&stateHashSnapshot[STATE_HEADER_SIZE], stateHashSnapshot.size() - STATE_HEADER_SIZE);
+    stateHashRecorder->Record(display->GetFrameCount(), chunks);
+}
+
+
+void EmulatorMgr::AdvanceMovie()
+{
+    if (movieRecording)
+    {
+        // Record the buttons the frame that just ended ran with, and take the ones held now for the next frame.
+        movie->RecordFrame(movieButtons.data);
+        movieButtons = GetButtons();
+    }
+    else if (!movie->PlayFrame(movieButtons.data))
+    {
+        LogError("Movie finished after %llu frames", (unsigned long long)movie->GetFrameCount());
+        EndMovie();
+        return;
+    }
+
+    input->SetButtons(movieButtons);
+}
+
+
+bool EmulatorMgr::EndMovie()
+{
+    if (movie == NULL)
+        return true;
+
+    const bool success = !movieRecording || movie->Save(movieFilename);
+    movieActive = false;
+    delete movie;
+    movie = NULL;
+
+    // Hand the buttons back to the player.
+    if (input)
+        input->SetButtons(GetButtons());
+
+    return success;
+}
+
+
 void EmulatorMgr::SetBootState(Memory *memory, Cpu *cpu)
 {
     // Set state to what it would be after running the boot ROM.
@@ -1,49 +1,192 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <thread>
 #include <vector>
 #include "Buttons.h"
+#include "Display.h"
+#include "EmulatorContext.h"
+#include "FramePacer.h"
+#include "Palette.h"
+#include "RewindBuffer.h"
 
+class AsyncStateWriter;
 class Audio;
 class AudioInterface;
 class Cpu;
 class DebuggerInterface;
-class Display;
 class DisplayInterface;
 class GameSpeedSubject;
 class InfoInterface;
 class Input;
 class Interrupt;
+class LinkInterface;
 class Memory;
+class Movie;
 class Serial;
+class SerialFileWriter;
+class SerialInterface;
+class StateHashRecorder;
+class StateWriter;
 class Timer;
+class TraceRecorder;
+class TripleFrameBuffer;
 
 class EmulatorMgr
 {
 public:
     EmulatorMgr(DisplayInterface *displayInterface, AudioInterface *audioInterface, InfoInterface *infoInterface,
-                DebuggerInterface *debuggerInterface, GameSpeedSubject *gameSpeedSubject);
+                DebuggerInterface *debuggerInterface, GameSpeedSubject *gameSpeedSubject,
+                SerialInterface *serialInterface = NULL, const EmulatorContext &context = EmulatorContext());
     ~EmulatorMgr();
 
     void LoadBootRom(const std::string &filename);
-    bool LoadRom(const std::string &filename);
+    // When startThread is false, no worker thread is started, and the caller drives emulation with Run().
+    bool LoadRom(const std::string &filename, bool startThread = true);
     void ResetEmulation();
     void PauseEmulation(bool pause);
     void EndEmulation();
     void ButtonPressed(Buttons::Button button);
     void ButtonReleased(Buttons::Button button);
 
+    // Runs emulation on the calling thread until maxClocks clocks have run, maxFrames frames have been drawn, or
+    // StopRun() is called. A limit of 0 means no limit. Returns the number of clocks that were run.
+    uint64_t Run(uint64_t maxClocks, uint64_t maxFrames);
+    void StopRun() {quit = true;}
+
+    // Newest finished frame, for showing frames on another thread. Never waits for the emulator thread, and returns
+    // the same frame again if no new one has been finished since the last call. The frame stays valid until the next
+    // call. Frames that were finished in between are dropped, GetDroppedFrames() counts them. If changedLines isn't
+    // NULL, it's set to the lines that may differ from the frame returned last time, see TripleFrameBuffer::Acquire().
+    const uint32_t *AcquireFrame(ScanlineMask *changedLines = NULL);
+    uint64_t GetDroppedFrames() const;
+
+    // The worker thread runs frames at this rate, see FramePacer. FRAMES_PER_SECOND is the game's own speed, and 0, the
+    // default, runs as fast as possible. With audio pacing, the speed follows the audio output's clock instead, so
+    // its buffer doesn't run dry or overflow. Run() is never paced.
+    void SetFrameRate(double framesPerSecond) {framePacer.SetFrameRate(framesPerSecond);}
+    void SetAudioPacing(bool enabled) {framePacer.SetAudioPacing(enabled);}
+    FramePacer::Stats GetFramePacingStats() {return framePacer.GetStats();}
+
+    // Fast-forward runs as fast as possible, ignoring the frame rate, and only draws every renderInterval-th frame,
+    // or none if it's 0. Frames that aren't drawn skip the scanline renderer, but LCD timing and interrupts are the
+    // same. Audio is muted, or with compressAudio, played as many times faster as the game is running, see
+    // Audio::SetTimeScale(). Run-ahead is skipped while fast-forwarding.
+    void SetFastForward(bool enabled, uint renderInterval = DEFAULT_FAST_FORWARD_INTERVAL, bool compressAudio = false);
+    bool IsFastForwarding() const {return fastForward;}
+
+    static const uint DEFAULT_FAST_FORWARD_INTERVAL = 8;
+
+    // Colors the screen is drawn in, see Palette. Kept for games loaded later.
+    void SetShades(Palette::Shades shades);
+
+    // SaveState() only stops emulation while the snapshot is taken. The file is written on a background thread, and
+    // the DisplayInterface is told when it's done. SaveStateToFile() writes the file before returning.
     void SaveState(int slot);
+    bool SaveStateToFile(const std::string &filename);
+    // Loading restores the state into the running game between two instructions, without restarting emulation. The
+    // whole file is checked first, and the game is left untouched if it's rejected.
     void LoadState(int slot);
+    bool LoadStateFromFile(const std::string &filename);
+
+    // Snapshots hold the full machine state in a caller provided buffer, without file I/O or allocation, so they are
+    // cheap enough to take every frame. GetSnapshotSize() is the buffer size a snapshot of the current game needs.
+    // SaveSnapshot() returns the number of bytes written, or 0 if the buffer is too small. LoadSnapshot() only accepts
+    // snapshots of the current game, and leaves the state unchanged if the snapshot is rejected. Otherwise it does the
+    // same as loading a save state, so it stops a movie, clears the rewind history and unpauses.
+    size_t GetSnapshotSize();
+    size_t SaveSnapshot(uint8_t *buffer, size_t size);
+    bool LoadSnapshot(const uint8_t *buffer, size_t size);
+
+    // Rewind keeps a snapshot of every frame in a buffer of at most bufferSize bytes, see RewindBuffer. A size of 0
+    // disables rewind. While rewinding is set, the worker thread steps back one frame per host frame instead of
+    // running. Callers that use Run() step back with RewindFrame(), which returns false when there is no history left.
+    // Rewind is refused while a movie records or plays, or a link cable is connected.
+    void SetRewindBuffer(size_t bufferSize, uint keyframeInterval = RewindBuffer::DEFAULT_KEYFRAME_INTERVAL);
+    void SetRewinding(bool rewinding);
+    bool RewindFrame();
+    RewindBuffer::Stats GetRewindStats();
+
+    struct RunAheadStats
+    {
+        uint frames;                     // Frames run ahead per host frame.
+        uint64_t hostFrames;             // Host frames that ran ahead.
+        uint64_t framesRun;              // Frames run ahead in total.
+        uint64_t lastNanoseconds;        // Time spent running ahead for the last host frame, with save and restore.
+        uint64_t totalNanoseconds;
+        uint64_t maxNanoseconds;
+        uint64_t totalFrameNanoseconds;  // Part of totalNanoseconds spent emulating frames.
+        uint affordableFrames;           // Frames that would fit in a host frame at the measured costs.
+    };
+
+    // Run-ahead hides the game's own input lag. After each frame, the state is saved, the given number of frames are
+    // run with the current buttons, the last one is shown, and the state is restored. Only the frames ahead are
+    // shown, and only the real frames produce sound and serial output. 0 disables run-ahead. It's skipped while a
+    // link cable is connected or the debugger is enabled.
+    void SetRunAhead(uint frames);
+    RunAheadStats GetRunAheadStats();
+
+    // Connects the serial port to a link cable. NULL disconnects it.
+    void SetLinkInterface(LinkInterface *linkInterface);
+
+    bool StartTrace(const std::string &filename);
+    void StopTrace();
+
+    // Writes a hash of each part of the machine state at the end of every frame, and of the state hashing starts
+    // from, see StateHashRecorder. Two runs that should be identical, such as the same movie played on two builds,
+    // can be compared frame by frame with zlgb_hashdiff. StopStateHashing() returns false if writing failed.
+    bool StartStateHashing(const std::string &filename);
+    bool StopStateHashing();
+
+    // Movies hold a start state and the buttons held on every frame after it, so a run can be played back exactly,
+    // see Movie. Recording starts from power on, or from the current state. While a movie records or plays, button
+    // changes only reach the game at the end of a frame, and rewinding is disabled. Loading a state or a ROM stops the
+    // movie. A recording is written when it's stopped, and playback stops by itself at the end of the movie.
+    bool StartMovieRecording(const std::string &filename, bool fromPowerOn);
+    bool StartMoviePlayback(const std::string &filename);
+    bool StopMovie();
+    bool IsMovieRecording() const {return movieActive && movieRecording;}
+    bool IsMoviePlaying() const {return movieActive && !movieRecording;}
+    // Number of frames in the movie being played, or recorded so far.
+    uint64_t GetMovieFrameCount();
 
 private:
     void ThreadFunc();
+    void DeleteObjects();
+    // Snapshot functions for callers that already hold saveStateMutex, or run on the emulation thread.
+    size_t GetSnapshotSizeLocked();
+    size_t WriteSnapshot(uint8_t *buffer, size_t size);
+    bool ReadSnapshot(const uint8_t *buffer, size_t size);
+    bool CaptureSnapshot(std::vector<uint8_t> &snapshot);
+    bool ConvertSnapshot(uint16_t version, std::vector<uint8_t> &snapshot);
+    bool GetPowerOnSnapshot(std::vector<uint8_t> &snapshot);
+    // Called with the mutex held after a save state or snapshot has been loaded.
+    void StateLoaded();
+    void HandleLinkRequest();
+    void FrameCompleted();
+    void ResetRewind();
+    void CaptureRewindFrame();
+    bool StepBackFrame();
+    void RunAhead();
+    void FastForwardFrame();
+    void RecordStateHash();
+    void AdvanceMovie();
+    bool EndMovie();
 
     void SetBootState(Memory *memory, Cpu *cpu);
 
+    Buttons GetButtons() const
+    {
+        Buttons buttons;
+        buttons.data = buttonData;
+        return buttons;
+    }
+
     bool paused;
     bool quit;
+    bool runThread;
 
     bool runBootRom;
     std::vector<uint8_t> bootRomMemory;
@@ -60,9 +203,12 @@ private:
     InfoInterface *infoInterface;
     DebuggerInterface *debuggerInterface;
     GameSpeedSubject *gameSpeedSubject;
+    SerialInterface *serialInterface;
+    EmulatorContext context;
 
     Audio *audio;
-    Buttons buttons;
+    // Buttons held by the player. Changed on the UI thread and read on the worker thread, see GetButtons().
+    std::atomic<uint8_t> buttonData;
     Cpu *cpu;
     Display *display;
     Input *input;
@@ -70,4 +216,43 @@ private:
     Memory *memory;
     Serial *serial;
     Timer *timer;
+
+    AsyncStateWriter *stateWriter;
+    TripleFrameBuffer *frameBuffers;
+    FramePacer framePacer;
+    Palette::Shades shades;
+    TraceRecorder *traceRecorder;
+    SerialFileWriter *serialFileWriter;
+    LinkInterface *linkInterface;
+    std::vector<uint8_t> linkCheckpoint;
+    // Counts that aren't part of a snapshot, from when the link checkpoint was saved.
+    uint64_t linkCheckpointFrameCount;
+    uint64_t linkCheckpointLastFrameCount;
+    uint64_t linkCheckpointClockCount;
+    Buttons linkCheckpointMovieButtons;
+
+    uint64_t lastFrameCount;  // Frame count when FrameCompleted() was last called.
+
+    RewindBuffer *rewindBuffer;
+    bool rewinding;
+
+    uint runAheadFrames;
+    std::vector<uint8_t> runAheadSnapshot;
+    RunAheadStats runAheadStats;
+
+    bool fastForward;
+    uint fastForwardInterval;
+    bool fastForwardAudio;
+    uint64_t fastForwardFrames;  // Frames run since fast-forward started.
+    std::chrono::steady_clock::time_point fastForwardSpeedStart;
+
+    Movie *movie;
+    // Whether movie is set, for checks made without the mutex. movieRecording only changes while this is false.
+    std::atomic<bool> movieActive;
+    bool movieRecording;
+    std::string movieFilename;
+    Buttons movieButtons;  // Buttons the game gets for the current frame while a movie records or plays.
+
+    StateHashRecorder *stateHashRecorder;
+    std::vector<uint8_t> stateHashSnapshot;
 };
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <thread>
+
+#include "AudioInterface.h"
+#include "FramePacer.h"
+
+const std::chrono::nanoseconds FramePacer::MAX_LAG = std::chrono::milliseconds(100);
+const std::chrono::nanoseconds FramePacer::MIN_SPIN_MARGIN = std::chrono::microseconds(100);
+const std::chrono::nanoseconds FramePacer::MAX_SPIN_MARGIN = std::chrono::milliseconds(4);
+const double FramePacer::AUDIO_MAX_ADJUST = 0.01;
+
+
+FramePacer::FramePacer(AudioInterface *audioInterface) :
+    audioInterface(audioInterface),
+    frameRate(0),
+    audioPacing(false),
+    scheduled(false),
+    deadline(),
+    spinMargin(std::chrono::milliseconds(1)),
+    statsMutex(),
+    stats()
+{
+
+}
+
+
+void FramePacer::WaitForNextFrame()
+{
+    const double rate = frameRate;
+    if (rate <= 0)
+    {
+        scheduled = false;
+        return;
+    }
+
+    const Clock::time_point now = Clock::now();
+    if (!scheduled)
+    {
+        // The first frame starts the schedule.
+        deadline = now;
+        scheduled = true;
+        return;
+    }
+
+    deadline += GetFramePeriod(rate);
+
+    if (now >= deadline)
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        if (now - deadline > MAX_LAG)
+        {
+            deadline = now;
+            stats.resyncs++;
+        }
+        else
+        {
+            stats.lateFrames++;
+        }
+        return;
+    }
+
+    if (deadline - now > spinMargin)
+    {
+        const Clock::time_point wakeTime = deadline - spinMargin;
+        std::this_thread::sleep_until(wakeTime);
+
+        // Keep the margin a little above how far sleeps overshoot, growing it straight away when a sleep overshoots
+        // more than it, and shrinking it slowly when they don't.
+        const Clock::duration overshoot = Clock::now() - wakeTime;
+        spinMargin = std::max(spinMargin - spinMargin / 16, overshoot + overshoot / 4);
+        spinMargin = std::min<Clock::duration>(std::max<Clock::duration>(spinMargin, MIN_SPIN_MARGIN),
+                                                MAX_SPIN_MARGIN);
+    }
+
+    Clock::time_point woke;
+    while ((woke = Clock::now()) < deadline)
+        std::this_thread::yield();
+
+    const uint64_t error = std::chrono::duration_cast<std::chrono::nanoseconds>(woke - deadline).count();
+    std::lock_guard<std::mutex> lock(statsMutex);
+    stats.frames++;
+    stats.totalErrorNanoseconds += error;
+    stats.maxErrorNanoseconds = std::max(stats.maxErrorNanoseconds, error);
+}
+
+
+FramePacer::Stats FramePacer::GetStats()
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+
+FramePacer::Clock::duration FramePacer::GetFramePeriod(double rate)
+{
+    double nanoseconds = 1e9 / rate;
+
+    if (audioPacing && audioInterface)
+    {
+        // A fuller buffer than half means the game is running ahead of the audio device, so slow down, and the other
+        // way around.
+        const double fill = audioInterface->GetAudioBufferFill();
+        if (fill >= 0)
+            nanoseconds *= 1 + AUDIO_MAX_ADJUST * std::min(std::max((fill - 0.5) * 2, -1.0), 1.0);
+    }
+
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::nano>(nanoseconds));
+}
\ No newline at end of file
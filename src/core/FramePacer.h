@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+#include "gbemu.h"
+
+class AudioInterface;
+
+
+// Runs frames at a steady rate on the emulator thread.
+//
+// Every frame has a deadline on the steady clock, one frame period after the deadline before it, so rounding in one
+// frame's wait doesn't carry over into the next and the rate doesn't drift. A wait sleeps until shortly before the
+// deadline and spins for the rest, since sleeps can overshoot by a millisecond or more. The spin margin adapts to how
+// much the sleeps on this machine overshoot. A frame that finishes late doesn't wait, so the frames after it catch up,
+// but if the emulator falls more than MAX_LAG behind, such as after a pause, the schedule starts again from now
+// rather than running fast to make up for it.
+//
+// With audio pacing, the frame period is stretched or shrunk by up to AUDIO_MAX_ADJUST to keep the audio output's
+// buffer half full. The audio device's clock then sets the speed of the game, so the buffer never runs dry or
+// overflows, even though the device's sample rate never quite matches the steady clock.
+class FramePacer
+{
+public:
+    struct Stats
+    {
+        uint64_t frames;                 // Frames that were waited for.
+        uint64_t lateFrames;             // Frames that finished after their deadline, so didn't wait.
+        uint64_t resyncs;                // Times the schedule fell more than MAX_LAG behind, and started again.
+        uint64_t totalErrorNanoseconds;  // How long after its deadline each wait returned, in total.
+        uint64_t maxErrorNanoseconds;
+    };
+
+    explicit FramePacer(AudioInterface *audioInterface = NULL);
+
+    // Rates can be changed from any thread. A rate of 0 doesn't wait at all.
+    void SetFrameRate(double framesPerSecond) {frameRate = framesPerSecond;}
+    void SetAudioPacing(bool enabled) {audioPacing = enabled;}
+
+    // Called on the emulator thread after each frame. Returns when the next frame is due.
+    void WaitForNextFrame();
+
+    Stats GetStats();
+
+    // Don't allow copy and assignment.
+    FramePacer(const FramePacer&) = delete;
+    void operator=(const FramePacer&) = delete;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static const std::chrono::nanoseconds MAX_LAG;
+    static const std::chrono::nanoseconds MIN_SPIN_MARGIN;
+    static const std::chrono::nanoseconds MAX_SPIN_MARGIN;
+    static const double AUDIO_MAX_ADJUST;
+
+    Clock::duration GetFramePeriod(double frameRate);
+
+    AudioInterface *audioInterface;
+    std::atomic<double> frameRate;
+    std::atomic<bool> audioPacing;
+
+    bool scheduled;            // Whether deadline belongs to the previous frame, false until the first wait.
+    Clock::time_point deadline;
+    Clock::duration spinMargin;
+
+    std::mutex statsMutex;
+    Stats stats;
+};
\ No newline at end of file
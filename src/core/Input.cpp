@@ -71,20 +71,20 @@ void Input::SetButtons(const Buttons &buttons)
 }
 
 
-bool Input::SaveState(FILE *file)
+bool Input::SaveState(StateWriter &writer)
 {
-    if (!fwrite(&buttonData.data, sizeof(buttonData.data), 1, file))
+    if (!writer.Write(&buttonData.data, sizeof(buttonData.data)))
         return false;
 
     return true;
 }
 
 
-bool Input::LoadState(uint16_t version, FILE *file)
+bool Input::LoadState(uint16_t version, StateReader &reader)
 {
     (void)version;
 
-    if (!fread(&buttonData.data, sizeof(buttonData.data), 1, file))
+    if (!reader.Read(&buttonData.data, sizeof(buttonData.data)))
         return false;
 
     return true;
@@ -4,6 +4,7 @@
 #include "Buttons.h"
 #include "Interrupt.h"
 #include "IoRegisterProxy.h"
+#include "StateBuffer.h"
 
 class Input : public IoRegisterProxy
 {
@@ -13,8 +14,8 @@ public:
 
     void SetButtons(const Buttons &buttons);
 
-    bool SaveState(FILE *file);
-    bool LoadState(uint16_t version, FILE *file);
+    bool SaveState(StateWriter &writer);
+    bool LoadState(uint16_t version, StateReader &reader);
 
     // Inherited from IoRegisterProxy.
     virtual bool WriteByte(uint16_t address, uint8_t byte);
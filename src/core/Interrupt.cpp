@@ -80,20 +80,20 @@ void Interrupt::ClearInterrupt(eInterruptTypes type)
 }
 
 
-bool Interrupt::SaveState(FILE *file)
+bool Interrupt::SaveState(StateWriter &writer)
 {
-    if (!fwrite(&flagIME, sizeof(flagIME), 1, file))
+    if (!writer.Write(&flagIME, sizeof(flagIME)))
         return false;
 
     return true;
 }
 
 
-bool Interrupt::LoadState(uint16_t version, FILE *file)
+bool Interrupt::LoadState(uint16_t version, StateReader &reader)
 {
     (void)version;
 
-    if (!fread(&flagIME, sizeof(flagIME), 1, file))
+    if (!reader.Read(&flagIME, sizeof(flagIME)))
         return false;
 
     return true;
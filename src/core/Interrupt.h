@@ -2,6 +2,7 @@
 
 #include "gbemu.h"
 #include "IoRegisterProxy.h"
+#include "StateBuffer.h"
 
 
 enum eInterruptTypes
@@ -39,8 +40,8 @@ public:
     void RequestInterrupt(eInterruptTypes type);
     void ClearInterrupt(eInterruptTypes type);
 
-    bool SaveState(FILE *file);
-    bool LoadState(uint16_t version, FILE *file);
+    bool SaveState(StateWriter &writer);
+    bool LoadState(uint16_t version, StateReader &reader);
 
     // Inherited from IoRegisterProxy.
     virtual bool WriteByte(uint16_t address, uint8_t byte);
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <chrono>
+
+#include "LinkCable.h"
+#include "Logger.h"
+#include "Serial.h"
+
+
+LinkCable::LinkCable(uint quantum) :
+    quantum(quantum ? quantum : DEFAULT_QUANTUM)
+{
+    for (int i = 0; i < 2; i++)
+    {
+        ports[i].cable = this;
+        ports[i].index = i;
+        ports[i].nextSync = this->quantum;
+    }
+}
+
+
+LinkCable::~LinkCable()
+{
+
+}
+
+
+void LinkCable::Disconnect(int index)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        sides[index].connected = false;
+    }
+    changed.notify_all();
+}
+
+
+LinkCable::Stats LinkCable::GetStats(int index)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return sides[index].stats;
+}
+
+
+void LinkCable::Sync(int index, Serial *serial, uint64_t clock, uint64_t &nextSync)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    Side &self = sides[index];
+    Side &peer = sides[index ^ 1];
+
+    self.clock = clock;
+    ReplyToPeer(index, serial);
+    changed.notify_all();
+
+    if (clock < nextSync)
+        return;
+
+    nextSync = clock + quantum;
+    self.stats.syncs++;
+
+    // Don't run more than a quantum ahead of the peer.
+    if (peer.connected && peer.clock + quantum < clock)
+    {
+        auto start = std::chrono::steady_clock::now();
+        self.stats.waits++;
+
+        while (peer.connected && peer.clock + quantum < clock)
+        {
+            changed.wait(lock);
+
+            // The peer may have started a transfer while catching up. This side is already past the time of the
+            // transfer, so reply now. If this side can't reply yet, stop waiting, since the peer is blocked on it.
+            ReplyToPeer(index, serial);
+            if (peer.transferPending.load(std::memory_order_relaxed) && !peer.replyReady)
+                break;
+        }
+
+        self.stats.waitNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+
+uint8_t LinkCable::Transfer(int index, uint64_t clock, uint8_t byte)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    Side &self = sides[index];
+    Side &peer = sides[index ^ 1];
+
+    self.clock = clock;
+    self.stats.transfers++;
+
+    if (!peer.connected)
+        return 0xFF;
+
+    self.transferClock = clock;
+    self.transferByte = byte;
+    self.replyDeadline = 0;
+    self.replyReady = false;
+    self.transferPending.store(true, std::memory_order_release);
+    changed.notify_all();
+
+    // Wait for the peer to reach the time of the transfer and reply.
+    auto start = std::chrono::steady_clock::now();
+    self.stats.waits++;
+
+    while (!self.replyReady && peer.connected)
+    {
+        // If both sides use their internal clock, neither one is listening, so both shift in 0xFF.
+        if (peer.transferPending.load(std::memory_order_relaxed) && !peer.replyReady)
+        {
+            LogDebug("Link: both sides started a transfer with the internal clock");
+            peer.reply = 0xFF;
+            peer.replyReady = true;
+            peer.transferPending.store(false, std::memory_order_release);
+            self.reply = 0xFF;
+            self.replyReady = true;
+            changed.notify_all();
+            break;
+        }
+
+        changed.wait(lock);
+    }
+
+    self.stats.waitNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+
+    self.transferPending.store(false, std::memory_order_release);
+    return self.replyReady ? self.reply : 0xFF;
+}
+
+
+void LinkCable::ReplyToPeer(int index, Serial *serial)
+{
+    Side &self = sides[index];
+    Side &peer = sides[index ^ 1];
+
+    if (!peer.transferPending.load(std::memory_order_relaxed) || peer.replyReady || self.clock < peer.transferClock)
+        return;
+
+    if (peer.replyDeadline == 0)
+        peer.replyDeadline = std::max(self.clock, peer.transferClock) + quantum;
+
+    // If this side hasn't started a transfer using the external clock, give it until the deadline to start one, to
+    // make up for the sides running up to a quantum apart. After that, nothing is shifted out.
+    uint8_t byte;
+    if (serial->ExternalTransfer(peer.transferByte, byte))
+        peer.reply = byte;
+    else if (self.clock < peer.replyDeadline)
+        return;
+    else
+        peer.reply = 0xFF;
+
+    peer.replyReady = true;
+    peer.transferPending.store(false, std::memory_order_release);
+    changed.notify_all();
+}
\ No newline at end of file
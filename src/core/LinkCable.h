@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+#include "gbemu.h"
+#include "LinkInterface.h"
+#include "Serial.h"
+
+
+// Connects the serial ports of two emulator instances running on separate threads in the same process.
+//
+// The instances aren't synchronized every cycle. Instead, neither side is allowed to run more than a quantum of
+// clocks ahead of the other, and a transfer blocks the side clocking it until the peer has caught up to the time of
+// the transfer. Between transfers, both sides run at full speed on their own threads. Since the sides can be up to a
+// quantum apart, a side that hasn't started its external clock transfer yet when the peer's transfer arrives gets up
+// to a quantum of its own clocks to start it, before 0xFF is shifted in.
+class LinkCable
+{
+public:
+    static const uint DEFAULT_QUANTUM = 16384;
+
+    struct Stats
+    {
+        uint64_t syncs;           // Quantum boundaries reached.
+        uint64_t transfers;       // Transfers clocked by this side.
+        uint64_t waits;           // Times this side had to block on its peer.
+        uint64_t waitNanoseconds; // Time spent blocked on the peer.
+    };
+
+    explicit LinkCable(uint quantum = DEFAULT_QUANTUM);
+    ~LinkCable();
+
+    // Port 0 or 1. Pass to EmulatorMgr::SetLinkInterface().
+    LinkInterface *GetPort(int index) {return &ports[index];}
+
+    // Call when an instance stops running, so its peer doesn't wait for it. Transfers clocked by the peer after this
+    // shift in 0xFF, as if the cable was unplugged.
+    void Disconnect(int index);
+
+    Stats GetStats(int index);
+    uint GetQuantum() const {return quantum;}
+
+    // Don't allow copy and assignment.
+    LinkCable(const LinkCable&) = delete;
+    void operator=(const LinkCable&) = delete;
+
+private:
+    class Port : public LinkInterface
+    {
+    public:
+        Port() : cable(NULL), index(0), clock(0), nextSync(0) {}
+
+        // Inherited from LinkInterface.
+        virtual void UpdateLink(Serial *serial, uint clocks)
+        {
+            clock += clocks;
+
+            // Only take the lock at quantum boundaries, or when the peer is waiting for a reply this side can give.
+            if (clock >= nextSync || CanReply(serial))
+                cable->Sync(index, serial, clock, nextSync);
+        }
+
+        virtual uint8_t InternalTransfer(uint8_t byte)
+        {
+            return cable->Transfer(index, clock, byte);
+        }
+
+        // Both sides run in the same process, so a transfer always gets its real reply and never rolls back.
+        virtual void CheckpointSaved() {}
+        virtual uint8_t RolledBack() {return 0xFF;}
+
+        bool CanReply(Serial *serial) const
+        {
+            const Side &peer = cable->sides[index ^ 1];
+            return peer.transferPending.load(std::memory_order_acquire) && clock >= peer.transferClock &&
+                   (serial->ExternalTransferStarted() || clock >= peer.replyDeadline);
+        }
+
+        LinkCable *cable;
+        int index;
+        uint64_t clock;
+        uint64_t nextSync;
+    };
+
+    struct Side
+    {
+        Side() : clock(0), connected(true), transferPending(false), transferClock(0), transferByte(0),
+                 replyDeadline(0), replyReady(false), reply(0xFF), stats() {}
+
+        uint64_t clock;
+        bool connected;
+
+        // A transfer clocked by this side, waiting for the peer to reply.
+        std::atomic<bool> transferPending;
+        uint64_t transferClock;
+        uint8_t transferByte;
+        uint64_t replyDeadline;  // In the peer's clocks. Set by the peer when it first sees the transfer.
+        bool replyReady;
+        uint8_t reply;
+
+        Stats stats;
+    };
+
+    void Sync(int index, Serial *serial, uint64_t clock, uint64_t &nextSync);
+    uint8_t Transfer(int index, uint64_t clock, uint8_t byte);
+    void ReplyToPeer(int index, Serial *serial);
+
+    const uint quantum;
+
+    Port ports[2];
+    Side sides[2];
+
+    std::mutex mutex;
+    std::condition_variable changed;
+};
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "gbemu.h"
+
+class Serial;
+
+// The other end of the link cable, as seen from a Serial port.
+class LinkInterface
+{
+public:
+    // Work the link needs EmulatorMgr to do between instructions.
+    enum Request
+    {
+        eLinkRequestNone,
+        eLinkRequestCheckpoint,  // Save the machine state, then call CheckpointSaved().
+        eLinkRequestRollback     // Restore the last checkpoint, then call RolledBack().
+    };
+
+    LinkInterface() : request(eLinkRequestNone) {}
+
+    // Called by Serial for every timer update, with the number of clocks that passed. The link uses this to keep time
+    // with its peer, and calls serial->ExternalTransfer() when the peer clocks a transfer.
+    virtual void UpdateLink(Serial *serial, uint clocks) = 0;
+
+    // Called by Serial when a transfer using the internal clock finishes. Returns the byte shifted in from the peer.
+    virtual uint8_t InternalTransfer(uint8_t byte) = 0;
+
+    // Checked by EmulatorMgr after every instruction. Links that run ahead of their peer use this to have the state
+    // saved after a transfer with a predicted reply, and restored if the prediction turns out to be wrong.
+    Request GetRequest() const {return request;}
+
+    // Called by EmulatorMgr once the checkpoint has been saved.
+    virtual void CheckpointSaved() = 0;
+
+    // Called by EmulatorMgr once the checkpoint has been restored. Returns the byte the peer really shifted in, which
+    // EmulatorMgr writes to SB.
+    virtual uint8_t RolledBack() = 0;
+
+protected:
+    ~LinkInterface() {}
+
+    Request request;
+};
\ No newline at end of file
@@ -1,4 +1,3 @@
 #include "Logger.h"
 
-LoggerOutput *Logger::loggerOutput = NULL;
-LogLevel Logger::logLevel = LogLevel::eError;
\ No newline at end of file
+LoggerConfig Logger::defaultConfig = {NULL, LogLevel::eError};
\ No newline at end of file
@@ -39,12 +39,24 @@ public:
 };
 
 
+// Where log messages go, and which messages are logged.
+struct LoggerConfig
+{
+    LoggerOutput *output;
+    LogLevel level;
+};
+
+
 class Logger
 {
 public:
     static inline void Log(LogLevel level, const char *format, ...)
     {
-        if (level <= logLevel && loggerOutput != NULL)
+        const LoggerConfig *config = ThreadConfig();
+        if (config == NULL)
+            config = &defaultConfig;
+
+        if (level <= config->level && config->output != NULL)
         {
             va_list args;
             va_start(args, format);
@@ -52,22 +64,55 @@ public:
             char buf[1024];
             vsnprintf(buf, sizeof(buf), format, args);
 
-            loggerOutput->Output(std::unique_ptr<LogEntry>(new LogEntry(level, buf)));
+            config->output->Output(std::unique_ptr<LogEntry>(new LogEntry(level, buf)));
 
             va_end(args);
         }
     }
 
-    static void SetOutput(LoggerOutput *output) {loggerOutput = output;}
-    static void SetLogLevel(LogLevel level) {logLevel = level;}
-    static LogLevel GetLogLevel() {return logLevel;}
+    // These change the default config, which is used by threads that haven't set their own.
+    static void SetOutput(LoggerOutput *output) {defaultConfig.output = output;}
+    static void SetLogLevel(LogLevel level) {defaultConfig.level = level;}
+    static LogLevel GetLogLevel() {return defaultConfig.level;}
+
+    // Sets the config used by the calling thread, so emulator instances on different threads can log to different
+    // places. NULL reverts to the default config.
+    static void SetThreadConfig(const LoggerConfig *config) {ThreadConfig() = config;}
+    static const LoggerConfig *GetThreadConfig() {return ThreadConfig();}
 
 private:
-    // For now I only need one output at a time.
-    // If needed, change this in the future to support logging to more than one location.
-    static LoggerOutput *loggerOutput;
+    static inline const LoggerConfig *&ThreadConfig()
+    {
+        static thread_local const LoggerConfig *config = NULL;
+        return config;
+    }
+
+    static LoggerConfig defaultConfig;
+};
 
-    static LogLevel logLevel;
+
+// Sets the calling thread's logger config for the lifetime of the object.
+class ScopedLoggerConfig
+{
+public:
+    explicit ScopedLoggerConfig(const LoggerConfig *config) :
+        previous(Logger::GetThreadConfig())
+    {
+        if (config != NULL)
+            Logger::SetThreadConfig(config);
+    }
+
+    ~ScopedLoggerConfig()
+    {
+        Logger::SetThreadConfig(previous);
+    }
+
+    // Don't allow copy and assignment.
+    ScopedLoggerConfig(const ScopedLoggerConfig&) = delete;
+    void operator=(const ScopedLoggerConfig&) = delete;
+
+private:
+    const LoggerConfig *previous;
 };
 
 #define LogError(...) do {Logger::Log(LogLevel::eError, __VA_ARGS__);} while (0)
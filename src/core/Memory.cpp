@@ -57,6 +57,21 @@ const std::unordered_map<uint8_t, uint8_t> RomBankCountMap = {
     {0x54, 96}  // 12MB,  1.5MB
 };
 
+// Address ranges kept in save states. ROM is rebuilt from the cartridge and the bank registers, 0xE000-0xFDFF mirrors
+// WRAM, and 0xFEA0-0xFEFF can't be written.
+const struct
+{
+    uint16_t start;
+    uint16_t length;
+} StateRegions[] = {
+    {0x8000, 0x2000},            // VRAM
+    {0xA000, 0x2000},            // SRAM
+    {0xC000, 0x2000},            // WRAM
+    {OAM_RAM_START, OAM_RAM_LEN},
+    {0xFF00, 0x0100}             // IO registers, HRAM and IE
+};
+
+
 const std::unordered_map<uint8_t, uint8_t> RamBankCountMap = {
     {0, 0},  // None
     {1, 1},  // 16Kb,  2KB
@@ -66,7 +81,20 @@ const std::unordered_map<uint8_t, uint8_t> RamBankCountMap = {
 };
 
 
+// FNV-1a, which is fast enough to run over the whole ROM when it's loaded.
+static uint64_t HashRom(const std::vector<uint8_t> &rom)
+{
+    uint64_t hash = 0xCBF29CE484222325;
+    for (uint8_t byte : rom)
+        hash = (hash ^ byte) * 0x100000001B3;
+
+    return hash;
+}
+
+
 Memory::Memory(InfoInterface *infoInterface, DebuggerInterface *debuggerInterface) :
+    dirtyTiles(),
+    oamDirty(true),
     isDmaActive(false),
     dmaOffset(0),
     mbcType(eMbcNone),
@@ -76,6 +104,8 @@ Memory::Memory(InfoInterface *infoInterface, DebuggerInterface *debuggerInterfac
     curRamBank(0),
     batteryBackedRam(false),
     ramEnabled(false),
+    romHash(0),
+    bootRomMapped(false),
     infoInterface(infoInterface),
     debuggerInterface(debuggerInterface)
 {
@@ -96,6 +126,7 @@ void Memory::SetRomMemory(std::vector<uint8_t> &bootRomMemory, std::vector<uint8
     this->gameRomMemory = gameRomMemory;
 
     memcpy(memory.data(), bootRomMemory.data(), BOOT_ROM_SIZE);
+    bootRomMapped = true;
 
     if (gameRomMemory.size() <= BOOT_ROM_SIZE)
     {
@@ -109,6 +140,7 @@ void Memory::SetRomMemory(std::vector<uint8_t> &bootRomMemory, std::vector<uint8
     memcpy(&memory[BOOT_ROM_SIZE], &gameRomMemory[BOOT_ROM_SIZE], size);
 
     CheckRom();
+    romHash = HashRom(gameRomMemory);
 
     mbc = MbcFactory::GetMbcInstance(mbcType, this);
 
@@ -124,8 +156,10 @@ void Memory::SetRomMemory(std::vector<uint8_t> &gameRomMemory)
     size_t size = std::min(gameRomMemory.size(), ROM_BANK_SIZE * 2);
 
     memcpy(&memory[0], &gameRomMemory[0], size);
+    bootRomMapped = false;
 
     CheckRom();
+    romHash = HashRom(gameRomMemory);
 
     mbc = MbcFactory::GetMbcInstance(mbcType, this);
 
@@ -216,6 +250,11 @@ void Memory::WriteByte(uint16_t index, uint8_t byte)
     if (debuggerInterface != NULL)
         debuggerInterface->MemoryChanged(index, 1);
 
+    if (index >= VRAM_TILE_DATA_START && index < VRAM_TILE_DATA_START + VRAM_TILE_DATA_SIZE)
+        dirtyTiles[(index - VRAM_TILE_DATA_START) / VRAM_TILE_SIZE] = true;
+    else if (index >= OAM_RAM_START && index < OAM_RAM_START + OAM_RAM_LEN && memory[index] != byte)
+        oamDirty = true;
+
     // Let observers handle the update. If there are no observers for this address, update the value.
     if (!WriteIoRegisterProxy(index, byte))
     {
@@ -228,6 +267,8 @@ void Memory::ClearMemory()
 {
     memory.fill(0);
     ramBanks.clear();
+    dirtyTiles.set();
+    oamDirty = true;
 }
 
 
@@ -289,46 +330,84 @@ void Memory::SaveRam(const std::string &filename)
 }
 
 
-bool Memory::SaveState(FILE *file)
+bool Memory::SaveState(StateWriter &writer)
 {
-    if (!fwrite(&memory[0], MEM_SIZE, 1, file))
-        return false;
+    for (const auto &region : StateRegions)
+    {
+        if (!writer.Write(&memory[region.start], region.length))
+            return false;
+    }
 
     // If there is only a single RAM bank, it lives completely inside the main memory array.
     if (ramBankCount > 1)
     {
-        if (!fwrite(&ramBanks[0], ramBanks.size(), 1, file))
+        if (!writer.Write(&ramBanks[0], ramBanks.size()))
             return false;
     }
 
-    if (!fwrite(&curRomBank, sizeof(curRomBank), 1, file))
+    if (!writer.Write(&curRomBank, sizeof(curRomBank)))
+        return false;
+
+    if (!writer.Write(&curRamBank, sizeof(curRamBank)))
         return false;
 
-    if (!fwrite(&curRamBank, sizeof(curRamBank), 1, file))
+    if (!writer.Write(&ramEnabled, sizeof(ramEnabled)))
         return false;
 
-    if (!fwrite(&ramEnabled, sizeof(ramEnabled), 1, file))
+    if (!writer.Write(&isDmaActive, sizeof(isDmaActive)))
         return false;
 
-    if (!fwrite(&isDmaActive, sizeof(isDmaActive), 1, file))
+    if (!writer.Write(&dmaOffset, sizeof(dmaOffset)))
         return false;
 
-    if (!fwrite(&dmaOffset, sizeof(dmaOffset), 1, file))
+    if (!writer.Write(&bootRomMapped, sizeof(bootRomMapped)))
         return false;
 
-    return mbc->SaveState(file);
+    return mbc->SaveState(writer);
 }
 
 
-bool Memory::LoadState(uint16_t version, FILE *file)
+bool Memory::LoadState(uint16_t version, StateReader &reader)
 {
-    if (!fread(&memory[0], MEM_SIZE, 1, file))
+    // Rewind and run-ahead load a state every frame, and most tiles are the same in it, so only the tiles that change
+    // are marked dirty.
+    std::array<uint8_t, VRAM_TILE_DATA_SIZE> oldTileData;
+    memcpy(oldTileData.data(), &memory[VRAM_TILE_DATA_START], VRAM_TILE_DATA_SIZE);
+
+    bool success = true;
+    if (version < 3)
+    {
+        // Versions before 3 hold all of memory, including ROM. The boot ROM is still mapped if the start of memory
+        // doesn't match the game.
+        success = reader.Read(&memory[0], MEM_SIZE);
+
+        bootRomMapped = gameRomMemory.size() >= BOOT_ROM_SIZE &&
+                        memcmp(&memory[0], gameRomMemory.data(), BOOT_ROM_SIZE) != 0;
+    }
+    else
+    {
+        for (const auto &region : StateRegions)
+        {
+            if (success)
+                success = reader.Read(&memory[region.start], region.length);
+        }
+    }
+
+    for (uint tile = 0; tile < VRAM_TILE_COUNT; tile++)
+    {
+        const uint offset = tile * VRAM_TILE_SIZE;
+        if (memcmp(&oldTileData[offset], &memory[VRAM_TILE_DATA_START + offset], VRAM_TILE_SIZE) != 0)
+            dirtyTiles[tile] = true;
+    }
+    oamDirty = true;
+
+    if (!success)
         return false;
 
     // If there is only a single RAM bank, it lives completely inside the main memory array.
     if (ramBankCount > 1)
     {
-        if (!fread(&ramBanks[0], ramBanks.size(), 1, file))
+        if (!reader.Read(&ramBanks[0], ramBanks.size()))
             return false;
     }
 
@@ -336,29 +415,47 @@ bool Memory::LoadState(uint16_t version, FILE *file)
     {
         // Set defaults for values not in save version 1.
         // Will this break things? I don't know.
-        curRomBank = 0;
+        curRomBank = 1;
         curRamBank = 0;
         ramEnabled = false;
+
+        // The ROM bank isn't saved, but the memory mapped at 0x4000 is, so find the bank that matches it.
+        for (size_t bank = 1; (bank + 1) * ROM_BANK_SIZE <= gameRomMemory.size(); bank++)
+        {
+            if (memcmp(&memory[SWITCHABLE_ROM_BANK_OFFSET], &gameRomMemory[bank * ROM_BANK_SIZE], ROM_BANK_SIZE) == 0)
+            {
+                curRomBank = bank;
+                break;
+            }
+        }
     }
     else
     {
-        if (!fread(&curRomBank, sizeof(curRomBank), 1, file))
+        if (!reader.Read(&curRomBank, sizeof(curRomBank)))
             return false;
 
-        if (!fread(&curRamBank, sizeof(curRamBank), 1, file))
+        if (!reader.Read(&curRamBank, sizeof(curRamBank)))
             return false;
 
-        if (!fread(&ramEnabled, sizeof(ramEnabled), 1, file))
+        if (!reader.Read(&ramEnabled, sizeof(ramEnabled)))
             return false;
     }
 
-    if (!fread(&isDmaActive, sizeof(isDmaActive), 1, file))
+    if (!reader.Read(&isDmaActive, sizeof(isDmaActive)))
         return false;
 
-    if (!fread(&dmaOffset, sizeof(dmaOffset), 1, file))
+    if (!reader.Read(&dmaOffset, sizeof(dmaOffset)))
         return false;
 
-    return mbc->LoadState(version, file);
+    if (version >= 3)
+    {
+        if (!reader.Read(&bootRomMapped, sizeof(bootRomMapped)))
+            return false;
+
+        RestoreRomMemory();
+    }
+
+    return mbc->LoadState(version, reader);
 }
 
 
@@ -381,7 +478,13 @@ void Memory::UpdateTimer(uint value)
         uint16_t srcAddr = (memory[eRegDMA] << 8) | dmaOffset;
         uint16_t destAddr = OAM_RAM_START | dmaOffset;
         uint8_t byte = ReadByte(srcAddr); // Call ReadByte() in case we're reading from a special address.
-        memory[destAddr] = byte; // Write directly to memory, since there is no special processing to do on OAM memory.
+        // Write directly to memory, since there is no special processing to do on OAM memory. Most games copy the same
+        // sprites every frame, so OAM is only marked dirty if they changed.
+        if (memory[destAddr] != byte)
+        {
+            memory[destAddr] = byte;
+            oamDirty = true;
+        }
 
         dmaOffset++;
     }
@@ -392,12 +495,30 @@ void Memory::DisableBootRom()
 {
     // TODO: Fix this segfaulting when gameRomMemory isn't set.
     memcpy(memory.data(), gameRomMemory.data(), BOOT_ROM_SIZE);
+    bootRomMapped = false;
 
     if (debuggerInterface != NULL)
         debuggerInterface->MemoryChanged(0, BOOT_ROM_SIZE);
 }
 
 
+void Memory::RestoreRomMemory()
+{
+    // Bank 0 is always mapped at 0x0000, with the boot ROM over the start of it until the boot ROM is disabled.
+    memcpy(&memory[0], gameRomMemory.data(), std::min(gameRomMemory.size(), ROM_BANK_SIZE));
+    if (bootRomMapped && bootRomMemory.size() >= BOOT_ROM_SIZE)
+        memcpy(&memory[0], bootRomMemory.data(), BOOT_ROM_SIZE);
+
+    const size_t bankOffset = curRomBank * ROM_BANK_SIZE;
+    if (bankOffset < gameRomMemory.size())
+        memcpy(&memory[SWITCHABLE_ROM_BANK_OFFSET], &gameRomMemory[bankOffset],
+               std::min(gameRomMemory.size() - bankOffset, ROM_BANK_SIZE));
+
+    if (debuggerInterface != NULL)
+        debuggerInterface->MemoryChanged(0, ROM_BANK_SIZE * 2);
+}
+
+
 void Memory::CheckRom()
 {
     // Check for valid ROM size.
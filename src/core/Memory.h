@@ -1,12 +1,14 @@
 #pragma once
 
 #include <array>
+#include <bitset>
 #include <memory>
 #include <vector>
 
 #include "gbemu.h"
 #include "IoRegisterProxy.h"
 #include "MemoryBankController.h"
+#include "StateBuffer.h"
 #include "TimerObserver.h"
 
 class DebuggerInterface;
@@ -95,6 +97,11 @@ const size_t BOOT_ROM_SIZE = 0x100;
 const uint16_t OAM_RAM_START = 0xFE00; // OAM(sprite) RAM is 0xFE00-0xFE9F.
 const uint8_t OAM_RAM_LEN = 0xA0;
 
+const uint16_t VRAM_TILE_DATA_START = 0x8000; // Tile data is 0x8000-0x97FF.
+const uint16_t VRAM_TILE_DATA_SIZE = 0x1800;
+const uint VRAM_TILE_SIZE = 16;
+const uint VRAM_TILE_COUNT = VRAM_TILE_DATA_SIZE / VRAM_TILE_SIZE;
+
 
 class Memory : public MemoryBankInterface, public IoRegisterSubject, public TimerObserver
 {
@@ -118,15 +125,30 @@ public:
 
     uint8_t GetCurRomBank() const {return curRomBank;}
 
+    // Hash of the game ROM, so save states can tell which game they belong to.
+    uint64_t GetRomHash() const {return romHash;}
+
     void WriteByte(uint16_t index, uint8_t byte);
 
+    // A VRAM tile is marked dirty when its data changes, so a decoded copy of it can be kept until then, see TileCache.
+    // Tiles are numbered from 0x8000. The marks have a single consumer, which clears them as it decodes the tiles.
+    // Writes through GetBytePtr() aren't tracked.
+    bool IsTileDirty(uint tile) const {return dirtyTiles[tile];}
+    void ClearTileDirty(uint tile) {dirtyTiles[tile] = false;}
+    void MarkAllTilesDirty() {dirtyTiles.set();}
+
+    // OAM is marked dirty when a sprite changes, so the sprites found on each scanline can be kept until then, see
+    // Display. Like the tile marks, it has a single consumer, and writes through GetBytePtr() aren't tracked.
+    bool IsOamDirty() const {return oamDirty;}
+    void ClearOamDirty() {oamDirty = false;}
+
     void ClearMemory();
 
     void LoadRam(const std::string &filename);
     void SaveRam(const std::string &filename);
 
-    bool SaveState(FILE *file);
-    bool LoadState(uint16_t version, FILE *file);
+    bool SaveState(StateWriter &writer);
+    bool LoadState(uint16_t version, StateReader &reader);
 
     // Inherited from TimerObserver.
     virtual void UpdateTimer(uint value);
@@ -138,8 +160,11 @@ public:
 private:
     void DisableBootRom();
     void CheckRom();
+    void RestoreRomMemory();
 
     std::array<uint8_t, MEM_SIZE> memory;
+    std::bitset<VRAM_TILE_COUNT> dirtyTiles;
+    bool oamDirty;
 
     std::vector<uint8_t> bootRomMemory;
     std::vector<uint8_t> gameRomMemory;
@@ -157,6 +182,8 @@ private:
     uint8_t curRamBank;
     bool batteryBackedRam;
     bool ramEnabled;
+    uint64_t romHash;
+    bool bootRomMapped;
 
     InfoInterface *infoInterface;
     DebuggerInterface *debuggerInterface;
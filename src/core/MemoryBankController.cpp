@@ -50,16 +50,16 @@ void MbcNone::WriteByte(uint16_t addr, uint8_t byte)
 }
 
 
-bool MbcNone::SaveState(FILE *file)
+bool MbcNone::SaveState(StateWriter &writer)
 {
-    (void)file; // Stop warnings about unused variables.
+    (void)writer; // Stop warnings about unused variables.
     return true;
 }
 
 
-bool MbcNone::LoadState(uint16_t version, FILE *file)
+bool MbcNone::LoadState(uint16_t version, StateReader &reader)
 {
-    (void)file; // Stop warnings about unused variables.
+    (void)reader; // Stop warnings about unused variables.
     (void)version;
     return true;
 }
@@ -132,38 +132,38 @@ void Mbc1::WriteByte(uint16_t addr, uint8_t byte)
 }
 
 
-bool Mbc1::SaveState(FILE *file)
+bool Mbc1::SaveState(StateWriter &writer)
 {
-    if (!fwrite(&regRamEnable, sizeof(regRamEnable), 1, file))
+    if (!writer.Write(&regRamEnable, sizeof(regRamEnable)))
         return false;
 
-    if (!fwrite(&regRomLowBits, sizeof(regRomLowBits), 1, file))
+    if (!writer.Write(&regRomLowBits, sizeof(regRomLowBits)))
         return false;
 
-    if (!fwrite(&regRomHighBits, sizeof(regRomHighBits), 1, file))
+    if (!writer.Write(&regRomHighBits, sizeof(regRomHighBits)))
         return false;
 
-    if (!fwrite(&regRamMode, sizeof(regRamMode), 1, file))
+    if (!writer.Write(&regRamMode, sizeof(regRamMode)))
         return false;
 
     return true;
 }
 
 
-bool Mbc1::LoadState(uint16_t version, FILE *file)
+bool Mbc1::LoadState(uint16_t version, StateReader &reader)
 {
     (void)version;
 
-    if (!fread(&regRamEnable, sizeof(regRamEnable), 1, file))
+    if (!reader.Read(&regRamEnable, sizeof(regRamEnable)))
         return false;
 
-    if (!fread(&regRomLowBits, sizeof(regRomLowBits), 1, file))
+    if (!reader.Read(&regRomLowBits, sizeof(regRomLowBits)))
         return false;
 
-    if (!fread(&regRomHighBits, sizeof(regRomHighBits), 1, file))
+    if (!reader.Read(&regRomHighBits, sizeof(regRomHighBits)))
         return false;
 
-    if (!fread(&regRamMode, sizeof(regRamMode), 1, file))
+    if (!reader.Read(&regRamMode, sizeof(regRamMode)))
         return false;
 
     return true;
@@ -210,31 +210,31 @@ void Mbc2::WriteByte(uint16_t addr, uint8_t byte)
 }
 
 
-bool Mbc2::SaveState(FILE *file)
+bool Mbc2::SaveState(StateWriter &writer)
 {
-    if (!fwrite(&regRamEnable, sizeof(regRamEnable), 1, file))
+    if (!writer.Write(&regRamEnable, sizeof(regRamEnable)))
         return false;
 
-    if (!fwrite(&regRomBank, sizeof(regRomBank), 1, file))
+    if (!writer.Write(&regRomBank, sizeof(regRomBank)))
         return false;
 
     return true;
 }
 
 
-bool Mbc2::LoadState(uint16_t version, FILE *file)
+bool Mbc2::LoadState(uint16_t version, StateReader &reader)
 {
-    if (!fread(&regRamEnable, sizeof(regRamEnable), 1, file))
+    if (!reader.Read(&regRamEnable, sizeof(regRamEnable)))
         return false;
 
-    if (!fread(&regRomBank, sizeof(regRomBank), 1, file))
+    if (!reader.Read(&regRomBank, sizeof(regRomBank)))
         return false;
 
     if (version == 1)
     {
         // Version 1 saved two extra bytes when all MBC types were in one class.
         uint16_t dummy;
-        if (!fread(&dummy, sizeof(dummy), 1, file))
+        if (!reader.Read(&dummy, sizeof(dummy)))
             return false;
     }
 
@@ -296,38 +296,38 @@ void Mbc3::WriteByte(uint16_t addr, uint8_t byte)
 }
 
 
-bool Mbc3::SaveState(FILE *file)
+bool Mbc3::SaveState(StateWriter &writer)
 {
-    if (!fwrite(&regRamEnable, sizeof(regRamEnable), 1, file))
+    if (!writer.Write(&regRamEnable, sizeof(regRamEnable)))
         return false;
 
-    if (!fwrite(&regRomBank, sizeof(regRomBank), 1, file))
+    if (!writer.Write(&regRomBank, sizeof(regRomBank)))
         return false;
 
-    if (!fwrite(&regRamBank, sizeof(regRamBank), 1, file))
+    if (!writer.Write(&regRamBank, sizeof(regRamBank)))
         return false;
 
-    if (!fwrite(&regRtcLatch, sizeof(regRtcLatch), 1, file))
+    if (!writer.Write(&regRtcLatch, sizeof(regRtcLatch)))
         return false;
 
     return true;
 }
 
 
-bool Mbc3::LoadState(uint16_t version, FILE *file)
+bool Mbc3::LoadState(uint16_t version, StateReader &reader)
 {
     (void)version;
 
-    if (!fread(&regRamEnable, sizeof(regRamEnable), 1, file))
+    if (!reader.Read(&regRamEnable, sizeof(regRamEnable)))
         return false;
 
-    if (!fread(&regRomBank, sizeof(regRomBank), 1, file))
+    if (!reader.Read(&regRomBank, sizeof(regRomBank)))
         return false;
 
-    if (!fread(&regRamBank, sizeof(regRamBank), 1, file))
+    if (!reader.Read(&regRamBank, sizeof(regRamBank)))
         return false;
 
-    if (!fread(&regRtcLatch, sizeof(regRtcLatch), 1, file))
+    if (!reader.Read(&regRtcLatch, sizeof(regRtcLatch)))
         return false;
 
     return true;
@@ -3,6 +3,7 @@
 #include <memory>
 
 #include "gbemu.h"
+#include "StateBuffer.h"
 
 class AbsMbc;
 
@@ -46,8 +47,8 @@ public:
 
     virtual void WriteByte(uint16_t addr, uint8_t byte) = 0;
 
-    virtual bool SaveState(FILE *file) = 0;
-    virtual bool LoadState(uint16_t version, FILE *file) = 0;
+    virtual bool SaveState(StateWriter &writer) = 0;
+    virtual bool LoadState(uint16_t version, StateReader &reader) = 0;
 
 protected:
     MemoryBankInterface *memory;
@@ -64,8 +65,8 @@ public:
 
     virtual void WriteByte(uint16_t addr, uint8_t byte);
 
-    virtual bool SaveState(FILE *file);
-    virtual bool LoadState(uint16_t version, FILE *file);
+    virtual bool SaveState(StateWriter &writer);
+    virtual bool LoadState(uint16_t version, StateReader &reader);
 };
 
 
@@ -79,8 +80,8 @@ public:
 
     virtual void WriteByte(uint16_t addr, uint8_t byte);
 
-    virtual bool SaveState(FILE *file);
-    virtual bool LoadState(uint16_t version, FILE *file);
+    virtual bool SaveState(StateWriter &writer);
+    virtual bool LoadState(uint16_t version, StateReader &reader);
 
 private:
     uint8_t regRamEnable;
@@ -100,8 +101,8 @@ public:
 
     virtual void WriteByte(uint16_t addr, uint8_t byte);
 
-    virtual bool SaveState(FILE *file);
-    virtual bool LoadState(uint16_t version, FILE *file);
+    virtual bool SaveState(StateWriter &writer);
+    virtual bool LoadState(uint16_t version, StateReader &reader);
 
 private:
     uint8_t regRamEnable;
@@ -119,8 +120,8 @@ public:
 
     virtual void WriteByte(uint16_t addr, uint8_t byte);
 
-    virtual bool SaveState(FILE *file);
-    virtual bool LoadState(uint16_t version, FILE *file);
+    virtual bool SaveState(StateWriter &writer);
+    virtual bool LoadState(uint16_t version, StateReader &reader);
 
 private:
     uint8_t regRamEnable;
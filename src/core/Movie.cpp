@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <errno.h>
+#include <fstream>
+#include <iterator>
+#include <string.h>
+
+#include "Logger.h"
+#include "Movie.h"
+#include "StateCompressor.h"
+#include "Varint.h"
+
+
+Movie::Movie() :
+    startState(),
+    romHash(0),
+    fromPowerOn(false),
+    frameCount(0),
+    runs(),
+    playRun(0),
+    playFrame(0)
+{
+
+}
+
+
+void Movie::StartRecording(const std::vector<uint8_t> &startState, uint64_t romHash, bool fromPowerOn)
+{
+    this->startState = startState;
+    this->romHash = romHash;
+    this->fromPowerOn = fromPowerOn;
+    frameCount = 0;
+    runs.clear();
+    playRun = 0;
+    playFrame = 0;
+}
+
+
+void Movie::UnrecordFrames(uint64_t frames)
+{
+    while (frames > 0 && !runs.empty())
+    {
+        const uint64_t dropped = std::min(frames, runs.back().frames);
+        runs.back().frames -= dropped;
+        frameCount -= dropped;
+        frames -= dropped;
+
+        if (runs.back().frames == 0)
+            runs.pop_back();
+    }
+}
+
+
+void Movie::UnplayFrames(uint64_t frames)
+{
+    for (; frames > 0; frames--)
+    {
+        if (playFrame == 0)
+        {
+            if (playRun == 0)
+                return;
+            playRun--;
+            playFrame = runs[playRun].frames;
+        }
+
+        playFrame--;
+    }
+}
+
+
+bool Movie::Save(const std::string &filename) const
+{
+    std::vector<uint8_t> compressedState;
+    StateCompressor::Compress(startState.data(), startState.size(), compressedState);
+
+    MovieHeader header;
+    memcpy(header.magic, MOVIE_MAGIC, sizeof(header.magic));
+    header.version = MOVIE_VERSION;
+    header.flags = fromPowerOn ? eMovieFromPowerOn : 0;
+    header.stateSize = compressedState.size();
+    header.romHash = romHash;
+    header.frameCount = frameCount;
+
+    // A varint takes at most 10 bytes.
+    std::vector<uint8_t> input(runs.size() * 11);
+    uint8_t *ptr = input.data();
+    for (const Run &run : runs)
+    {
+        ptr = WriteVarint(ptr, run.frames);
+        *ptr++ = run.buttons;
+    }
+    input.resize(ptr - input.data());
+
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(compressedState.data()), compressedState.size());
+    file.write(reinterpret_cast<const char *>(input.data()), input.size());
+    file.close();
+
+    if (!file)
+    {
+        LogError("Error writing movie file %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    LogError("Saved movie to %s, %llu frames", filename.c_str(), (unsigned long long)frameCount);
+
+    return true;
+}
+
+
+bool Movie::Load(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+    {
+        LogError("Error opening movie file %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    MovieHeader header;
+    if (data.size() < sizeof(header))
+    {
+        LogError("Movie file %s is too small", filename.c_str());
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (memcmp(header.magic, MOVIE_MAGIC, sizeof(header.magic)) || header.version != MOVIE_VERSION ||
+        header.stateSize > data.size() - sizeof(header))
+    {
+        LogError("Movie file %s has an invalid header", filename.c_str());
+        return false;
+    }
+
+    const uint8_t *ptr = &data[sizeof(header)];
+    const uint8_t * const end = data.data() + data.size();
+    std::vector<uint8_t> state;
+    if (!StateCompressor::Decompress(ptr, header.stateSize, state))
+    {
+        LogError("Error decompressing the start state in movie file %s", filename.c_str());
+        return false;
+    }
+    ptr += header.stateSize;
+
+    std::vector<Run> newRuns;
+    uint64_t newFrameCount = 0;
+    while (ptr < end)
+    {
+        size_t frames;
+        ptr = ReadVarint(ptr, end, frames);
+        if (ptr == NULL || ptr == end || frames == 0)
+        {
+            LogError("Movie file %s is corrupt", filename.c_str());
+            return false;
+        }
+
+        newRuns.push_back(Run{frames, *ptr++});
+        newFrameCount += frames;
+    }
+
+    if (newFrameCount != header.frameCount)
+    {
+        LogError("Movie file %s has %llu frames, expected %llu", filename.c_str(), (unsigned long long)newFrameCount,
+                 (unsigned long long)header.frameCount);
+        return false;
+    }
+
+    startState.swap(state);
+    romHash = header.romHash;
+    fromPowerOn = header.flags & eMovieFromPowerOn;
+    frameCount = newFrameCount;
+    runs.swap(newRuns);
+    playRun = 0;
+    playFrame = 0;
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "gbemu.h"
+
+// Input movie format.
+//
+// A movie holds the state it starts from and the buttons held on every frame after that, so a run can be played back
+// exactly. Buttons only change at frame boundaries while a movie records or plays, so nothing else is needed. The file
+// starts with a MovieHeader, followed by stateSize bytes of start state compressed with StateCompressor, and then the
+// buttons as a list of runs:
+//
+//   varint   frames   Number of frames the buttons are held for, at least 1.
+//   uint8_t  buttons  Buttons::data for those frames.
+//
+// Buttons rarely change from one frame to the next, so a movie is a few bytes per button press.
+
+const char MOVIE_MAGIC[8] = {'Z', 'L', 'G', 'B', 'M', 'O', 'V', '\0'};
+const uint16_t MOVIE_VERSION = 1;
+
+enum MovieFlags
+{
+    eMovieFromPowerOn = 0x01  // The start state is the game at power on, rather than a state it was recorded from.
+};
+
+struct MovieHeader
+{
+    char magic[8];
+    uint16_t version;
+    uint16_t flags;
+    uint32_t stateSize;
+    uint64_t romHash;
+    uint64_t frameCount;
+};
+
+
+class Movie
+{
+public:
+    Movie();
+
+    // Starts a new movie from the given snapshot. The buttons each frame ran with are added with RecordFrame() when
+    // the frame ends.
+    void StartRecording(const std::vector<uint8_t> &startState, uint64_t romHash, bool fromPowerOn);
+    bool Save(const std::string &filename) const;
+
+    // Loads a movie, and starts playing it from the first frame. The buttons for each frame come from PlayFrame().
+    bool Load(const std::string &filename);
+
+    void RecordFrame(uint8_t buttons)
+    {
+        if (runs.empty() || runs.back().buttons != buttons)
+            runs.push_back(Run{0, buttons});
+
+        runs.back().frames++;
+        frameCount++;
+    }
+
+    // Gets the buttons for the next frame, called before the first frame and at the end of each one. Returns false
+    // at the end of the movie.
+    bool PlayFrame(uint8_t &buttons)
+    {
+        if (playRun == runs.size())
+            return false;
+
+        buttons = runs[playRun].buttons;
+        if (++playFrame == runs[playRun].frames)
+        {
+            playRun++;
+            playFrame = 0;
+        }
+        return true;
+    }
+
+    // Take back the last frames recorded or played, when the frames are undone and will be run again.
+    void UnrecordFrames(uint64_t frames);
+    void UnplayFrames(uint64_t frames);
+
+    const std::vector<uint8_t> &GetStartState() const {return startState;}
+    uint64_t GetRomHash() const {return romHash;}
+    bool IsFromPowerOn() const {return fromPowerOn;}
+    uint64_t GetFrameCount() const {return frameCount;}
+
+    // Don't allow copy and assignment.
+    Movie(const Movie&) = delete;
+    void operator=(const Movie&) = delete;
+
+private:
+    struct Run
+    {
+        uint64_t frames;
+        uint8_t buttons;
+    };
+
+    std::vector<uint8_t> startState;
+    uint64_t romHash;
+    bool fromPowerOn;
+    uint64_t frameCount;
+
+    std::vector<Run> runs;
+    size_t playRun;       // Run the next played frame is in.
+    uint64_t playFrame;   // Frames of that run already played.
+};
\ No newline at end of file
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "gbemu.h"
+
+// Returns the length in bytes of the instruction starting with the given opcode. 0xCB is a prefix for a 2 byte
+// instruction.
+uint8_t GetOpcodeLength(uint8_t opcode);
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "Palette.h"
+
+
+// Lightest first. Gray is evenly spaced, green is the tint of the original DMG screen.
+const uint32_t Palette::SHADE_COLORS[eShadesCount][4] = {
+    {0xFFFFFF, 0xB0B0B0, 0x686868, 0x000000},
+    {0x9BBC0F, 0x8BAC0F, 0x306230, 0x0F380F},
+};
+
+
+Palette::Palette() :
+    paletteReg(0),
+    shades(eShadesGray)
+{
+    UpdateColors();
+}
+
+
+void Palette::SetRegister(uint8_t paletteReg)
+{
+    this->paletteReg = paletteReg;
+    UpdateColors();
+}
+
+
+void Palette::SetShades(Shades shades)
+{
+    this->shades = shades;
+    UpdateColors();
+}
+
+
+void Palette::UpdateColors()
+{
+    for (uint i = 0; i < 4; i++)
+        colors[i] = SHADE_COLORS[shades][(paletteReg >> (i * 2)) & 0x03];
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "gbemu.h"
+
+
+// Colors of the 2-bit palette indices of one palette register, BGP, OBP0 or OBP1.
+//
+// The register picks one of 4 shades for each index, and the shades are the colors the screen is drawn in, which can
+// be changed to look like a different screen. The colors are worked out again only when the register or the shades
+// change, so looking up a pixel's color is a single table read.
+class Palette
+{
+public:
+    enum Shades
+    {
+        eShadesGray,
+        eShadesGreen,
+        eShadesCount
+    };
+
+    Palette();
+
+    void SetRegister(uint8_t paletteReg);
+    void SetShades(Shades shades);
+
+    // The color of each palette index, as 0xRRGGBB.
+    const uint32_t *GetColors() const {return colors;}
+    // The color of a shade itself, whatever the register holds.
+    uint32_t GetShadeColor(uint shade) const {return SHADE_COLORS[shades][shade];}
+
+private:
+    void UpdateColors();
+
+    static const uint32_t SHADE_COLORS[eShadesCount][4];
+
+    uint8_t paletteReg;
+    Shades shades;
+    uint32_t colors[4];
+};
\ No newline at end of file
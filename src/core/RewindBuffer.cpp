@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <string.h>
+
+#include "Logger.h"
+#include "RewindBuffer.h"
+#include "Varint.h"
+
+// Runs of fewer unchanged bytes than this are stored as part of the changed bytes around them, since a new run costs
+// more than the bytes it would skip.
+const size_t MIN_SKIP_LENGTH = 4;
+
+
+static inline uint64_t LoadWord(const uint8_t *ptr)
+{
+    uint64_t word;
+    memcpy(&word, ptr, sizeof(word));
+    return word;
+}
+
+
+RewindBuffer::RewindBuffer(size_t capacity, uint keyframeInterval) :
+    buffer(capacity),
+    head(0),
+    frames(),
+    keyframeInterval(keyframeInterval ? keyframeInterval : DEFAULT_KEYFRAME_INTERVAL),
+    deltasSinceKeyframe(0),
+    snapshotSize(0),
+    current(),
+    next(),
+    encoded(),
+    captureStart(),
+    stats()
+{
+    stats.capacity = capacity;
+}
+
+
+RewindBuffer::~RewindBuffer()
+{
+
+}
+
+
+void RewindBuffer::Reset(size_t snapshotSize)
+{
+    this->snapshotSize = snapshotSize;
+    current.assign(snapshotSize, 0);
+    next.assign(snapshotSize, 0);
+
+    // Worst case is a changed byte between every run of unchanged bytes, which costs up to 3 bytes of run lengths.
+    encoded.resize(snapshotSize * 2 + 16);
+
+    head = 0;
+    frames.clear();
+    deltasSinceKeyframe = 0;
+
+    const size_t capacity = stats.capacity;
+    stats = Stats();
+    stats.capacity = capacity;
+}
+
+
+uint8_t *RewindBuffer::BeginCapture()
+{
+    captureStart = std::chrono::steady_clock::now();
+    return next.data();
+}
+
+
+void RewindBuffer::EndCapture()
+{
+    bool keyframe = frames.empty() || deltasSinceKeyframe + 1 >= keyframeInterval;
+    size_t size = Encode(next.data(), keyframe ? NULL : current.data(), encoded.data());
+
+    // Making room may have dropped every frame, including the ones this delta depends on.
+    if (!Store(size, keyframe) && !keyframe)
+    {
+        keyframe = true;
+        size = Encode(next.data(), NULL, encoded.data());
+        if (!Store(size, keyframe))
+            LogError("Rewind buffer of %zu bytes is too small for a single frame", buffer.size());
+    }
+
+    deltasSinceKeyframe = keyframe ? 0 : deltasSinceKeyframe + 1;
+    current.swap(next);
+
+    const uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - captureStart).count();
+    stats.captures++;
+    stats.lastCaptureNanoseconds = nanoseconds;
+    stats.totalCaptureNanoseconds += nanoseconds;
+    stats.maxCaptureNanoseconds = std::max(stats.maxCaptureNanoseconds, nanoseconds);
+}
+
+
+const uint8_t *RewindBuffer::StepBack()
+{
+    if (frames.size() < 2)
+        return NULL;
+
+    const Frame newest = frames.back();
+    frames.pop_back();
+    head = newest.offset;
+    stats.bytesUsed -= newest.size;
+
+    if (!newest.keyframe)
+    {
+        // The delta is the XOR of the newest snapshot and the one before it.
+        Apply(newest, current.data());
+        deltasSinceKeyframe--;
+        return current.data();
+    }
+
+    // Rebuild the frame before the keyframe, starting from the keyframe before that. The oldest frame is always a
+    // keyframe, so there is one.
+    size_t keyframeIndex = frames.size() - 1;
+    while (!frames[keyframeIndex].keyframe)
+        keyframeIndex--;
+
+    memset(current.data(), 0, snapshotSize);
+    for (size_t i = keyframeIndex; i < frames.size(); i++)
+        Apply(frames[i], current.data());
+
+    deltasSinceKeyframe = frames.size() - 1 - keyframeIndex;
+    return current.data();
+}
+
+
+RewindBuffer::Stats RewindBuffer::GetStats() const
+{
+    Stats result = stats;
+    result.frames = frames.size();
+    return result;
+}
+
+
+size_t RewindBuffer::Encode(const uint8_t *snapshot, const uint8_t *reference, uint8_t *out) const
+{
+    // A keyframe is a delta against a snapshot of all zeros.
+    auto same = [snapshot, reference](size_t i) {return snapshot[i] == (reference ? reference[i] : 0);};
+
+    uint8_t *ptr = out;
+    size_t i = 0;
+    while (i < snapshotSize)
+    {
+        // Skip unchanged bytes, a word at a time while possible.
+        size_t start = i;
+        while (i + sizeof(uint64_t) <= snapshotSize &&
+               LoadWord(&snapshot[i]) == (reference ? LoadWord(&reference[i]) : 0))
+            i += sizeof(uint64_t);
+        while (i < snapshotSize && same(i))
+            i++;
+        const size_t skipLength = i - start;
+
+        // Take changed bytes until the next run of unchanged bytes that is worth skipping.
+        start = i;
+        size_t sameCount = 0;
+        while (i < snapshotSize && sameCount < MIN_SKIP_LENGTH)
+        {
+            sameCount = same(i) ? sameCount + 1 : 0;
+            i++;
+        }
+        if (sameCount == MIN_SKIP_LENGTH)
+            i -= sameCount;
+        const size_t changedLength = i - start;
+
+        ptr = WriteVarint(ptr, skipLength);
+        ptr = WriteVarint(ptr, changedLength);
+        for (size_t j = start; j < i; j++)
+            *ptr++ = snapshot[j] ^ (reference ? reference[j] : 0);
+    }
+
+    return ptr - out;
+}
+
+
+void RewindBuffer::Apply(const Frame &frame, uint8_t *snapshot) const
+{
+    const uint8_t *ptr = &buffer[frame.offset];
+    const uint8_t * const end = ptr + frame.size;
+    size_t offset = 0;
+
+    while (ptr < end)
+    {
+        size_t skipLength, changedLength;
+        ptr = ReadVarint(ptr, skipLength);
+        ptr = ReadVarint(ptr, changedLength);
+
+        offset += skipLength;
+        for (size_t i = 0; i < changedLength; i++)
+            snapshot[offset++] ^= *ptr++;
+    }
+}
+
+
+bool RewindBuffer::Store(size_t size, bool keyframe)
+{
+    if (size > buffer.size())
+        return false;
+
+    // Frames are stored one after the other, wrapping to the start when the next one doesn't fit before the end.
+    size_t offset;
+    for (;;)
+    {
+        offset = head + size <= buffer.size() ? head : 0;
+        if (IsFree(offset, size))
+            break;
+
+        DropOldestKeyframe();
+
+        // A delta can't be stored without the frames it depends on.
+        if (frames.empty() && !keyframe)
+            return false;
+    }
+
+    memcpy(&buffer[offset], encoded.data(), size);
+    frames.push_back(Frame{offset, size, keyframe});
+    head = offset + size;
+    stats.bytesUsed += size;
+
+    return true;
+}
+
+
+bool RewindBuffer::IsFree(size_t offset, size_t size) const
+{
+    if (frames.empty())
+        return offset + size <= buffer.size();
+
+    // The frames in use run from the oldest frame up to head, possibly wrapping around the end of the buffer.
+    const size_t tail = frames.front().offset;
+    if (tail < head)
+        return offset == head ? offset + size <= buffer.size() : offset + size <= tail;
+    else
+        return offset == head && offset + size <= tail;
+}
+
+
+void RewindBuffer::DropOldestKeyframe()
+{
+    // Deltas after the oldest keyframe can't be rebuilt without it, so they go too.
+    do
+    {
+        stats.bytesUsed -= frames.front().size;
+        frames.pop_front();
+    } while (!frames.empty() && !frames.front().keyframe);
+
+    if (frames.empty())
+    {
+        head = 0;
+        deltasSinceKeyframe = 0;
+    }
+}
\ No newline at end of file
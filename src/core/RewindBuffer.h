@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+#include "gbemu.h"
+
+
+// History of snapshots, one per frame, kept in a fixed size buffer so memory use is bounded.
+//
+// Every keyframeInterval frames, a keyframe holds a full snapshot. The frames in between hold a delta, the XOR of the
+// snapshot with the one from the frame before. Most of the state doesn't change between frames, so deltas are mostly
+// zero, and both kinds of frame are stored run length encoded. Since XOR undoes itself, stepping back from a delta is
+// just applying it to the newest snapshot again. Stepping back past a keyframe rebuilds the frame before it from the
+// previous keyframe.
+//
+// When the buffer is full, the oldest keyframe and the deltas that depend on it are dropped together.
+class RewindBuffer
+{
+public:
+    static const size_t DEFAULT_CAPACITY = 32 * 1024 * 1024;
+    static const uint DEFAULT_KEYFRAME_INTERVAL = 60;
+
+    struct Stats
+    {
+        uint frames;                    // Frames that can be stepped back to.
+        size_t bytesUsed;               // Encoded size of those frames.
+        size_t capacity;
+        uint64_t captures;              // Frames captured since the last reset.
+        uint64_t lastCaptureNanoseconds;
+        uint64_t totalCaptureNanoseconds;
+        uint64_t maxCaptureNanoseconds;
+    };
+
+    RewindBuffer(size_t capacity = DEFAULT_CAPACITY, uint keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+    ~RewindBuffer();
+
+    // Drops all history. Must be called before the first capture, and whenever the snapshot size changes.
+    void Reset(size_t snapshotSize);
+
+    // Capturing a frame is split in two, so the snapshot can be written straight into the buffer returned by
+    // BeginCapture(). EndCapture() encodes it as the newest frame. The capture time includes writing the snapshot.
+    uint8_t *BeginCapture();
+    void EndCapture();
+
+    // Drops the newest frame, and returns the snapshot of the frame before it, or NULL if there is no older frame.
+    // The snapshot stays valid until the next call.
+    const uint8_t *StepBack();
+
+    Stats GetStats() const;
+
+    // Don't allow copy and assignment.
+    RewindBuffer(const RewindBuffer&) = delete;
+    void operator=(const RewindBuffer&) = delete;
+
+private:
+    struct Frame
+    {
+        size_t offset;
+        size_t size;
+        bool keyframe;
+    };
+
+    size_t Encode(const uint8_t *snapshot, const uint8_t *reference, uint8_t *out) const;
+    void Apply(const Frame &frame, uint8_t *snapshot) const;
+    bool Store(size_t size, bool keyframe);
+    bool IsFree(size_t offset, size_t size) const;
+    void DropOldestKeyframe();
+
+    std::vector<uint8_t> buffer;
+    size_t head;
+    std::deque<Frame> frames;
+    uint keyframeInterval;
+    uint deltasSinceKeyframe;
+
+    size_t snapshotSize;
+    std::vector<uint8_t> current;  // Snapshot of the newest frame.
+    std::vector<uint8_t> next;     // Snapshot being captured.
+    std::vector<uint8_t> encoded;  // Encoded frame, before it's stored.
+
+    std::chrono::steady_clock::time_point captureStart;
+    Stats stats;
+};
\ No newline at end of file
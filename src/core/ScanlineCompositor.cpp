@@ -0,0 +1,124 @@
+#include "ScanlineCompositor.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCANLINE_COMPOSITOR_X86
+#include <immintrin.h>
+#endif
+
+
+static void ApplyPaletteScalar(const uint8_t *indices, const uint32_t *colors, uint32_t *pixels, uint count)
+{
+    for (uint i = 0; i < count; i++)
+        pixels[i] = colors[indices[i]];
+}
+
+
+#ifdef SCANLINE_COMPOSITOR_X86
+
+__attribute__((target("sse2")))
+static void ApplyPaletteSse2(const uint8_t *indices, const uint32_t *colors, uint32_t *pixels, uint count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i values[4] = {zero, _mm_set1_epi32(1), _mm_set1_epi32(2), _mm_set1_epi32(3)};
+    const __m128i palette[4] = {_mm_set1_epi32(colors[0]), _mm_set1_epi32(colors[1]), _mm_set1_epi32(colors[2]),
+                                _mm_set1_epi32(colors[3])};
+
+    uint i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        // Widen 16 indices to 32 bits, 4 at a time.
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&indices[i]));
+        const __m128i words[2] = {_mm_unpacklo_epi8(bytes, zero), _mm_unpackhi_epi8(bytes, zero)};
+        const __m128i dwords[4] = {_mm_unpacklo_epi16(words[0], zero), _mm_unpackhi_epi16(words[0], zero),
+                                   _mm_unpacklo_epi16(words[1], zero), _mm_unpackhi_epi16(words[1], zero)};
+
+        // Each pixel matches exactly one of the 4 indices, so the masked colors can be ORed together.
+        for (uint j = 0; j < 4; j++)
+        {
+            __m128i out = zero;
+            for (uint k = 0; k < 4; k++)
+                out = _mm_or_si128(out, _mm_and_si128(_mm_cmpeq_epi32(dwords[j], values[k]), palette[k]));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(&pixels[i + j * 4]), out);
+        }
+    }
+
+    ApplyPaletteScalar(&indices[i], colors, &pixels[i], count - i);
+}
+
+
+__attribute__((target("avx2")))
+static void ApplyPaletteAvx2(const uint8_t *indices, const uint32_t *colors, uint32_t *pixels, uint count)
+{
+    // The permute takes the bottom 3 bits of each index, so indices 0-3 select from the low half.
+    const __m256i palette = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(colors)));
+
+    uint i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&indices[i]));
+        const __m256i low = _mm256_cvtepu8_epi32(bytes);
+        const __m256i high = _mm256_cvtepu8_epi32(_mm_unpackhi_epi64(bytes, bytes));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(&pixels[i]), _mm256_permutevar8x32_epi32(palette, low));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(&pixels[i + 8]), _mm256_permutevar8x32_epi32(palette, high));
+    }
+
+    ApplyPaletteScalar(&indices[i], colors, &pixels[i], count - i);
+}
+
+#endif
+
+
+bool ScanlineCompositor::IsSupported(Version version)
+{
+#ifdef SCANLINE_COMPOSITOR_X86
+    // Checks CPUID, and for AVX2, that the OS saves the wider registers.
+    __builtin_cpu_init();
+#endif
+
+    switch (version)
+    {
+        case eVersionScalar:
+            return true;
+#ifdef SCANLINE_COMPOSITOR_X86
+        case eVersionSse2:
+            return __builtin_cpu_supports("sse2");
+        case eVersionAvx2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+
+ScanlineCompositor::Version ScanlineCompositor::GetBestVersion()
+{
+    static const Version bestVersion = []()
+    {
+        int version = eVersionCount - 1;
+        while (!IsSupported(static_cast<Version>(version)))
+            version--;
+        return static_cast<Version>(version);
+    }();
+
+    return bestVersion;
+}
+
+
+ScanlineCompositor::ApplyPaletteFunc ScanlineCompositor::GetApplyPalette(Version version)
+{
+    if (!IsSupported(version))
+        return NULL;
+
+    switch (version)
+    {
+#ifdef SCANLINE_COMPOSITOR_X86
+        case eVersionSse2:
+            return ApplyPaletteSse2;
+        case eVersionAvx2:
+            return ApplyPaletteAvx2;
+#endif
+        default:
+            return ApplyPaletteScalar;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "gbemu.h"
+
+
+// Turns lines of palette indices into pixels.
+//
+// The background and window are drawn as palette indices first, since sprite priority needs them, and then every
+// pixel is looked up in the 4 colors of the palette. Once tiles come decoded from TileCache, that lookup is most of
+// the work per pixel, so it has SIMD versions. AVX2 looks up 8 pixels with one permute, and SSE2 does 4 at a time
+// with compares and masks. The best version the CPU supports is picked at run time, and other CPUs use the scalar
+// version.
+class ScanlineCompositor
+{
+public:
+    enum Version
+    {
+        eVersionScalar,
+        eVersionSse2,
+        eVersionAvx2,
+        eVersionCount
+    };
+
+    // Writes count pixels, colors[indices[i]] for each one. Indices have to be 0-3.
+    typedef void (*ApplyPaletteFunc)(const uint8_t *indices, const uint32_t *colors, uint32_t *pixels, uint count);
+
+    static bool IsSupported(Version version);
+    static Version GetBestVersion();
+    // Returns NULL if the CPU doesn't support the version.
+    static ApplyPaletteFunc GetApplyPalette(Version version);
+};
\ No newline at end of file
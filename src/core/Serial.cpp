@@ -8,10 +8,13 @@
 
 const uint cyclesPerBit = 8;
 
-Serial::Serial(IoRegisterSubject *ioRegisterSubject, Interrupt *interrupts, TimerSubject *timerSubject) :
+Serial::Serial(IoRegisterSubject *ioRegisterSubject, Interrupt *interrupts, TimerSubject *timerSubject,
+               SerialInterface *serialInterface) :
     regSB(ioRegisterSubject->AttachIoRegister(eRegSB, this)),
     regSC(ioRegisterSubject->AttachIoRegister(eRegSC, this)),
     interrupts(interrupts),
+    serialInterface(serialInterface),
+    linkInterface(NULL),
     counter(0),
     inProgress(false)
 {
@@ -28,26 +31,26 @@ Serial::~Serial()
 }
 
 
-bool Serial::SaveState(FILE *file)
+bool Serial::SaveState(StateWriter &writer)
 {
-    if (!fwrite(&counter, sizeof(counter), 1, file))
+    if (!writer.Write(&counter, sizeof(counter)))
         return false;
 
-    if (!fwrite(&inProgress, sizeof(inProgress), 1, file))
+    if (!writer.Write(&inProgress, sizeof(inProgress)))
         return false;
 
     return true;
 }
 
 
-bool Serial::LoadState(uint16_t version, FILE *file)
+bool Serial::LoadState(uint16_t version, StateReader &reader)
 {
     (void)version;
 
-    if (!fread(&counter, sizeof(counter), 1, file))
+    if (!reader.Read(&counter, sizeof(counter)))
         return false;
 
-    if (!fread(&inProgress, sizeof(inProgress), 1, file))
+    if (!reader.Read(&inProgress, sizeof(inProgress)))
         return false;
 
     return true;
@@ -98,8 +101,33 @@ uint8_t Serial::ReadByte(uint16_t address) const
 }
 
 
+bool Serial::ExternalTransfer(uint8_t byteIn, uint8_t &byteOut)
+{
+    if (!ExternalTransferStarted())
+        return false;
+
+    byteOut = *regSB;
+    if (serialInterface)
+        serialInterface->SerialDataSent(byteOut);
+    LogDebug("Serial: %02X, '%c' (external clock)", byteOut, byteOut);
+
+    *regSB = byteIn;
+
+    // Clear transfer start flag.
+    *regSC &= 0x7F;
+
+    if (interrupts)
+        interrupts->RequestInterrupt(eIntSerial);
+
+    return true;
+}
+
+
 void Serial::UpdateTimer(uint value)
 {
+    if (linkInterface)
+        linkInterface->UpdateLink(this, value);
+
     if (!inProgress)
         return;
 
@@ -108,17 +136,17 @@ void Serial::UpdateTimer(uint value)
     // For now, process the transfer in one chunk, instead of a bit at a time. Change later if needed.
     if (counter >= cyclesPerBit * 8 * 4)
     {
-        // Write byte to debug file.
-        FILE *file = fopen("serial.txt", "a");
-        fputc(*regSB, file);
-        fclose(file);
-        LogDebug("Serial: %02X, '%c'", *regSB, *regSB);
+        const uint8_t byteOut = *regSB;
+        LogDebug("Serial: %02X, '%c'", byteOut, byteOut);
 
         inProgress = false;
 
-        // Bits are shifted in when bits are shifted out. Since we aren't emulating a connected serial
-        // device, 0xFF gets shifted in.
-        *regSB = 0xFF;
+        // Bits are shifted in when bits are shifted out. If nothing is connected, 0xFF gets shifted in.
+        *regSB = linkInterface ? linkInterface->InternalTransfer(byteOut) : 0xFF;
+
+        // Don't report a transfer the link is about to roll back. It gets reported when it runs again.
+        if (serialInterface && (!linkInterface || linkInterface->GetRequest() != LinkInterface::eLinkRequestRollback))
+            serialInterface->SerialDataSent(byteOut);
 
         // Clear transfer start flag.
         *regSC &= 0x7F;
@@ -3,17 +3,33 @@
 #include "gbemu.h"
 #include "IoRegisterProxy.h"
 #include "Interrupt.h"
+#include "LinkInterface.h"
+#include "SerialInterface.h"
+#include "StateBuffer.h"
 #include "TimerObserver.h"
 
 
 class Serial : public IoRegisterProxy, public TimerObserver
 {
 public:
-    Serial(IoRegisterSubject *ioRegisterSubject, Interrupt *interrupts, TimerSubject *timerSubject);
+    // If serialInterface is NULL, sent bytes are discarded.
+    Serial(IoRegisterSubject *ioRegisterSubject, Interrupt *interrupts, TimerSubject *timerSubject,
+           SerialInterface *serialInterface = NULL);
     virtual ~Serial();
 
-    bool SaveState(FILE *file);
-    bool LoadState(uint16_t version, FILE *file);
+    // A NULL endpoint means sent bytes are discarded.
+    void SetSerialInterface(SerialInterface *serialInterface) {this->serialInterface = serialInterface;}
+
+    // A NULL link means nothing is connected to the serial port.
+    void SetLinkInterface(LinkInterface *linkInterface) {this->linkInterface = linkInterface;}
+
+    // Called by the link when the peer clocks a transfer. If a transfer using the external clock has been started,
+    // byteIn is shifted in, the previous contents of SB are returned in byteOut, and true is returned.
+    bool ExternalTransfer(uint8_t byteIn, uint8_t &byteOut);
+    bool ExternalTransferStarted() const {return (*regSC & 0x81) == 0x80;}
+
+    bool SaveState(StateWriter &writer);
+    bool LoadState(uint16_t version, StateReader &reader);
 
     // Inherited from IoRegisterProxy.
     virtual bool WriteByte(uint16_t address, uint8_t byte);
@@ -26,6 +42,8 @@ private:
     uint8_t *regSB;
     uint8_t *regSC;
     Interrupt *interrupts;
+    SerialInterface *serialInterface;
+    LinkInterface *linkInterface;
 
     uint counter;
     bool inProgress;
@@ -0,0 +1,40 @@
+#include "SerialBuffer.h"
+
+
+SerialBuffer::SerialBuffer() :
+    output(),
+    patterns()
+{
+
+}
+
+
+SerialBuffer::~SerialBuffer()
+{
+
+}
+
+
+void SerialBuffer::AddPattern(const std::string &pattern, PatternCallback callback)
+{
+    if (!pattern.empty())
+        patterns.push_back(Pattern{pattern, callback});
+}
+
+
+void SerialBuffer::SerialDataSent(uint8_t byte)
+{
+    output.push_back(byte);
+
+    // Patterns are checked after every byte, so only the end of the output needs to be compared. A pattern can only
+    // match if it ends with this byte, which rejects most patterns without a full compare.
+    for (const Pattern &pattern : patterns)
+    {
+        const std::string &str = pattern.pattern;
+        if (str.back() == static_cast<char>(byte) && str.size() <= output.size() &&
+            output.compare(output.size() - str.size(), str.size(), str) == 0)
+        {
+            pattern.callback(str);
+        }
+    }
+}
\ No newline at end of file
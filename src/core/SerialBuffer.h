@@ -0,0 +1,42 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "gbemu.h"
+#include "SerialInterface.h"
+
+
+// Collects serial output in memory, and calls a callback as soon as the output ends with a registered pattern. Test
+// harnesses use this to detect "Passed" or "Failed" the moment it is printed.
+class SerialBuffer : public SerialInterface
+{
+public:
+    typedef std::function<void(const std::string &pattern)> PatternCallback;
+
+    SerialBuffer();
+    virtual ~SerialBuffer();
+
+    void AddPattern(const std::string &pattern, PatternCallback callback);
+
+    const std::string &GetOutput() const {return output;}
+    void Clear() {output.clear();}
+
+    // Inherited from SerialInterface.
+    virtual void SerialDataSent(uint8_t byte);
+
+    // Don't allow copy and assignment.
+    SerialBuffer(const SerialBuffer&) = delete;
+    void operator=(const SerialBuffer&) = delete;
+
+private:
+    struct Pattern
+    {
+        std::string pattern;
+        PatternCallback callback;
+    };
+
+    std::string output;
+    std::vector<Pattern> patterns;
+};
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include <errno.h>
+#include <string.h>
+
+#include "Logger.h"
+#include "SerialFileWriter.h"
+
+
+SerialFileWriter::SerialFileWriter(const std::string &filename) :
+    filename(filename),
+    file(NULL),
+    openFailed(false)
+{
+
+}
+
+
+SerialFileWriter::~SerialFileWriter()
+{
+    if (file != NULL)
+        fclose(file);
+}
+
+
+void SerialFileWriter::Flush()
+{
+    if (file != NULL)
+        fflush(file);
+}
+
+
+void SerialFileWriter::SerialDataSent(uint8_t byte)
+{
+    if (file == NULL)
+    {
+        // Don't retry every byte if the file can't be opened.
+        if (openFailed)
+            return;
+
+        file = fopen(filename.c_str(), "a");
+        if (file == NULL)
+        {
+            LogError("Error opening serial file %s: %s", filename.c_str(), strerror(errno));
+            openFailed = true;
+            return;
+        }
+
+        // Line buffering keeps the file readable while a test ROM is running, with one write per line.
+        setvbuf(file, NULL, _IOLBF, BUFSIZ);
+    }
+
+    fputc(byte, file);
+}
\ No newline at end of file
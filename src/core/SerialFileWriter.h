@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdio.h>
+#include <string>
+
+#include "gbemu.h"
+#include "SerialInterface.h"
+
+
+// Appends serial output to a file. The file is opened on the first byte, and written a line at a time, instead of
+// opening and closing it for every byte.
+class SerialFileWriter : public SerialInterface
+{
+public:
+    explicit SerialFileWriter(const std::string &filename);
+    virtual ~SerialFileWriter();
+
+    void Flush();
+
+    // Inherited from SerialInterface.
+    virtual void SerialDataSent(uint8_t byte);
+
+    // Don't allow copy and assignment.
+    SerialFileWriter(const SerialFileWriter&) = delete;
+    void operator=(const SerialFileWriter&) = delete;
+
+private:
+    std::string filename;
+    FILE *file;
+    bool openFailed;
+};
\ No newline at end of file
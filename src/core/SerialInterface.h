@@ -0,0 +1,15 @@
+#pragma once
+
+#include "gbemu.h"
+
+class SerialInterface
+{
+public:
+    SerialInterface() {}
+
+    // Called when a byte has been shifted out of the serial port.
+    virtual void SerialDataSent(uint8_t byte) = 0;
+
+protected:
+    ~SerialInterface() {}
+};
\ No newline at end of file
@@ -0,0 +1,513 @@
+#include <algorithm>
+#include <chrono>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+#include "Logger.h"
+#include "SocketLink.h"
+
+
+// Fills in a socket address for a TCP port on localhost, or a Unix domain socket path. Returns false if the address
+// isn't valid.
+static bool ParseAddress(const std::string &address, sockaddr_storage &addr, socklen_t &addrLen)
+{
+    memset(&addr, 0, sizeof(addr));
+
+    if (!address.empty() && address.find_first_not_of("0123456789") == std::string::npos)
+    {
+        unsigned long port = strtoul(address.c_str(), NULL, 10);
+        if (port == 0 || port > 65535)
+            return false;
+
+        sockaddr_in *in = reinterpret_cast<sockaddr_in *>(&addr);
+        in->sin_family = AF_INET;
+        in->sin_port = htons(port);
+        in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addrLen = sizeof(sockaddr_in);
+        return true;
+    }
+
+    sockaddr_un *un = reinterpret_cast<sockaddr_un *>(&addr);
+    if (address.empty() || address.size() >= sizeof(un->sun_path))
+        return false;
+
+    un->sun_family = AF_UNIX;
+    memcpy(un->sun_path, address.c_str(), address.size());
+    addrLen = sizeof(sockaddr_un);
+    return true;
+}
+
+
+SocketLink::SocketLink(uint quantum, bool rollback) :
+    fd(-1),
+    quantum(quantum ? quantum : DEFAULT_QUANTUM),
+    rollbackEnabled(rollback),
+    peerConnected(false),
+    clock(0),
+    nextSync(this->quantum),
+    peerClock(0),
+    peerQuantum(0),
+    awaitingReply(false),
+    transferId(0),
+    reply(0xFF),
+    prediction(0xFF),
+    rollbackByte(0xFF),
+    checkpointClock(0),
+    checkpointNextSync(0),
+    peerTransferPending(false),
+    peerTransferId(0),
+    peerTransferByte(0),
+    peerTransferClock(0),
+    replyDeadline(0),
+    receiveBuffer(),
+    receiveSize(0),
+    stats()
+{
+
+}
+
+
+SocketLink::~SocketLink()
+{
+    Disconnect();
+}
+
+
+bool SocketLink::Listen(const std::string &address)
+{
+    Close();
+
+    sockaddr_storage addr;
+    socklen_t addrLen;
+    if (!ParseAddress(address, addr, addrLen))
+    {
+        LogError("Invalid link address %s", address.c_str());
+        return false;
+    }
+
+    int listenFd = socket(addr.ss_family, SOCK_STREAM, 0);
+    if (listenFd < 0)
+    {
+        LogError("Error creating link socket: %s", strerror(errno));
+        return false;
+    }
+
+    if (addr.ss_family == AF_UNIX)
+    {
+        // Remove a socket left behind by an earlier run.
+        unlink(address.c_str());
+    }
+    else
+    {
+        int reuse = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    }
+
+    if (bind(listenFd, reinterpret_cast<sockaddr *>(&addr), addrLen) || listen(listenFd, 1))
+    {
+        LogError("Error listening for link on %s: %s", address.c_str(), strerror(errno));
+        ::close(listenFd);
+        return false;
+    }
+
+    LogInfo("Waiting for link peer on %s", address.c_str());
+
+    fd = accept(listenFd, NULL, NULL);
+    if (fd < 0)
+        LogError("Error accepting link connection on %s: %s", address.c_str(), strerror(errno));
+
+    ::close(listenFd);
+    if (addr.ss_family == AF_UNIX)
+        unlink(address.c_str());
+
+    return fd >= 0 && Handshake();
+}
+
+
+bool SocketLink::Connect(const std::string &address, uint timeoutMs)
+{
+    Close();
+
+    sockaddr_storage addr;
+    socklen_t addrLen;
+    if (!ParseAddress(address, addr, addrLen))
+    {
+        LogError("Invalid link address %s", address.c_str());
+        return false;
+    }
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    for (;;)
+    {
+        fd = socket(addr.ss_family, SOCK_STREAM, 0);
+        if (fd < 0)
+        {
+            LogError("Error creating link socket: %s", strerror(errno));
+            return false;
+        }
+
+        if (connect(fd, reinterpret_cast<sockaddr *>(&addr), addrLen) == 0)
+            break;
+
+        // Retry while the peer isn't listening yet.
+        int error = errno;
+        Close();
+        if ((error != ECONNREFUSED && error != ENOENT) || std::chrono::steady_clock::now() >= end)
+        {
+            LogError("Error connecting link to %s: %s", address.c_str(), strerror(error));
+            return false;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    return Handshake();
+}
+
+
+void SocketLink::Disconnect()
+{
+    if (peerConnected)
+        Send(eMessageBye);
+
+    Close();
+}
+
+
+bool SocketLink::Handshake()
+{
+    // Transfers are single small messages, so don't let Nagle's algorithm hold them back.
+    int noDelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    peerConnected = true;
+    peerQuantum = 0;
+
+    Message hello;
+    memset(&hello, 0, sizeof(hello));
+    hello.type = eMessageHello;
+    hello.byte = PROTOCOL_VERSION;
+    hello.clock = quantum;
+    if (send(fd, &hello, sizeof(hello), MSG_NOSIGNAL) != sizeof(hello))
+        PeerDisconnected();
+
+    while (peerConnected && peerQuantum == 0)
+        Receive(true);
+
+    if (!peerConnected)
+    {
+        LogError("Link handshake failed");
+        Close();
+        return false;
+    }
+
+    quantum = std::max(quantum, peerQuantum);
+    nextSync = clock + quantum;
+
+    LogInfo("Link connected, quantum %u%s", quantum, rollbackEnabled ? ", rollback enabled" : "");
+
+    return true;
+}
+
+
+void SocketLink::Close()
+{
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+
+    peerConnected = false;
+    awaitingReply = false;
+    peerTransferPending = false;
+    receiveSize = 0;
+}
+
+
+uint8_t SocketLink::InternalTransfer(uint8_t byte)
+{
+    stats.transfers++;
+
+    // Only one prediction is outstanding at a time.
+    if (awaitingReply)
+        WaitForReply();
+
+    // If the last prediction was wrong, this transfer is about to be undone.
+    if (request == eLinkRequestRollback || !peerConnected)
+        return 0xFF;
+
+    // If both sides use their internal clock, neither one is listening, so both shift in 0xFF. The peer sees the same
+    // thing when this side's reply arrives while it's waiting.
+    if (peerTransferPending)
+    {
+        LogDebug("Link: both sides started a transfer with the internal clock");
+        peerTransferPending = false;
+        Send(eMessageReply, 0xFF, peerTransferId);
+        return 0xFF;
+    }
+
+    transferId++;
+    awaitingReply = true;
+    Send(eMessageTransfer, byte, transferId);
+
+    if (!rollbackEnabled)
+    {
+        WaitForReply();
+        return reply;
+    }
+
+    stats.predictions++;
+    prediction = reply;
+    request = eLinkRequestCheckpoint;
+    return prediction;
+}
+
+
+void SocketLink::CheckpointSaved()
+{
+    checkpointClock = clock;
+    checkpointNextSync = nextSync;
+    request = eLinkRequestNone;
+}
+
+
+uint8_t SocketLink::RolledBack()
+{
+    clock = checkpointClock;
+    nextSync = checkpointNextSync;
+    request = eLinkRequestNone;
+    return rollbackByte;
+}
+
+
+void SocketLink::Sync(Serial *serial)
+{
+    // Nothing else happens until EmulatorMgr has saved or restored the checkpoint.
+    if (request != eLinkRequestNone)
+        return;
+
+    if (clock >= nextSync)
+    {
+        nextSync = clock + quantum;
+        stats.syncs++;
+
+        Send(eMessageSync);
+        Receive(false);
+
+        // Don't run more than a quantum ahead of the peer.
+        if (peerConnected && peerClock + quantum < clock)
+        {
+            auto start = std::chrono::steady_clock::now();
+            stats.waits++;
+
+            while (request == eLinkRequestNone && peerConnected && peerClock + quantum < clock)
+            {
+                // The peer may have started a transfer while catching up. This side is already past the time of the
+                // transfer, so reply now. If this side can't reply yet, stop waiting, since the peer is waiting on it.
+                ReplyToPeer(serial);
+                if (peerTransferPending)
+                    break;
+
+                Receive(true);
+            }
+
+            stats.waitNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+    ReplyToPeer(serial);
+}
+
+
+void SocketLink::ReplyToPeer(Serial *serial)
+{
+    // While a prediction is outstanding, this side's state may still be rolled back, so it can't reply.
+    if (!peerTransferPending || clock < peerTransferClock || awaitingReply || request != eLinkRequestNone)
+        return;
+
+    // If this side hasn't started a transfer using the external clock, give it until the deadline to start one, to
+    // make up for the sides running up to a quantum apart. After that, nothing is shifted out.
+    uint8_t byte;
+    if (!serial->ExternalTransfer(peerTransferByte, byte))
+    {
+        if (clock < replyDeadline)
+            return;
+        byte = 0xFF;
+    }
+
+    peerTransferPending = false;
+    Send(eMessageReply, byte, peerTransferId);
+}
+
+
+void SocketLink::WaitForReply()
+{
+    auto start = std::chrono::steady_clock::now();
+    stats.waits++;
+
+    while (awaitingReply && peerConnected)
+        Receive(true);
+
+    stats.waitNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+
+void SocketLink::ResolveTransfer(uint8_t byte)
+{
+    awaitingReply = false;
+    reply = byte;
+
+    // The transfer already ran with the predicted byte. If that was wrong, have EmulatorMgr go back to the checkpoint
+    // from right after the transfer, and put the real byte in SB.
+    if (rollbackEnabled && byte != prediction)
+    {
+        LogDebug("Link: predicted %02X, peer replied %02X, rolling back %llu clocks", prediction, byte,
+                 (unsigned long long)(clock - checkpointClock));
+        stats.rollbacks++;
+        rollbackByte = byte;
+        request = eLinkRequestRollback;
+    }
+}
+
+
+void SocketLink::PeerDisconnected()
+{
+    if (!peerConnected)
+        return;
+
+    LogInfo("Link peer disconnected");
+    peerConnected = false;
+    peerTransferPending = false;
+
+    if (awaitingReply)
+        ResolveTransfer(0xFF);
+}
+
+
+void SocketLink::Send(MessageType type, uint8_t byte, uint16_t id)
+{
+    if (!peerConnected)
+        return;
+
+    Message message;
+    memset(&message, 0, sizeof(message));
+    message.type = type;
+    message.byte = byte;
+    message.id = id;
+    message.clock = clock;
+
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(&message);
+    size_t sent = 0;
+    while (sent < sizeof(message))
+    {
+        ssize_t count = send(fd, data + sent, sizeof(message) - sent, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR)
+            continue;
+        if (count <= 0)
+        {
+            PeerDisconnected();
+            return;
+        }
+        sent += count;
+    }
+}
+
+
+void SocketLink::Receive(bool block)
+{
+    // When blocking, wait for one whole message, then take whatever else has already arrived.
+    while (fd >= 0)
+    {
+        ssize_t count = recv(fd, receiveBuffer + receiveSize, sizeof(receiveBuffer) - receiveSize,
+                             block ? 0 : MSG_DONTWAIT);
+        if (count > 0)
+        {
+            receiveSize += count;
+            if (receiveSize == sizeof(Message))
+            {
+                Message message;
+                memcpy(&message, receiveBuffer, sizeof(message));
+                receiveSize = 0;
+                block = false;
+                HandleMessage(message);
+            }
+        }
+        else if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return;
+        }
+        else
+        {
+            PeerDisconnected();
+            return;
+        }
+    }
+}
+
+
+void SocketLink::HandleMessage(const Message &message)
+{
+    peerClock = message.clock;
+
+    switch (message.type)
+    {
+        case eMessageHello:
+            if (message.byte != PROTOCOL_VERSION)
+            {
+                LogError("Link peer uses protocol version %u, expected %u", message.byte, PROTOCOL_VERSION);
+                PeerDisconnected();
+                return;
+            }
+            peerQuantum = message.clock ? message.clock : DEFAULT_QUANTUM;
+            peerClock = 0;
+            break;
+
+        case eMessageSync:
+            break;
+
+        case eMessageTransfer:
+            // If this side is waiting for a reply too, both sides used their internal clock. See InternalTransfer().
+            if (awaitingReply)
+            {
+                LogDebug("Link: both sides started a transfer with the internal clock");
+                Send(eMessageReply, 0xFF, message.id);
+                ResolveTransfer(0xFF);
+                break;
+            }
+            peerTransferPending = true;
+            peerTransferId = message.id;
+            peerTransferByte = message.byte;
+            peerTransferClock = message.clock;
+            replyDeadline = std::max(clock, peerTransferClock) + quantum;
+            break;
+
+        case eMessageReply:
+            // Replies to transfers that were already settled as a collision are ignored.
+            if (awaitingReply && message.id == transferId)
+                ResolveTransfer(message.byte);
+            break;
+
+        case eMessageBye:
+            PeerDisconnected();
+            break;
+
+        default:
+            LogError("Invalid link message type %u", message.type);
+            PeerDisconnected();
+            break;
+    }
+}
\ No newline at end of file
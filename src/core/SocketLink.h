@@ -0,0 +1,140 @@
+#pragma once
+
+#include <string>
+
+#include "gbemu.h"
+#include "LinkInterface.h"
+#include "Serial.h"
+
+
+// Connects the serial port to an emulator running in another process on the same host, over a Unix domain socket or
+// a TCP connection to localhost.
+//
+// As with LinkCable, the two sides only exchange their clocks at quantum boundaries, and neither side may run more
+// than a quantum ahead of the other. A transfer clocked by this side is sent to the peer, which replies once it has
+// caught up to the time of the transfer and started its own external clock transfer (or after a quantum of its clocks,
+// in which case 0xFF is shifted in).
+//
+// Without rollback, the side clocking a transfer blocks until the reply arrives, so every transfer costs a round trip.
+// With rollback, the side clocking a transfer doesn't wait. It predicts that the peer will reply with the same byte it
+// replied with last time, asks EmulatorMgr for a checkpoint, and keeps running. If the real reply differs, EmulatorMgr
+// restores the checkpoint and the real byte is put in SB. While a prediction is outstanding, this side doesn't reply to
+// the peer's transfers, and a second transfer waits for the first reply, so nothing the peer sees is ever undone.
+class SocketLink : public LinkInterface
+{
+public:
+    static const uint DEFAULT_QUANTUM = 16384;
+
+    struct Stats
+    {
+        uint64_t syncs;           // Quantum boundaries reached.
+        uint64_t transfers;       // Transfers clocked by this side.
+        uint64_t waits;           // Times this side had to block on its peer.
+        uint64_t waitNanoseconds; // Time spent blocked on the peer.
+        uint64_t predictions;     // Transfers that ran ahead with a predicted reply.
+        uint64_t rollbacks;       // Predictions that were wrong.
+    };
+
+    // The sides use the larger of their two quanta.
+    explicit SocketLink(uint quantum = DEFAULT_QUANTUM, bool rollback = false);
+    ~SocketLink();
+
+    // An address that is all digits is a TCP port on localhost. Anything else is the path of a Unix domain socket.
+    // Listen() waits for the peer to connect. Connect() keeps retrying for timeoutMs, so both sides can be started at
+    // the same time.
+    bool Listen(const std::string &address);
+    bool Connect(const std::string &address, uint timeoutMs = 5000);
+
+    // Tells the peer this side has stopped, so it doesn't wait for it, and closes the connection. Transfers clocked
+    // after this shift in 0xFF, as if the cable was unplugged.
+    void Disconnect();
+
+    bool IsConnected() const {return peerConnected;}
+    Stats GetStats() const {return stats;}
+    uint GetQuantum() const {return quantum;}
+
+    // Inherited from LinkInterface.
+    virtual void UpdateLink(Serial *serial, uint clocks)
+    {
+        clock += clocks;
+
+        // Only touch the socket at quantum boundaries, or when the peer is waiting for a reply this side can give.
+        if (clock >= nextSync || (peerTransferPending && clock >= peerTransferClock &&
+                                  (serial->ExternalTransferStarted() || clock >= replyDeadline)))
+            Sync(serial);
+    }
+
+    virtual uint8_t InternalTransfer(uint8_t byte);
+    virtual void CheckpointSaved();
+    virtual uint8_t RolledBack();
+
+    // Don't allow copy and assignment.
+    SocketLink(const SocketLink&) = delete;
+    void operator=(const SocketLink&) = delete;
+
+private:
+    static const uint8_t PROTOCOL_VERSION = 1;
+
+    enum MessageType
+    {
+        eMessageHello,     // byte is the protocol version, clock is the sender's quantum.
+        eMessageSync,
+        eMessageTransfer,  // byte is the sender's SB.
+        eMessageReply,     // byte is the replier's SB, id is the id of the transfer being replied to.
+        eMessageBye
+    };
+
+    // Both sides are on the same host, so messages are sent in host byte order.
+    struct Message
+    {
+        uint8_t type;
+        uint8_t byte;
+        uint16_t id;
+        uint32_t reserved;
+        uint64_t clock;
+    };
+
+    bool Handshake();
+    void Close();
+
+    void Sync(Serial *serial);
+    void ReplyToPeer(Serial *serial);
+    void WaitForReply();
+    void ResolveTransfer(uint8_t byte);
+    void PeerDisconnected();
+
+    void Send(MessageType type, uint8_t byte = 0, uint16_t id = 0);
+    void Receive(bool block);
+    void HandleMessage(const Message &message);
+
+    int fd;
+    uint quantum;
+    bool rollbackEnabled;
+    bool peerConnected;
+
+    uint64_t clock;
+    uint64_t nextSync;
+    uint64_t peerClock;
+    uint peerQuantum;
+
+    // A transfer clocked by this side, waiting for the peer to reply.
+    bool awaitingReply;
+    uint16_t transferId;
+    uint8_t reply;
+    uint8_t prediction;
+    uint8_t rollbackByte;
+    uint64_t checkpointClock;
+    uint64_t checkpointNextSync;
+
+    // A transfer clocked by the peer, waiting for this side to reply.
+    bool peerTransferPending;
+    uint16_t peerTransferId;
+    uint8_t peerTransferByte;
+    uint64_t peerTransferClock;
+    uint64_t replyDeadline;
+
+    uint8_t receiveBuffer[sizeof(Message)];
+    size_t receiveSize;
+
+    Stats stats;
+};
\ No newline at end of file
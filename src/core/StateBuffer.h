@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string.h>
+
+#include "gbemu.h"
+
+// Save states are split into chunks, each a 4 character tag, a 32 bit length, and that many bytes of data.
+const size_t STATE_CHUNK_TAG_SIZE = 4;
+const size_t STATE_CHUNK_HEADER_SIZE = STATE_CHUNK_TAG_SIZE + sizeof(uint32_t);
+
+
+// Writes machine state into a caller provided buffer. Nothing is allocated, and writing past the end of the buffer
+// fails instead of growing it. A writer with a NULL buffer only counts bytes, which is how the size of a snapshot is
+// found.
+class StateWriter
+{
+public:
+    StateWriter(uint8_t *data, size_t capacity) : data(data), capacity(capacity), size(0) {}
+
+    bool Write(const void *value, size_t length)
+    {
+        if (data != NULL)
+        {
+            if (length > capacity - size)
+                return false;
+            memcpy(&data[size], value, length);
+        }
+
+        size += length;
+        return true;
+    }
+
+    // Starts a chunk. The length is filled in by EndChunk(), which gets the chunkStart set here.
+    bool BeginChunk(const char *tag, size_t &chunkStart)
+    {
+        const uint32_t length = 0;
+        chunkStart = size;
+        return Write(tag, STATE_CHUNK_TAG_SIZE) && Write(&length, sizeof(length));
+    }
+
+    void EndChunk(size_t chunkStart)
+    {
+        const uint32_t length = size - chunkStart - STATE_CHUNK_HEADER_SIZE;
+        if (data != NULL && chunkStart + STATE_CHUNK_HEADER_SIZE <= size)
+            memcpy(&data[chunkStart + STATE_CHUNK_TAG_SIZE], &length, sizeof(length));
+    }
+
+    size_t GetSize() const {return size;}
+
+private:
+    uint8_t *data;
+    size_t capacity;
+    size_t size;
+};
+
+
+// Reads machine state written by StateWriter. Reading past the end of the buffer fails.
+class StateReader
+{
+public:
+    StateReader(const uint8_t *data = NULL, size_t size = 0) : data(data), size(size), offset(0) {}
+
+    bool Read(void *value, size_t length)
+    {
+        if (length > size - offset)
+            return false;
+
+        memcpy(value, &data[offset], length);
+        offset += length;
+        return true;
+    }
+
+    // Reads the next chunk. tag gets its tag, and chunk a reader for its data. Fails if the chunk is cut off.
+    bool ReadChunk(char *tag, StateReader &chunk)
+    {
+        uint32_t length;
+        if (!Read(tag, STATE_CHUNK_TAG_SIZE) || !Read(&length, sizeof(length)) || length > size - offset)
+            return false;
+
+        chunk = StateReader(&data[offset], length);
+        offset += length;
+        return true;
+    }
+
+    size_t GetOffset() const {return offset;}
+    size_t GetRemaining() const {return size - offset;}
+    // The bytes that haven't been read yet, GetRemaining() of them.
+    const uint8_t *GetData() const {return data + offset;}
+
+private:
+    const uint8_t *data;
+    size_t size;
+    size_t offset;
+};
\ No newline at end of file
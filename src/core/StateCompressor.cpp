@@ -0,0 +1,206 @@
+#include <string.h>
+
+#include "StateCompressor.h"
+#include "Varint.h"
+
+const char COMPRESSED_MAGIC[4] = {'Z', 'L', 'G', 'Z'};
+const size_t COMPRESSED_HEADER_SIZE = sizeof(COMPRESSED_MAGIC) + sizeof(uint32_t);
+
+enum TokenType
+{
+    eTokenLiteral,
+    eTokenZeros,
+    eTokenMatch
+};
+
+// Shorter matches and runs of zeros cost about as much as the literal bytes they replace.
+const size_t MIN_MATCH_LENGTH = 4;
+const size_t MIN_ZERO_LENGTH = 4;
+
+// Positions are found by hashing the next 4 bytes into a table of this many entries.
+const int HASH_BITS = 14;
+
+// Worst case size of a token header, a varint for the length and one for the offset.
+const size_t MAX_TOKEN_HEADER_SIZE = 20;
+
+
+static inline uint32_t Load32(const uint8_t *ptr)
+{
+    uint32_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+
+static inline uint64_t Load64(const uint8_t *ptr)
+{
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+
+static inline uint32_t Hash(uint32_t value)
+{
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+
+static inline uint8_t *WriteToken(uint8_t *ptr, TokenType type, size_t length)
+{
+    return WriteVarint(ptr, length << 2 | type);
+}
+
+
+static uint8_t *WriteLiterals(uint8_t *ptr, const uint8_t *data, size_t length)
+{
+    if (length == 0)
+        return ptr;
+
+    ptr = WriteToken(ptr, eTokenLiteral, length);
+    memcpy(ptr, data, length);
+    return ptr + length;
+}
+
+
+void StateCompressor::Compress(const uint8_t *data, size_t size, std::vector<uint8_t> &compressed)
+{
+    // A match or run of zeros covers at least 4 bytes, and with the shortest literal before it takes no more than 8, so
+    // this is enough even when nothing compresses.
+    compressed.resize(COMPRESSED_HEADER_SIZE + size * 2 + MAX_TOKEN_HEADER_SIZE);
+    uint8_t *ptr = compressed.data();
+
+    const uint32_t uncompressedSize = size;
+    memcpy(ptr, COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC));
+    memcpy(ptr + sizeof(COMPRESSED_MAGIC), &uncompressedSize, sizeof(uncompressedSize));
+    ptr += COMPRESSED_HEADER_SIZE;
+
+    // Positions are stored plus one, so 0 means empty.
+    std::vector<uint32_t> table(1 << HASH_BITS);
+
+    size_t literalStart = 0;
+    size_t i = 0;
+    while (i + MIN_MATCH_LENGTH <= size)
+    {
+        if (data[i] == 0)
+        {
+            // Runs of zeros are checked for first, a word at a time, since they're most of a snapshot.
+            size_t end = i;
+            while (end + sizeof(uint64_t) <= size && Load64(&data[end]) == 0)
+                end += sizeof(uint64_t);
+            while (end < size && data[end] == 0)
+                end++;
+
+            if (end - i >= MIN_ZERO_LENGTH)
+            {
+                ptr = WriteLiterals(ptr, &data[literalStart], i - literalStart);
+                ptr = WriteToken(ptr, eTokenZeros, end - i);
+                i = end;
+                literalStart = i;
+                continue;
+            }
+        }
+
+        const uint32_t value = Load32(&data[i]);
+        uint32_t &entry = table[Hash(value)];
+        const size_t candidate = entry - 1;
+        const bool found = entry != 0 && Load32(&data[candidate]) == value;
+        entry = i + 1;
+
+        if (!found)
+        {
+            i++;
+            continue;
+        }
+
+        size_t length = MIN_MATCH_LENGTH;
+        while (i + length < size && data[candidate + length] == data[i + length])
+            length++;
+
+        ptr = WriteLiterals(ptr, &data[literalStart], i - literalStart);
+        ptr = WriteToken(ptr, eTokenMatch, length);
+        ptr = WriteVarint(ptr, i - candidate);
+        i += length;
+        literalStart = i;
+    }
+
+    ptr = WriteLiterals(ptr, &data[literalStart], size - literalStart);
+
+    compressed.resize(ptr - compressed.data());
+}
+
+
+bool StateCompressor::Decompress(const uint8_t *data, size_t size, std::vector<uint8_t> &decompressed)
+{
+    if (!IsCompressed(data, size))
+        return false;
+
+    uint32_t uncompressedSize;
+    memcpy(&uncompressedSize, &data[sizeof(COMPRESSED_MAGIC)], sizeof(uncompressedSize));
+    if (uncompressedSize > MAX_UNCOMPRESSED_SIZE)
+        return false;
+
+    decompressed.resize(uncompressedSize);
+
+    const uint8_t *ptr = &data[COMPRESSED_HEADER_SIZE];
+    const uint8_t * const end = &data[size];
+    uint8_t * const outStart = decompressed.data();
+    uint8_t *out = outStart;
+    uint8_t * const outEnd = outStart + uncompressedSize;
+
+    while (ptr < end)
+    {
+        size_t token;
+        ptr = ReadVarint(ptr, end, token);
+        if (ptr == NULL)
+            return false;
+
+        const size_t length = token >> 2;
+        if (length > (size_t)(outEnd - out))
+            return false;
+
+        switch (token & 3)
+        {
+            case eTokenLiteral:
+                if (length > (size_t)(end - ptr))
+                    return false;
+                memcpy(out, ptr, length);
+                ptr += length;
+                break;
+
+            case eTokenZeros:
+                memset(out, 0, length);
+                break;
+
+            case eTokenMatch:
+            {
+                size_t offset;
+                ptr = ReadVarint(ptr, end, offset);
+                if (ptr == NULL || offset == 0 || offset > (size_t)(out - outStart))
+                    return false;
+
+                // A match can overlap the bytes it's copying, which repeats them.
+                const uint8_t *match = out - offset;
+                if (offset >= length)
+                    memcpy(out, match, length);
+                else
+                    for (size_t i = 0; i < length; i++)
+                        out[i] = match[i];
+                break;
+            }
+
+            default:
+                return false;
+        }
+
+        out += length;
+    }
+
+    return out == outEnd;
+}
+
+
+bool StateCompressor::IsCompressed(const uint8_t *data, size_t size)
+{
+    return size >= COMPRESSED_HEADER_SIZE && memcmp(data, COMPRESSED_MAGIC, sizeof(COMPRESSED_MAGIC)) == 0;
+}
\ No newline at end of file
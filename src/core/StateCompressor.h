@@ -0,0 +1,31 @@
+#pragma once
+
+#include <vector>
+
+#include "gbemu.h"
+
+
+// Compresses save state files. Snapshots are mostly zeros, and tiles and maps that repeat, so this is a simple LZ
+// compressor tuned for speed rather than ratio, with runs of zeros handled separately since they're the most common
+// case. There's no entropy coding, so decompressing is little more than memcpy() and memset().
+//
+// Compressed data starts with a magic number and the uncompressed size. After that is a list of tokens, each a varint
+// holding a length and a token type in the low 2 bits:
+//   eTokenLiteral  length bytes follow, and are copied as they are.
+//   eTokenZeros    length zero bytes.
+//   eTokenMatch    a varint offset follows. length bytes are copied from offset bytes back in the output.
+class StateCompressor
+{
+public:
+    // Snapshots are well under a megabyte. A larger uncompressed size in the header is taken as corrupt, so a bad file
+    // can't make Decompress() allocate up to 4 GiB before it finds out.
+    static const size_t MAX_UNCOMPRESSED_SIZE = 16 * 1024 * 1024;
+
+    static void Compress(const uint8_t *data, size_t size, std::vector<uint8_t> &compressed);
+
+    // Returns false if the data is cut off or corrupt, or would decompress to more than MAX_UNCOMPRESSED_SIZE bytes.
+    static bool Decompress(const uint8_t *data, size_t size, std::vector<uint8_t> &decompressed);
+
+    // Checks for the magic number at the start of compressed data.
+    static bool IsCompressed(const uint8_t *data, size_t size);
+};
\ No newline at end of file
@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "Logger.h"
+#include "StateHash.h"
+
+const uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+const uint64_t PRIME3 = 0x165667B19E3779F9ull;
+
+// Data is hashed in stripes of this many 64 bit lanes.
+const int HASH_LANES = 4;
+
+
+static inline uint64_t Load64(const uint8_t *ptr)
+{
+    uint64_t value;
+    memcpy(&value, ptr, sizeof(value));
+    return value;
+}
+
+
+static inline uint64_t Rotate(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+
+static inline uint64_t Mix(uint64_t lane, uint64_t value)
+{
+    return Rotate(lane + value * PRIME2, 31) * PRIME1;
+}
+
+
+uint64_t HashStateData(const uint8_t *data, size_t size)
+{
+    // The lanes don't depend on each other, so the multiplies for a whole stripe are in flight at once, and the
+    // compiler is free to keep the lanes in vector registers.
+    uint64_t lanes[HASH_LANES] = {PRIME1 + PRIME2, PRIME2, 0, 0 - PRIME1};
+
+    const uint8_t *ptr = data;
+    const uint8_t * const stripesEnd = data + size - size % (HASH_LANES * sizeof(uint64_t));
+    for (; ptr < stripesEnd; ptr += HASH_LANES * sizeof(uint64_t))
+    {
+        for (int i = 0; i < HASH_LANES; i++)
+            lanes[i] = Mix(lanes[i], Load64(&ptr[i * sizeof(uint64_t)]));
+    }
+
+    uint64_t hash = size * PRIME3;
+    for (int i = 0; i < HASH_LANES; i++)
+        hash = Rotate(hash ^ Mix(0, lanes[i]), 27) * PRIME1 + PRIME3;
+
+    // Less than a stripe is left, so the rest is mixed in a word and then a byte at a time.
+    for (; ptr + sizeof(uint64_t) <= data + size; ptr += sizeof(uint64_t))
+        hash = Rotate(hash ^ Mix(0, Load64(ptr)), 27) * PRIME1 + PRIME3;
+    for (; ptr < data + size; ptr++)
+        hash = Rotate(hash ^ (*ptr * PRIME3), 11) * PRIME1;
+
+    // Make every input bit affect every output bit.
+    hash ^= hash >> 33;
+    hash *= PRIME2;
+    hash ^= hash >> 29;
+    hash *= PRIME3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+
+StateHashRecorder::StateHashRecorder() :
+    file(NULL),
+    filename(),
+    tags(),
+    record(),
+    recordCount(0),
+    error(false)
+{
+
+}
+
+
+StateHashRecorder::~StateHashRecorder()
+{
+    Close();
+}
+
+
+bool StateHashRecorder::Open(const std::string &filename, const std::vector<std::string> &tags)
+{
+    Close();
+
+    file = fopen(filename.c_str(), "wb");
+    if (file == NULL)
+    {
+        LogError("Error opening state hash file %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    this->filename = filename;
+    this->tags = tags;
+    record.assign(tags.size() + 1, 0);
+    recordCount = 0;
+    error = false;
+
+    StateHashHeader header;
+    memcpy(header.magic, STATE_HASH_MAGIC, sizeof(header.magic));
+    header.version = STATE_HASH_VERSION;
+    header.chunkCount = tags.size();
+    header.reserved = 0;
+
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const std::string &tag : tags)
+    {
+        char tagData[STATE_CHUNK_TAG_SIZE] = {' ', ' ', ' ', ' '};
+        memcpy(tagData, tag.data(), std::min(tag.size(), sizeof(tagData)));
+        success &= fwrite(tagData, sizeof(tagData), 1, file) == 1;
+    }
+
+    if (!success)
+    {
+        LogError("Error writing state hash file %s: %s", filename.c_str(), strerror(errno));
+        fclose(file);
+        file = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+
+bool StateHashRecorder::Close()
+{
+    if (file == NULL)
+        return true;
+
+    if (fclose(file) != 0 && !error)
+    {
+        LogError("Error writing state hash file %s: %s", filename.c_str(), strerror(errno));
+        error = true;
+    }
+    file = NULL;
+
+    return !error;
+}
+
+
+void StateHashRecorder::Record(uint64_t frame, StateReader chunks)
+{
+    if (file == NULL)
+        return;
+
+    record[0] = frame;
+    std::fill(record.begin() + 1, record.end(), 0);
+
+    char tag[STATE_CHUNK_TAG_SIZE];
+    StateReader chunk;
+    while (chunks.ReadChunk(tag, chunk))
+    {
+        for (size_t i = 0; i < tags.size(); i++)
+        {
+            if (memcmp(tag, tags[i].data(), STATE_CHUNK_TAG_SIZE) == 0)
+            {
+                record[i + 1] = HashStateData(chunk.GetData(), chunk.GetRemaining());
+                break;
+            }
+        }
+    }
+
+    // Writes go through the stdio buffer, so most frames don't make a system call. Only the first error is logged.
+    if (fwrite(record.data(), sizeof(uint64_t), record.size(), file) != record.size() && !error)
+    {
+        LogError("Error writing state hash file %s: %s", filename.c_str(), strerror(errno));
+        error = true;
+    }
+
+    recordCount++;
+}
+
+
+void StateHashRecorder::Truncate(uint64_t count)
+{
+    if (file == NULL || count >= recordCount)
+        return;
+
+    const long offset = sizeof(StateHashHeader) + tags.size() * STATE_CHUNK_TAG_SIZE +
+                        count * record.size() * sizeof(uint64_t);
+    if (fflush(file) != 0 || ftruncate(fileno(file), offset) != 0 || fseek(file, offset, SEEK_SET) != 0)
+    {
+        if (!error)
+            LogError("Error truncating state hash file %s: %s", filename.c_str(), strerror(errno));
+        error = true;
+        return;
+    }
+
+    recordCount = count;
+}
+
+
+StateHashReader::StateHashReader() :
+    file(NULL),
+    tags()
+{
+
+}
+
+
+StateHashReader::~StateHashReader()
+{
+    Close();
+}
+
+
+bool StateHashReader::Open(const std::string &filename)
+{
+    Close();
+
+    file = fopen(filename.c_str(), "rb");
+    if (file == NULL)
+    {
+        LogError("Error opening state hash file %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    StateHashHeader header;
+    bool success = fread(&header, sizeof(header), 1, file) == 1 &&
+                   memcmp(header.magic, STATE_HASH_MAGIC, sizeof(header.magic)) == 0 &&
+                   header.version == STATE_HASH_VERSION;
+
+    for (uint i = 0; success && i < header.chunkCount; i++)
+    {
+        char tag[STATE_CHUNK_TAG_SIZE];
+        success = fread(tag, sizeof(tag), 1, file) == 1;
+        tags.push_back(std::string(tag, sizeof(tag)));
+    }
+
+    if (!success)
+    {
+        LogError("State hash file %s has an invalid header", filename.c_str());
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+
+void StateHashReader::Close()
+{
+    if (file)
+        fclose(file);
+    file = NULL;
+    tags.clear();
+}
+
+
+bool StateHashReader::Next(uint64_t &frame, std::vector<uint64_t> &hashes)
+{
+    if (file == NULL || fread(&frame, sizeof(frame), 1, file) != 1)
+        return false;
+
+    hashes.resize(tags.size());
+    return fread(hashes.data(), sizeof(uint64_t), hashes.size(), file) == hashes.size();
+}
\ No newline at end of file
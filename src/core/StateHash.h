@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "gbemu.h"
+#include "StateBuffer.h"
+
+// Per-frame state hash format.
+//
+// Hashing the machine state at the end of every frame shows where two runs of the same game stop agreeing, such as a
+// run on a new build against one on an old build, without keeping a snapshot of every frame. The file starts with a
+// StateHashHeader, followed by the 4 character tags of the chunkCount snapshot chunks that are hashed. After that is
+// one record per frame:
+//
+//   uint64_t  frame               Display frame count at the end of the frame.
+//   uint64_t  hashes[chunkCount]  Hash of each chunk's data, in the order of the tags.
+//
+// Each chunk holds one part of the machine, so comparing hashes per chunk also tells which part diverged first.
+
+const char STATE_HASH_MAGIC[8] = {'Z', 'L', 'G', 'B', 'H', 'S', 'H', '\0'};
+const uint16_t STATE_HASH_VERSION = 1;
+
+struct StateHashHeader
+{
+    char magic[8];
+    uint16_t version;
+    uint16_t chunkCount;
+    uint32_t reserved;
+};
+
+// 64 bit hash of a block of data. Only meant to tell states apart, it isn't cryptographic.
+uint64_t HashStateData(const uint8_t *data, size_t size);
+
+
+class StateHashRecorder
+{
+public:
+    StateHashRecorder();
+    ~StateHashRecorder();
+
+    // Creates the file, with the tags of the chunks each record holds a hash for.
+    bool Open(const std::string &filename, const std::vector<std::string> &tags);
+    // Returns false if any record couldn't be written.
+    bool Close();
+
+    // Hashes the chunks in a snapshot. chunks reads the snapshot from its first chunk. Chunks with other tags are
+    // skipped, and a missing chunk gets a hash of 0.
+    void Record(uint64_t frame, StateReader chunks);
+    // Drops the records after the first count, when the frames they're for are undone.
+    void Truncate(uint64_t count);
+
+    uint64_t GetRecordCount() const {return recordCount;}
+
+    // Don't allow copy and assignment.
+    StateHashRecorder(const StateHashRecorder&) = delete;
+    void operator=(const StateHashRecorder&) = delete;
+
+private:
+    FILE *file;
+    std::string filename;
+    std::vector<std::string> tags;
+    std::vector<uint64_t> record;
+    uint64_t recordCount;
+    bool error;
+};
+
+
+// Reads files written by StateHashRecorder.
+class StateHashReader
+{
+public:
+    StateHashReader();
+    ~StateHashReader();
+
+    bool Open(const std::string &filename);
+    void Close();
+
+    // Reads the next record, with one hash per tag. Returns false at the end of the file, or if the record is cut off.
+    bool Next(uint64_t &frame, std::vector<uint64_t> &hashes);
+
+    const std::vector<std::string> &GetTags() const {return tags;}
+
+    // Don't allow copy and assignment.
+    StateHashReader(const StateHashReader&) = delete;
+    void operator=(const StateHashReader&) = delete;
+
+private:
+    FILE *file;
+    std::vector<std::string> tags;
+};
\ No newline at end of file
@@ -0,0 +1,34 @@
+#include "TileCache.h"
+
+
+TileCache::TileCache(Memory *memory) :
+    memory(memory),
+    rows(),
+    flippedRows()
+{
+    // The tiles may have been written before the cache was created.
+    memory->MarkAllTilesDirty();
+}
+
+
+void TileCache::DecodeTile(uint tile)
+{
+    const uint8_t * const tileData = memory->GetBytePtr(VRAM_TILE_DATA_START + tile * VRAM_TILE_SIZE);
+
+    for (uint row = 0; row < TILE_PIXEL_SIZE; row++)
+    {
+        const uint8_t lowBits = tileData[row * 2];
+        const uint8_t highBits = tileData[row * 2 + 1];
+
+        // The leftmost pixel is in the top bit.
+        for (uint x = 0; x < TILE_PIXEL_SIZE; x++)
+        {
+            const uint bit = (TILE_PIXEL_SIZE - 1) - x;
+            const uint8_t pixelVal = ((lowBits >> bit) & 0x01) | (((highBits >> bit) & 0x01) << 1);
+            rows[tile][row][x] = pixelVal;
+            flippedRows[tile][row][(TILE_PIXEL_SIZE - 1) - x] = pixelVal;
+        }
+    }
+
+    memory->ClearTileDirty(tile);
+}
\ No newline at end of file
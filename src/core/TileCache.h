@@ -0,0 +1,40 @@
+#pragma once
+
+#include "gbemu.h"
+#include "Memory.h"
+
+const uint TILE_PIXEL_SIZE = 8; // Tile is 8x8 pixels.
+
+
+// VRAM tiles decoded into one palette index per pixel.
+//
+// Tile data holds each row of 8 pixels as two bit planes, so finding a pixel's palette index takes a shift and mask
+// on each plane. The cache keeps every row already decoded, left to right and mirrored, so drawing a scanline is
+// copying 8 indices at a time. A tile is decoded again the next time it's used after Memory marks it dirty.
+class TileCache
+{
+public:
+    explicit TileCache(Memory *memory);
+
+    // Palette indices of the 8 pixels in a row of a tile, left to right, or right to left if flipX is set. Tiles are
+    // numbered from 0x8000. The row is valid until the tile is written.
+    const uint8_t *GetRow(uint tile, uint row, bool flipX = false)
+    {
+        if (memory->IsTileDirty(tile))
+            DecodeTile(tile);
+
+        return flipX ? flippedRows[tile][row] : rows[tile][row];
+    }
+
+    // Don't allow copy and assignment.
+    TileCache(const TileCache&) = delete;
+    void operator=(const TileCache&) = delete;
+
+private:
+    void DecodeTile(uint tile);
+
+    Memory *memory;
+
+    uint8_t rows[VRAM_TILE_COUNT][TILE_PIXEL_SIZE][TILE_PIXEL_SIZE];
+    uint8_t flippedRows[VRAM_TILE_COUNT][TILE_PIXEL_SIZE][TILE_PIXEL_SIZE];
+};
\ No newline at end of file
@@ -23,6 +23,7 @@ Timer::Timer(IoRegisterSubject *ioRegisterSubject, Interrupt *interrupts) :
     regTAC(ioRegisterSubject->AttachIoRegister(eRegTAC, this)),
     regDIV(ioRegisterSubject->AttachIoRegister(eRegDIV, this)),
     internalCounter(0),
+    clockCount(0),
     regTIMAOverflowed(false),
     interrupts(interrupts)
 {
@@ -103,6 +104,7 @@ void Timer::AddCycle()
 
     *regDIV = newCounter >> 8;
     internalCounter = newCounter & 0xFF;
+    clockCount += CLOCKS_PER_CYCLE;
 
     NotifyObservers(CLOCKS_PER_CYCLE);
 }
@@ -159,26 +161,26 @@ void Timer::PrintTimerData()
 }
 
 
-bool Timer::SaveState(FILE *file)
+bool Timer::SaveState(StateWriter &writer)
 {
-    if (!fwrite(&internalCounter, sizeof(internalCounter), 1, file))
+    if (!writer.Write(&internalCounter, sizeof(internalCounter)))
         return false;
 
-    if (!fwrite(&regTIMAOverflowed, sizeof(regTIMAOverflowed), 1, file))
+    if (!writer.Write(&regTIMAOverflowed, sizeof(regTIMAOverflowed)))
         return false;
 
     return true;
 }
 
 
-bool Timer::LoadState(uint16_t version, FILE *file)
+bool Timer::LoadState(uint16_t version, StateReader &reader)
 {
     (void)version;
 
-    if (!fread(&internalCounter, sizeof(internalCounter), 1, file))
+    if (!reader.Read(&internalCounter, sizeof(internalCounter)))
         return false;
 
-    if (!fread(&regTIMAOverflowed, sizeof(regTIMAOverflowed), 1, file))
+    if (!reader.Read(&regTIMAOverflowed, sizeof(regTIMAOverflowed)))
         return false;
 
     return true;
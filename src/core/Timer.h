@@ -3,6 +3,7 @@
 #include "gbemu.h"
 #include "Interrupt.h"
 #include "Memory.h"
+#include "StateBuffer.h"
 #include "TimerObserver.h"
 
 // The memory for the timer registers belongs to the Memory class, but the Timer class 'owns' the access to the memory.
@@ -27,8 +28,13 @@ public:
 
     uint16_t GetCounter() {return (*regDIV << 8) | internalCounter;}
 
-    bool SaveState(FILE *file);
-    bool LoadState(uint16_t version, FILE *file);
+    // Total clocks since the timer was created.
+    uint64_t GetClockCount() const {return clockCount;}
+    // The clock count isn't part of the state, so it's put back by hand when clocks are run and then undone.
+    void SetClockCount(uint64_t clockCount) {this->clockCount = clockCount;}
+
+    bool SaveState(StateWriter &writer);
+    bool LoadState(uint16_t version, StateReader &reader);
 
 private:
     void ProcessCounterChange(uint16_t oldValue, uint16_t newValue);
@@ -39,6 +45,7 @@ private:
     uint8_t *regDIV;
 
     uint8_t internalCounter;
+    uint64_t clockCount;
 
     bool regTIMAOverflowed;
 
@@ -0,0 +1,163 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Logger.h"
+#include "OpcodeLength.h"
+#include "TraceReader.h"
+
+
+TraceReader::TraceReader() :
+    data(NULL),
+    mapSize(0),
+    size(0),
+    offset(0),
+    recordCount(0),
+    last()
+{
+
+}
+
+
+TraceReader::~TraceReader()
+{
+    Close();
+}
+
+
+bool TraceReader::Open(const std::string &filename)
+{
+    Close();
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        LogError("Error opening trace file %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) || (size_t)st.st_size < sizeof(TraceHeader))
+    {
+        LogError("Trace file %s is too small", filename.c_str());
+        close(fd);
+        return false;
+    }
+
+    void *ptr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (ptr == MAP_FAILED)
+    {
+        LogError("Error mapping trace file %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    data = static_cast<const uint8_t *>(ptr);
+    mapSize = st.st_size;
+    size = st.st_size;
+
+    TraceHeader header;
+    memcpy(&header, data, sizeof(header));
+    if (memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) || header.version != TRACE_VERSION)
+    {
+        LogError("Trace file %s has an invalid header", filename.c_str());
+        Close();
+        return false;
+    }
+
+    // Ignore the unused tail of the file if the recorder didn't get to trim it.
+    if (header.headerSize + header.dataSize <= size)
+        size = header.headerSize + header.dataSize;
+
+    offset = header.headerSize;
+    recordCount = header.recordCount;
+    memset(&last, 0, sizeof(last));
+
+    return true;
+}
+
+
+void TraceReader::Close()
+{
+    if (data != NULL)
+    {
+        munmap(const_cast<uint8_t *>(data), mapSize);
+        data = NULL;
+    }
+
+    mapSize = 0;
+    size = 0;
+    offset = 0;
+    recordCount = 0;
+}
+
+
+bool TraceReader::Next(TraceEntry &entry)
+{
+    if (data == NULL || offset + 2 > size)
+        return false;
+
+    const uint8_t *ptr = &data[offset];
+    const uint8_t * const end = &data[size];
+    const uint8_t flags = *ptr++;
+
+    uint64_t clockDelta = 0;
+    int shift = 0;
+    do
+    {
+        if (ptr >= end || shift > 63)
+            return false;
+        clockDelta |= (uint64_t)(*ptr & 0x7F) << shift;
+        shift += 7;
+    } while (*ptr++ & 0x80);
+
+    if (ptr >= end)
+        return false;
+
+    entry = last;
+    entry.clock = last.clock + clockDelta;
+    entry.opcodeLength = GetOpcodeLength(*ptr);
+    entry.opcode[1] = entry.opcode[2] = 0;
+    if (ptr + entry.opcodeLength > end)
+        return false;
+    for (uint8_t i = 0; i < entry.opcodeLength; i++)
+        entry.opcode[i] = *ptr++;
+
+    auto readWord = [&ptr, end, flags](uint16_t &value, TraceFlags flag)
+    {
+        if (flags & flag)
+        {
+            if (ptr + 2 > end)
+                return false;
+            value = ptr[0] | (ptr[1] << 8);
+            ptr += 2;
+        }
+        return true;
+    };
+
+    entry.pc = last.pc + last.opcodeLength;
+    bool success = readWord(entry.pc, eTracePC);
+    success &= readWord(entry.af, eTraceAF);
+    success &= readWord(entry.bc, eTraceBC);
+    success &= readWord(entry.de, eTraceDE);
+    success &= readWord(entry.hl, eTraceHL);
+    success &= readWord(entry.sp, eTraceSP);
+
+    if (flags & eTraceBank)
+    {
+        if (ptr >= end)
+            return false;
+        entry.bank = *ptr++;
+    }
+
+    if (!success)
+        return false;
+
+    last = entry;
+    offset = ptr - data;
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+
+#include "gbemu.h"
+#include "TraceRecorder.h"
+
+// Reads trace files written by TraceRecorder.
+class TraceReader
+{
+public:
+    TraceReader();
+    ~TraceReader();
+
+    bool Open(const std::string &filename);
+    void Close();
+
+    // Decodes the next record into entry. Returns false at the end of the trace, or if the trace is corrupt.
+    bool Next(TraceEntry &entry);
+
+    uint64_t GetRecordCount() const {return recordCount;}
+
+    // Don't allow copy and assignment.
+    TraceReader(const TraceReader&) = delete;
+    void operator=(const TraceReader&) = delete;
+
+private:
+    const uint8_t *data;
+    size_t mapSize;
+    size_t size;
+    size_t offset;
+    uint64_t recordCount;
+
+    TraceEntry last;
+};
\ No newline at end of file
@@ -0,0 +1,203 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "Cpu.h"
+#include "Logger.h"
+#include "OpcodeLength.h"
+#include "TraceRecorder.h"
+
+
+TraceRecorder::TraceRecorder() :
+    fd(-1),
+    filename(),
+    data(NULL),
+    capacity(0),
+    offset(0),
+    recordCount(0),
+    last()
+{
+
+}
+
+
+TraceRecorder::~TraceRecorder()
+{
+    Close();
+}
+
+
+bool TraceRecorder::Open(const std::string &filename)
+{
+    Close();
+
+    fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        LogError("Error opening trace file %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    this->filename = filename;
+    offset = sizeof(TraceHeader);
+    recordCount = 0;
+    memset(&last, 0, sizeof(last));
+
+    if (!Map(TRACE_GROW_SIZE))
+    {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    WriteHeader();
+
+    LogInfo("Recording trace to %s", filename.c_str());
+
+    return true;
+}
+
+
+void TraceRecorder::Close()
+{
+    if (data != NULL)
+    {
+        WriteHeader();
+        munmap(data, capacity);
+        data = NULL;
+
+        // Trim the unused part of the last chunk.
+        if (ftruncate(fd, offset))
+            LogError("Error truncating trace file %s: %s", filename.c_str(), strerror(errno));
+
+        LogInfo("Wrote %llu trace records (%llu bytes) to %s", (unsigned long long)recordCount, (unsigned long long)offset, filename.c_str());
+    }
+
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+
+    capacity = 0;
+}
+
+
+void TraceRecorder::WriteRecord(const Registers &reg, const uint8_t *opcode, uint8_t bank, uint64_t clock)
+{
+    uint8_t *start = &data[offset];
+    uint8_t *ptr = start + 1;
+    uint8_t flags = 0;
+
+    // Clock delta as LEB128.
+    uint64_t clockDelta = clock - last.clock;
+    while (clockDelta >= 0x80)
+    {
+        *ptr++ = (clockDelta & 0x7F) | 0x80;
+        clockDelta >>= 7;
+    }
+    *ptr++ = clockDelta;
+
+    const uint8_t length = GetOpcodeLength(opcode[0]);
+    for (uint8_t i = 0; i < length; i++)
+        *ptr++ = opcode[i];
+
+    // Write a 16 bit value if it differs from the last record.
+    auto writeWord = [&ptr, &flags](uint16_t value, uint16_t &lastValue, TraceFlags flag)
+    {
+        if (value != lastValue)
+        {
+            flags |= flag;
+            *ptr++ = value & 0xFF;
+            *ptr++ = value >> 8;
+            lastValue = value;
+        }
+    };
+
+    // PC is only written when it doesn't follow on from the last instruction (jumps, calls, interrupts, etc).
+    uint16_t expectedPc = last.pc + last.opcodeLength;
+    writeWord(reg.pc, expectedPc, eTracePC);
+    writeWord(reg.af, last.af, eTraceAF);
+    writeWord(reg.bc, last.bc, eTraceBC);
+    writeWord(reg.de, last.de, eTraceDE);
+    writeWord(reg.hl, last.hl, eTraceHL);
+    writeWord(reg.sp, last.sp, eTraceSP);
+
+    if (bank != last.bank)
+    {
+        flags |= eTraceBank;
+        *ptr++ = bank;
+        last.bank = bank;
+    }
+
+    *start = flags;
+
+    last.pc = reg.pc;
+    last.opcodeLength = length;
+    last.clock = clock;
+
+    offset += ptr - start;
+    recordCount++;
+}
+
+
+bool TraceRecorder::Grow()
+{
+    if (data == NULL)
+        return false;
+
+    // Keep the header current, so the trace up to here is readable even if remapping fails.
+    WriteHeader();
+
+    if (!Map(capacity + TRACE_GROW_SIZE))
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+
+bool TraceRecorder::Map(size_t newCapacity)
+{
+    if (data != NULL)
+    {
+        munmap(data, capacity);
+        data = NULL;
+    }
+
+    if (ftruncate(fd, newCapacity))
+    {
+        LogError("Error resizing trace file %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    void *ptr = mmap(NULL, newCapacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED)
+    {
+        LogError("Error mapping trace file %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    data = static_cast<uint8_t *>(ptr);
+    capacity = newCapacity;
+
+    return true;
+}
+
+
+void TraceRecorder::WriteHeader()
+{
+    TraceHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+    header.version = TRACE_VERSION;
+    header.headerSize = sizeof(TraceHeader);
+    header.dataSize = offset - sizeof(TraceHeader);
+    header.recordCount = recordCount;
+
+    memcpy(data, &header, sizeof(header));
+}
\ No newline at end of file
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <string>
+
+#include "gbemu.h"
+
+struct Registers;
+
+// Binary instruction trace format.
+//
+// The file starts with a TraceHeader, followed by a stream of variable length records. Each record describes one
+// instruction, with the register values from before the instruction was executed. To keep records small, only values
+// that changed since the previous record are written:
+//
+//   uint8_t   flags       TraceFlags bits for the fields that follow.
+//   varint    clockDelta  Clocks since the previous record (LEB128).
+//   uint8_t[] opcode      1-3 opcode bytes, length is looked up from the first byte (CB prefixed opcodes are 2 bytes).
+//   uint16_t  pc          Only if eTracePC is set. Otherwise pc is the previous pc plus the previous opcode length.
+//   uint16_t  af, bc, de, hl, sp  Each only if its flag is set.
+//   uint8_t   bank        Only if eTraceBank is set.
+//
+// The file is memory mapped, and grown in TRACE_GROW_SIZE chunks, so recording is just a few stores per instruction.
+
+const char TRACE_MAGIC[8] = {'Z', 'L', 'G', 'B', 'T', 'R', 'C', '\0'};
+const uint16_t TRACE_VERSION = 1;
+
+enum TraceFlags
+{
+    eTracePC   = 0x01,
+    eTraceAF   = 0x02,
+    eTraceBC   = 0x04,
+    eTraceDE   = 0x08,
+    eTraceHL   = 0x10,
+    eTraceSP   = 0x20,
+    eTraceBank = 0x40
+};
+
+struct TraceHeader
+{
+    char magic[8];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t reserved;
+    uint64_t dataSize;
+    uint64_t recordCount;
+};
+
+// One decoded trace record.
+struct TraceEntry
+{
+    uint64_t clock;
+    uint16_t pc;
+    uint16_t af;
+    uint16_t bc;
+    uint16_t de;
+    uint16_t hl;
+    uint16_t sp;
+    uint8_t bank;
+    uint8_t opcode[3];
+    uint8_t opcodeLength;
+};
+
+
+class TraceRecorder
+{
+public:
+    TraceRecorder();
+    ~TraceRecorder();
+
+    bool Open(const std::string &filename);
+    void Close();
+
+    bool IsOpen() const {return data != NULL;}
+    uint64_t GetRecordCount() const {return recordCount;}
+    uint64_t GetDataSize() const {return offset;}
+
+    // opcode must point to at least 3 readable bytes.
+    void Record(const Registers &reg, const uint8_t *opcode, uint8_t bank, uint64_t clock)
+    {
+        // Make sure there is always room for a worst case record.
+        if (offset + MAX_RECORD_SIZE > capacity && !Grow())
+            return;
+
+        WriteRecord(reg, opcode, bank, clock);
+    }
+
+    // Don't allow copy and assignment.
+    TraceRecorder(const TraceRecorder&) = delete;
+    void operator=(const TraceRecorder&) = delete;
+
+private:
+    static const size_t MAX_RECORD_SIZE = 32;
+    static const size_t TRACE_GROW_SIZE = 64 * 1024 * 1024;
+
+    void WriteRecord(const Registers &reg, const uint8_t *opcode, uint8_t bank, uint64_t clock);
+    bool Grow();
+    bool Map(size_t newCapacity);
+    void WriteHeader();
+
+    int fd;
+    std::string filename;
+
+    uint8_t *data;
+    size_t capacity;
+    size_t offset;
+    uint64_t recordCount;
+
+    // Previous record, used for delta encoding.
+    TraceEntry last;
+};
\ No newline at end of file
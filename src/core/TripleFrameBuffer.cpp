@@ -0,0 +1,14 @@
+#include "TripleFrameBuffer.h"
+
+
+TripleFrameBuffer::TripleFrameBuffer() :
+    buffers(FRAME_PIXELS * 3),
+    changedLineMasks(),
+    carriedLines(),
+    back(0),
+    front(1),
+    latest(2),
+    droppedFrames(0)
+{
+
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "gbemu.h"
+#include "Display.h"
+
+
+// Hands finished frames from the emulator thread to the thread that shows them, without locks or copies.
+//
+// There are three frame buffers. The writer owns the back buffer and draws into it, the reader owns the front buffer
+// and shows it, and the third holds the newest finished frame. Publishing a frame swaps the back buffer with the third
+// one, and acquiring swaps the front buffer with it if a new frame has been published since. Both swaps are a single
+// atomic exchange, so neither side ever waits for the other. If the writer publishes faster than the reader acquires,
+// the frames in between are dropped rather than queued, and the reader always gets the newest one.
+class TripleFrameBuffer
+{
+public:
+    TripleFrameBuffer();
+
+    // Writer side. The back buffer holds whatever frame was last drawn into it, so every pixel has to be drawn again.
+    uint32_t *GetBackBuffer() {return &buffers[back * FRAME_PIXELS];}
+
+    // Publishes the back buffer as the newest frame, and returns it. The returned frame isn't written to until it has
+    // been replaced by a newer one and swapped back in as the back buffer, so the writer can keep reading it until its
+    // next call to Publish(). changedLines are the lines that differ from the frame published before.
+    const uint32_t *Publish(const ScanlineMask &changedLines = ScanlineMask().set())
+    {
+        // The reader may not have the frame published before, so the lines that changed in it are carried as well.
+        const ScanlineMask publishedLines = changedLines | carriedLines;
+        changedLineMasks[back] = publishedLines;
+
+        const uint8_t published = back;
+        const uint8_t previous = latest.exchange(back | NEW_FRAME, std::memory_order_acq_rel);
+        back = previous & BUFFER_MASK;
+
+        // If the frame before was dropped, the reader's frame is older still, so everything this frame carried has to
+        // be carried on. Otherwise, the reader has at least the frame before this one.
+        if (previous & NEW_FRAME)
+        {
+            droppedFrames.fetch_add(1, std::memory_order_relaxed);
+            carriedLines = publishedLines;
+        }
+        else
+        {
+            carriedLines = changedLines;
+        }
+
+        return &buffers[published * FRAME_PIXELS];
+    }
+
+    // Reader side. Returns the newest finished frame, or the same frame as last time if nothing new was published. The
+    // frame stays valid until the next call. If changedLines isn't NULL, it's set to the lines that may differ from the
+    // frame returned last time, which are none if it's the same frame.
+    const uint32_t *Acquire(ScanlineMask *changedLines = NULL)
+    {
+        if (latest.load(std::memory_order_relaxed) & NEW_FRAME)
+        {
+            front = latest.exchange(front, std::memory_order_acq_rel) & BUFFER_MASK;
+            if (changedLines)
+                *changedLines = changedLineMasks[front];
+        }
+        else if (changedLines)
+        {
+            changedLines->reset();
+        }
+
+        return &buffers[front * FRAME_PIXELS];
+    }
+
+    // Frames that were replaced before the reader got to them.
+    uint64_t GetDroppedFrames() const {return droppedFrames.load(std::memory_order_relaxed);}
+
+    // Don't allow copy and assignment.
+    TripleFrameBuffer(const TripleFrameBuffer&) = delete;
+    void operator=(const TripleFrameBuffer&) = delete;
+
+private:
+    static const size_t FRAME_PIXELS = SCREEN_X * SCREEN_Y;
+    static const uint8_t BUFFER_MASK = 0x03;
+    static const uint8_t NEW_FRAME = 0x04;
+
+    std::vector<uint32_t> buffers;
+    ScanlineMask changedLineMasks[3];  // Lines each frame may differ in from any frame the reader can have before it.
+    ScanlineMask carriedLines;         // Only used by the writer.
+    uint8_t back;                // Only used by the writer.
+    uint8_t front;               // Only used by the reader.
+    std::atomic<uint8_t> latest; // Index of the newest frame, with NEW_FRAME set until the reader takes it.
+    std::atomic<uint64_t> droppedFrames;
+};
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Variable length integers, 7 bits per byte with the top bit set on every byte but the last.
+
+
+static inline uint8_t *WriteVarint(uint8_t *ptr, size_t value)
+{
+    while (value >= 0x80)
+    {
+        *ptr++ = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    *ptr++ = value;
+    return ptr;
+}
+
+
+static inline const uint8_t *ReadVarint(const uint8_t *ptr, size_t &value)
+{
+    value = 0;
+    int shift = 0;
+    do
+    {
+        value |= (size_t)(*ptr & 0x7F) << shift;
+        shift += 7;
+    } while (*ptr++ & 0x80);
+    return ptr;
+}
+
+
+// Reads a varint from data that may be cut off or corrupt. Returns NULL if it runs past end or doesn't fit in a size_t.
+static inline const uint8_t *ReadVarint(const uint8_t *ptr, const uint8_t *end, size_t &value)
+{
+    value = 0;
+    for (int shift = 0; ptr < end && shift < (int)sizeof(size_t) * 8; shift += 7)
+    {
+        value |= (size_t)(*ptr & 0x7F) << shift;
+        if ((*ptr++ & 0x80) == 0)
+            return ptr;
+    }
+    return NULL;
+}
\ No newline at end of file
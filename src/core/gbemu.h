@@ -10,4 +10,8 @@
 const int CLOCKS_PER_SECOND = 4194304;
 
 // There are 4 clocks per instruction cycle.
-const int CLOCKS_PER_CYCLE = 4;
\ No newline at end of file
+const int CLOCKS_PER_CYCLE = 4;
+
+// A frame is 154 scanlines of 456 clocks, so the game runs at about 59.7 frames per second.
+const uint64_t CLOCKS_PER_FRAME = 154 * 456;
+const double FRAMES_PER_SECOND = (double)CLOCKS_PER_SECOND / CLOCKS_PER_FRAME;
\ No newline at end of file
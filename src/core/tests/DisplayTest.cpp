@@ -1,8 +1,15 @@
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <random>
 #include <string.h>
+#include <vector>
 
 #include "main.h"
 #include "DisplayTest.h"
+#include "../DisplayInterface.h"
+#include "../Interrupt.h"
+#include "../Memory.h"
+#include "../Timer.h"
 
 DisplayTest::DisplayTest()
 {
@@ -81,4 +88,221 @@ void DisplayTest::TearDown()
         state->display->UpdateTimer(4);
 
     SDL_Delay(10000);
-}*/
\ No newline at end of file
+}*/
+
+
+// Keeps the last frame the display published, and counts the frames.
+class FrameRecorder : public DisplayInterface
+{
+public:
+    virtual void FrameReady(const uint32_t *frameBuffer, const ScanlineMask &changedLines)
+    {
+        frame = frameBuffer;
+        lastChangedLines = changedLines;
+        changedFrames++;
+    }
+    virtual void FrameUnchanged(const uint32_t *frameBuffer) {EXPECT_EQ(frameBuffer, frame); unchangedFrames++;}
+    virtual void RequestMessageBox(const std::string &message) {(void)message;}
+    virtual void SaveStateComplete(const std::string &filename, bool success) {(void)filename; (void)success;}
+
+    const uint32_t *frame = NULL;
+    ScanlineMask lastChangedLines;
+    uint changedFrames = 0;
+    uint unchangedFrames = 0;
+};
+
+
+// Draws a frame one pixel at a time, straight from VRAM, OAM and the registers, the way the renderer did before tiles
+// were cached and lines were composited with SIMD.
+static void DrawReferenceFrame(const Memory &memory, uint32_t *frame)
+{
+    const uint8_t shades[4] = {0xFF, 0xB0, 0x68, 0x00};
+    const uint8_t lcdc = memory.ReadRawByte(eRegLCDC);
+    const int wx = memory.ReadRawByte(eRegWX) - 7;
+    const uint wy = memory.ReadRawByte(eRegWY);
+
+    auto getColor = [&](uint8_t paletteReg, uint8_t pixelVal)
+    {
+        const uint8_t shade = shades[(paletteReg >> (pixelVal * 2)) & 0x03];
+        return (uint32_t)(shade << 16 | shade << 8 | shade);
+    };
+    auto getPixel = [&](uint16_t tileAddress, uint row, uint x)
+    {
+        const uint8_t low = memory.ReadRawByte(tileAddress + row * 2);
+        const uint8_t high = memory.ReadRawByte(tileAddress + row * 2 + 1);
+        return (uint8_t)(((low >> (7 - x)) & 0x01) | (((high >> (7 - x)) & 0x01) << 1));
+    };
+    auto getMapPixel = [&](uint16_t tileMap, uint mapX, uint mapY)
+    {
+        const uint8_t tileId = memory.ReadRawByte(tileMap + (mapY / 8) * 32 + mapX / 8);
+        const uint16_t tileAddress = (lcdc & 0x10) ? 0x8000 + tileId * 16 : 0x9000 + (int8_t)tileId * 16;
+        return getPixel(tileAddress, mapY & 7, mapX & 7);
+    };
+
+    for (uint y = 0; y < SCREEN_Y; y++)
+    {
+        uint8_t bgPixels[SCREEN_X];
+        for (uint x = 0; x < SCREEN_X; x++)
+        {
+            uint8_t pixelVal = 0;
+            uint32_t color = 0xFFFFFF;
+            if (lcdc & 0x01)
+            {
+                pixelVal = getMapPixel((lcdc & 0x08) ? 0x9C00 : 0x9800, (x + memory.ReadRawByte(eRegSCX)) & 0xFF,
+                                       (y + memory.ReadRawByte(eRegSCY)) & 0xFF);
+                color = getColor(memory.ReadRawByte(eRegBGP), pixelVal);
+            }
+            if ((lcdc & 0x20) && y >= wy && (int)x >= wx)
+            {
+                pixelVal = getMapPixel((lcdc & 0x40) ? 0x9C00 : 0x9800, x - wx, y - wy);
+                color = getColor(memory.ReadRawByte(eRegBGP), pixelVal);
+            }
+            bgPixels[x] = pixelVal;
+            frame[y * SCREEN_X + x] = color;
+        }
+
+        if ((lcdc & 0x02) == 0)
+            continue;
+
+        // The first 10 sprites in OAM on the line are drawn, lower X first, then lower OAM index.
+        const uint spriteSize = (lcdc & 0x04) ? 16 : 8;
+        std::vector<uint> sprites;
+        for (uint i = 0; i < 40 && sprites.size() < 10; i++)
+        {
+            const int spriteY = memory.ReadRawByte(0xFE00 + i * 4) - 16;
+            if ((int)y >= spriteY && (int)y < spriteY + (int)spriteSize)
+                sprites.push_back(i);
+        }
+        std::stable_sort(sprites.begin(), sprites.end(), [&](uint a, uint b)
+        {
+            return memory.ReadRawByte(0xFE01 + a * 4) < memory.ReadRawByte(0xFE01 + b * 4);
+        });
+
+        for (auto sprite = sprites.rbegin(); sprite != sprites.rend(); ++sprite)
+        {
+            const uint8_t * const oam = memory.GetBytePtr(0xFE00 + *sprite * 4);
+            const uint8_t attr = oam[3];
+            uint line = y - (oam[0] - 16);
+            if (attr & 0x40)
+                line = (spriteSize - 1) - line;
+            const uint8_t tileId = (spriteSize == 16) ? (oam[2] & 0xFE) : oam[2];
+
+            for (uint i = 0; i < 8; i++)
+            {
+                const int x = oam[1] - 8 + (int)i;
+                const uint8_t pixelVal = getPixel(0x8000 + tileId * 16, line, (attr & 0x20) ? 7 - i : i);
+                if (x < 0 || x >= (int)SCREEN_X || pixelVal == 0 || ((attr & 0x80) && bgPixels[x] != 0))
+                    continue;
+
+                frame[y * SCREEN_X + x] = getColor(memory.ReadRawByte((attr & 0x10) ? eRegOBP1 : eRegOBP0), pixelVal);
+            }
+        }
+    }
+}
+
+
+TEST_F(DisplayTest, TEST_ReferenceRenderer)
+{
+    std::mt19937 random(1);
+    std::vector<uint32_t> expected(SCREEN_X * SCREEN_Y);
+
+    for (uint scene = 0; scene < 200; scene++)
+    {
+        Memory memory;
+        Interrupt interrupts(&memory);
+        Timer timer(&memory, &interrupts);
+        std::vector<uint8_t> gameRomMemory(ROM_BANK_SIZE * 2);
+        memory.SetRomMemory(gameRomMemory);
+        FrameRecorder recorder;
+        Display display(&memory, &interrupts, &recorder, &timer);
+
+        for (uint address = 0x8000; address < 0xA000; address++)
+            memory.WriteByte(address, random());
+        for (uint address = OAM_RAM_START; address < OAM_RAM_START + OAM_RAM_LEN; address++)
+            memory.WriteByte(address, random());
+        memory.WriteByte(eRegLCDC, random() | 0x80);
+        memory.WriteByte(eRegSCX, random());
+        memory.WriteByte(eRegSCY, random());
+        memory.WriteByte(eRegBGP, random());
+        memory.WriteByte(eRegOBP0, random());
+        memory.WriteByte(eRegOBP1, random());
+        memory.WriteByte(eRegWY, random() % 160);
+        memory.WriteByte(eRegWX, random() % 180);
+
+        // Later frames are drawn after some tiles and sprites change, and then the sprite size, so they check the
+        // cached tiles and sprite lists are updated.
+        for (uint frame = 0; frame < 3; frame++)
+        {
+            display.RedrawFrame();
+            display.PresentFrame();
+
+            DrawReferenceFrame(memory, expected.data());
+            for (uint i = 0; i < SCREEN_X * SCREEN_Y; i++)
+                ASSERT_EQ(recorder.frame[i], expected[i])
+                    << "scene " << scene << " x " << i % SCREEN_X << " y " << i / SCREEN_X;
+
+            for (uint i = 0; i < 64; i++)
+                memory.WriteByte(0x8000 + random() % 0x1800, random());
+            if (frame == 0)
+            {
+                for (uint i = 0; i < 16; i++)
+                    memory.WriteByte(OAM_RAM_START + random() % OAM_RAM_LEN, random());
+            }
+            else
+            {
+                memory.WriteByte(eRegLCDC, memory.ReadByte(eRegLCDC) ^ 0x04);
+            }
+        }
+    }
+}
+
+
+TEST_F(DisplayTest, TEST_UnchangedFrames)
+{
+    Memory memory;
+    Interrupt interrupts(&memory);
+    Timer timer(&memory, &interrupts);
+    std::vector<uint8_t> gameRomMemory(ROM_BANK_SIZE * 2);
+    memory.SetRomMemory(gameRomMemory);
+    FrameRecorder recorder;
+    Display display(&memory, &interrupts, &recorder, &timer);
+
+    memory.WriteByte(eRegBGP, 0xE4);
+    memory.WriteByte(eRegLCDC, 0x91);
+
+    auto runFrame = [&]()
+    {
+        for (uint i = 0; i < CLOCKS_PER_FRAME; i += 4)
+            display.UpdateTimer(4);
+    };
+
+    // The LCD starts on the first line, so the first frame is whole.
+    runFrame();
+    ASSERT_EQ(recorder.changedFrames, 1u);
+    ASSERT_EQ(recorder.unchangedFrames, 0u);
+    EXPECT_TRUE(recorder.lastChangedLines.all());
+
+    runFrame();
+    runFrame();
+    EXPECT_EQ(recorder.changedFrames, 1u);
+    EXPECT_EQ(recorder.unchangedFrames, 2u);
+
+    // Every tile on screen is tile 0, so changing its top row changes every 8th line.
+    const uint32_t *lastFrame = recorder.frame;
+    memory.WriteByte(0x8000, 0xFF);
+    runFrame();
+    EXPECT_EQ(recorder.changedFrames, 2u);
+    EXPECT_NE(recorder.frame, lastFrame);
+    for (uint i = 0; i < SCREEN_Y; i++)
+        EXPECT_EQ(recorder.lastChangedLines[i], i % 8 == 0) << "line " << i;
+
+    // Tile data that isn't on screen doesn't.
+    memory.WriteByte(0x8010, 0xFF);
+    runFrame();
+    EXPECT_EQ(recorder.changedFrames, 2u);
+    EXPECT_EQ(recorder.unchangedFrames, 3u);
+
+    // Presenting the frame again always publishes it.
+    display.PresentFrame();
+    EXPECT_EQ(recorder.changedFrames, 3u);
+}
\ No newline at end of file
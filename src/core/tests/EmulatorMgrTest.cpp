@@ -0,0 +1,293 @@
+#include <fstream>
+#include <iterator>
+
+#include "main.h"
+#include "EmulatorMgrTest.h"
+#include "TestEmulator.h"
+#include "../Cpu.h"
+#include "../Display.h"
+#include "../EmulatorMgr.h"
+#include "../Input.h"
+#include "../Interrupt.h"
+#include "../Memory.h"
+#include "../Serial.h"
+#include "../StateBuffer.h"
+#include "../Timer.h"
+
+
+// Reads a whole file, so files written by two runs can be compared.
+static std::string ReadFile(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+
+// Writes a save state in the layout of version 1 or 2, where memory was saved as a whole, ROM included. The game has
+// ROM bank 2 mapped, 0x77 at 0xC000, and PC and A set to the given values.
+static std::vector<uint8_t> MakeOldSaveState(uint16_t version, std::vector<uint8_t> &rom, uint16_t pc, uint8_t a)
+{
+    Memory memory;
+    Interrupt interrupts(&memory);
+    Timer timer(&memory, &interrupts);
+    Display display(&memory, &interrupts, NULL, &timer);
+    Input input(&memory, &interrupts);
+    Serial serial(&memory, &interrupts, &timer);
+    Cpu cpu(&interrupts, &memory, &timer);
+
+    memory.SetRomMemory(rom);
+    memory.WriteByte(0x2000, 2);
+    memory.WriteByte(0xC000, 0x77);
+    cpu.reg.pc = pc;
+    cpu.reg.a = a;
+
+    std::vector<uint8_t> state(MEM_SIZE * 2);
+    StateWriter writer(state.data(), state.size());
+    bool success = writer.Write("ZLGB", 4);
+
+    // Version 1 was saved as ASCII.
+    if (version == 1)
+        success &= writer.Write("01", 2);
+    else
+        success &= writer.Write(&version, sizeof(version));
+
+    success &= writer.Write(memory.GetBytePtr(0), MEM_SIZE);
+
+    // Version 1 didn't save the banks, or whether RAM is enabled.
+    if (version >= 2)
+    {
+        const uint8_t curRomBank = memory.GetCurRomBank();
+        const uint8_t curRamBank = 0;
+        const bool ramEnabled = false;
+        success &= writer.Write(&curRomBank, sizeof(curRomBank));
+        success &= writer.Write(&curRamBank, sizeof(curRamBank));
+        success &= writer.Write(&ramEnabled, sizeof(ramEnabled));
+    }
+
+    const bool isDmaActive = false;
+    const uint8_t dmaOffset = 0;
+    success &= writer.Write(&isDmaActive, sizeof(isDmaActive));
+    success &= writer.Write(&dmaOffset, sizeof(dmaOffset));
+
+    // MBC1 registers: RAM enable, low and high ROM bank bits, and banking mode.
+    const uint8_t mbc1Registers[] = {0x00, 0x02, 0x00, 0x00};
+    success &= writer.Write(mbc1Registers, sizeof(mbc1Registers));
+
+    success &= interrupts.SaveState(writer);
+    success &= timer.SaveState(writer);
+    success &= display.SaveState(writer);
+    success &= input.SaveState(writer);
+    success &= serial.SaveState(writer);
+    success &= cpu.SaveState(writer);
+
+    state.resize(success ? writer.GetSize() : 0);
+    return state;
+}
+
+
+EmulatorMgrTest::EmulatorMgrTest()
+{
+    frameCounterRom = TestEmulator::MakeRom({
+        0x3E, 0x80,        // LD A, 0x80
+        0xE0, 0x26,        // LDH (NR52), A
+        0x3E, 0x77,        // LD A, 0x77
+        0xE0, 0x24,        // LDH (NR50), A
+        0x3E, 0xFF,        // LD A, 0xFF
+        0xE0, 0x25,        // LDH (NR51), A
+        0xF0, 0x44,        // LDH A, (LY)
+        0xFE, 0x90,        // CP 144
+        0x20, 0xFA,        // JR NZ, -6
+        0x21, 0x00, 0xC0,  // LD HL, 0xC000
+        0x34,              // INC (HL)
+        0x7E,              // LD A, (HL)
+        0xE0, 0x01,        // LDH (SB), A
+        0xE0, 0x13,        // LDH (NR13), A
+        0x3E, 0x81,        // LD A, 0x81
+        0xE0, 0x02,        // LDH (SC), A
+        0x3E, 0xF0,        // LD A, 0xF0
+        0xE0, 0x12,        // LDH (NR12), A
+        0x3E, 0x87,        // LD A, 0x87
+        0xE0, 0x14,        // LDH (NR14), A
+        0x3E, 0x10,        // LD A, 0x10
+        0xE0, 0x00,        // LDH (P1), A
+        0xF0, 0x00,        // LDH A, (P1)
+        0xEA, 0x01, 0xC0,  // LD (0xC001), A
+        0xF0, 0x44,        // LDH A, (LY)
+        0xFE, 0x90,        // CP 144
+        0x28, 0xFA,        // JR Z, -6
+        0x18, 0xD4         // JR -44
+    });
+}
+
+
+EmulatorMgrTest::~EmulatorMgrTest()
+{
+
+}
+
+
+void EmulatorMgrTest::SetUp()
+{
+
+}
+
+
+void EmulatorMgrTest::TearDown()
+{
+
+}
+
+
+uint64_t EmulatorMgrTest::RunFrames(TestEmulator &emulator, uint frames)
+{
+    uint64_t clocks = 0;
+    for (uint frame = 0; frame < frames; frame++)
+    {
+        if (frame == frames / 3)
+            emulator.emulator->ButtonPressed(Buttons::eButtonA);
+        else if (frame == frames * 2 / 3)
+            emulator.emulator->ButtonReleased(Buttons::eButtonA);
+
+        clocks += emulator.emulator->Run(0, 1);
+    }
+
+    return clocks;
+}
+
+
+TEST_F(EmulatorMgrTest, TEST_RunAheadMatchesNormalRun)
+{
+    const uint frames = 60;
+
+    TestEmulator expected("run_ahead_expected"), actual("run_ahead_actual");
+    for (TestEmulator *emulator : {&expected, &actual})
+    {
+        ASSERT_TRUE(emulator->LoadRom(frameCounterRom));
+        ASSERT_TRUE(emulator->emulator->StartStateHashing(emulator->GetFilename(".hash")));
+    }
+
+    actual.emulator->SetRunAhead(2);
+
+    const uint64_t expectedClocks = RunFrames(expected, frames);
+    const uint64_t actualClocks = RunFrames(actual, frames);
+    ASSERT_EQ(actual.emulator->GetRunAheadStats().framesRun, frames * 2u);
+
+    // The frames ahead were undone, so the real frames ran the same, ended on the same clocks, and had the same state
+    // at the end of every frame.
+    ASSERT_EQ(actualClocks, expectedClocks);
+    ASSERT_EQ(actual.GetSnapshot(), expected.GetSnapshot());
+    ASSERT_TRUE(actual.emulator->StopStateHashing());
+    ASSERT_TRUE(expected.emulator->StopStateHashing());
+    ASSERT_EQ(ReadFile(actual.GetFilename(".hash")), ReadFile(expected.GetFilename(".hash")));
+
+    // Nothing the frames ahead sent reached the outputs.
+    ASSERT_EQ(actual.serialOutput.size(), frames);
+    ASSERT_EQ(actual.serialOutput, expected.serialOutput);
+    ASSERT_FALSE(actual.audioOutput.empty());
+    ASSERT_EQ(actual.audioOutput, expected.audioOutput);
+
+    // The game counted each real frame once.
+    ASSERT_EQ(actual.ReadMemory(actual.GetSnapshot(), 0xC000), frames);
+}
+
+TEST_F(EmulatorMgrTest, TEST_LoadSnapshotLikeSaveState)
+{
+    TestEmulator emulator("load_snapshot");
+    emulator.emulator->SetRewindBuffer(1024 * 1024);
+    ASSERT_TRUE(emulator.LoadRom(frameCounterRom));
+
+    emulator.emulator->Run(0, 5);
+    const std::vector<uint8_t> snapshot = emulator.GetSnapshot();
+    emulator.emulator->Run(0, 5);
+    ASSERT_TRUE(emulator.emulator->RewindFrame());
+
+    // The loaded frame is shown, and there is no history to rewind into from before the load.
+    const uint64_t framesReady = emulator.framesReady;
+    ASSERT_TRUE(emulator.emulator->LoadSnapshot(snapshot.data(), snapshot.size()));
+    ASSERT_EQ(emulator.framesReady, framesReady + 1);
+    ASSERT_FALSE(emulator.emulator->RewindFrame());
+
+    // A movie being recorded is stopped and saved.
+    const std::string movieFilename = emulator.GetFilename(".movie");
+    ASSERT_TRUE(emulator.emulator->StartMovieRecording(movieFilename, false));
+    emulator.emulator->Run(0, 5);
+    ASSERT_TRUE(emulator.emulator->LoadSnapshot(snapshot.data(), snapshot.size()));
+    ASSERT_FALSE(emulator.emulator->IsMovieRecording());
+    ASSERT_FALSE(ReadFile(movieFilename).empty());
+}
+
+
+TEST_F(EmulatorMgrTest, TEST_ConvertOldSaveStates)
+{
+    // An MBC1 game with 4 banks, so the mapped bank can't be guessed.
+    std::vector<uint8_t> rom = TestEmulator::MakeRom({0x00, 0x18, 0xFD}, 0x01, 0x01);
+
+    for (uint16_t version : {1, 2})
+    {
+        SCOPED_TRACE(version);
+
+        TestEmulator emulator("convert_state");
+        ASSERT_TRUE(emulator.LoadRom(rom));
+
+        const std::vector<uint8_t> state = MakeOldSaveState(version, rom, 0x1234, 0x56);
+        ASSERT_FALSE(state.empty());
+        const std::string filename = emulator.GetFilename(".sav");
+        std::ofstream file(filename, std::ios::binary);
+        file.write(reinterpret_cast<const char *>(state.data()), state.size());
+        file.close();
+
+        ASSERT_TRUE(emulator.emulator->LoadStateFromFile(filename));
+        ASSERT_TRUE(emulator.messages.empty());
+
+        // The game carries on with its registers, its memory, and the ROM bank it had mapped.
+        const std::vector<uint8_t> snapshot = emulator.GetSnapshot();
+        ASSERT_EQ(emulator.ReadMemory(snapshot, 0xC000), 0x77);
+        ASSERT_EQ(emulator.ReadMemory(snapshot, 0x4000), 2);
+        ASSERT_EQ(emulator.ReadMemory(snapshot, 0x7FFF), 2);
+
+        const Registers registers = TestEmulator::ReadRegisters(snapshot);
+        ASSERT_EQ(registers.pc, 0x1234);
+        ASSERT_EQ(registers.a, 0x56);
+    }
+}
+
+TEST_F(EmulatorMgrTest, TEST_FastForwardRenderInterval)
+{
+    TestEmulator emulator("fast_forward");
+    ASSERT_TRUE(emulator.LoadRom(frameCounterRom));
+
+    // The frame fast-forward starts in isn't drawn, then every 4th frame is.
+    emulator.emulator->SetFastForward(true, 4);
+    emulator.emulator->Run(0, 20);
+    ASSERT_EQ(emulator.framesReady, 4u);
+
+    emulator.emulator->SetFastForward(false);
+    emulator.emulator->Run(0, 5);
+    ASSERT_EQ(emulator.framesReady, 9u);
+}
+
+
+TEST_F(EmulatorMgrTest, TEST_FastForwardEndsMidFrame)
+{
+    TestEmulator emulator("fast_forward_end");
+    ASSERT_TRUE(emulator.LoadRom(frameCounterRom));
+
+    // With an interval of 0, nothing is drawn.
+    emulator.emulator->SetFastForward(true, 0);
+    emulator.emulator->Run(0, 3);
+    ASSERT_EQ(emulator.framesReady, 0u);
+
+    // The frame fast-forward ends in was only partly drawn, so it isn't shown.
+    emulator.emulator->Run(CLOCKS_PER_FRAME / 2, 0);
+    emulator.emulator->SetFastForward(false);
+    emulator.emulator->Run(0, 1);
+    ASSERT_EQ(emulator.framesReady, 0u);
+
+    // The next frame is drawn from its first line. The screen is blank, so every pixel is the same, and none are left
+    // over from the frame buffer before anything was drawn into it.
+    emulator.emulator->Run(0, 1);
+    ASSERT_EQ(emulator.framesReady, 1u);
+    ASSERT_NE(emulator.lastFrame[0], 0u);
+    for (uint32_t pixel : emulator.lastFrame)
+        ASSERT_EQ(pixel, emulator.lastFrame[0]);
+}
\ No newline at end of file
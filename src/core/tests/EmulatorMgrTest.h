@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+class TestEmulator;
+
+class EmulatorMgrTest : public ::testing::Test
+{
+protected:
+    EmulatorMgrTest();
+    ~EmulatorMgrTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+
+    // Runs a frame at a time, pressing A for part of the run. Returns the number of clocks run.
+    uint64_t RunFrames(TestEmulator &emulator, uint frames);
+
+    // Counts frames at 0xC000, and sends the count over the serial port and to sound channel 1 at the start of every
+    // vertical blank. The joypad is read into 0xC001.
+    std::vector<uint8_t> frameCounterRom;
+};
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <thread>
+
+#include "main.h"
+#include "FramePacerTest.h"
+#include "../FramePacer.h"
+
+
+FramePacerTest::FramePacerTest()
+{
+
+}
+
+
+FramePacerTest::~FramePacerTest()
+{
+
+}
+
+
+void FramePacerTest::SetUp()
+{
+
+}
+
+
+void FramePacerTest::TearDown()
+{
+
+}
+
+
+TEST_F(FramePacerTest, TEST_Rate)
+{
+    FramePacer pacer;
+    const int FRAMES = 50;
+    pacer.SetFrameRate(250);
+
+    // Every frame is due 4ms after the one before it, so after the first one starts the schedule, the frames can't
+    // finish early, and rounding in the waits doesn't add up.
+    pacer.WaitForNextFrame();
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FRAMES; i++)
+        pacer.WaitForNextFrame();
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    const double milliseconds = elapsed.count();
+
+    const FramePacer::Stats stats = pacer.GetStats();
+    ASSERT_EQ(stats.frames + stats.lateFrames + stats.resyncs, (uint64_t)FRAMES);
+    ASSERT_GE(milliseconds, FRAMES * 4.0 - 1);
+    // Busy machines can run late, but not by a frame on average.
+    ASSERT_LT(milliseconds, FRAMES * 4.0 * 2);
+}
+
+
+TEST_F(FramePacerTest, TEST_Late)
+{
+    FramePacer pacer;
+    pacer.SetFrameRate(250);
+    pacer.WaitForNextFrame();
+
+    // A frame a little late doesn't wait, so the next ones catch up.
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    pacer.WaitForNextFrame();
+    ASSERT_EQ(pacer.GetStats().lateFrames, 1u);
+    ASSERT_EQ(pacer.GetStats().resyncs, 0u);
+
+    // Falling far behind starts the schedule again, rather than running fast to catch up.
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    pacer.WaitForNextFrame();
+    ASSERT_EQ(pacer.GetStats().resyncs, 1u);
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    pacer.WaitForNextFrame();
+    ASSERT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(3));
+
+    // Uncapped never waits.
+    pacer.SetFrameRate(0);
+    const FramePacer::Stats before = pacer.GetStats();
+    for (int i = 0; i < 1000; i++)
+        pacer.WaitForNextFrame();
+    ASSERT_EQ(pacer.GetStats().frames, before.frames);
+}
\ No newline at end of file
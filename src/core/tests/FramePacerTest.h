@@ -0,0 +1,13 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+class FramePacerTest : public ::testing::Test
+{
+protected:
+    FramePacerTest();
+    ~FramePacerTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+};
\ No newline at end of file
@@ -0,0 +1,293 @@
+#include <fstream>
+#include <iterator>
+#include <thread>
+#include <unistd.h>
+
+#include "main.h"
+#include "LinkTest.h"
+#include "TestEmulator.h"
+#include "../EmulatorMgr.h"
+#include "../Interrupt.h"
+#include "../LinkCable.h"
+#include "../Memory.h"
+#include "../Serial.h"
+#include "../SocketLink.h"
+#include "../Timer.h"
+
+
+LinkTest::LinkTest()
+{
+    cable = new LinkCable(1024);
+
+    for (int i = 0; i < 2; i++)
+    {
+        memory[i] = new Memory;
+        interrupts[i] = new Interrupt(memory[i]);
+        timer[i] = new Timer(memory[i], interrupts[i]);
+        serial[i] = new Serial(memory[i], interrupts[i], timer[i]);
+        serial[i]->SetLinkInterface(cable->GetPort(i));
+    }
+}
+
+
+LinkTest::~LinkTest()
+{
+    for (int i = 0; i < 2; i++)
+    {
+        delete serial[i];
+        delete timer[i];
+        delete interrupts[i];
+        delete memory[i];
+    }
+
+    delete cable;
+}
+
+
+void LinkTest::SetUp()
+{
+
+}
+
+
+void LinkTest::TearDown()
+{
+
+}
+
+
+// Reads a whole file, so files written by two runs can be compared.
+static std::string ReadFile(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+
+// Runs two machines over a SocketLink for the given number of frames, side 0 listening and side 1 connecting. Returns
+// the number of clocks side 0 ran.
+static uint64_t RunSocketLinked(TestEmulator *emulators[2], SocketLink *links[2], uint frames)
+{
+    const std::string address = "/tmp/zlgb_link_test." + std::to_string(getpid());
+
+    for (int i = 0; i < 2; i++)
+        emulators[i]->emulator->SetLinkInterface(links[i]);
+
+    uint64_t clocks = 0;
+    std::thread listenThread([&]()
+    {
+        if (links[0]->Listen(address))
+            clocks = emulators[0]->emulator->Run(0, frames);
+        links[0]->Disconnect();
+    });
+
+    if (links[1]->Connect(address))
+        emulators[1]->emulator->Run(0, frames);
+    links[1]->Disconnect();
+    listenThread.join();
+
+    return clocks;
+}
+
+
+void LinkTest::RunLinked(int cycles)
+{
+    auto run = [this, cycles](int index)
+    {
+        for (int i = 0; i < cycles; i++)
+            timer[index]->AddCycle();
+
+        // Let the other side finish without waiting on this one.
+        cable->Disconnect(index);
+    };
+
+    std::thread thread0(run, 0);
+    std::thread thread1(run, 1);
+    thread0.join();
+    thread1.join();
+}
+
+
+TEST_F(LinkTest, TEST_ByteExchange)
+{
+    // Side 1 waits for a transfer using the external clock.
+    memory[1]->WriteByte(eRegSB, 0x99);
+    memory[1]->WriteByte(eRegSC, 0x80);
+
+    // Side 0 starts a transfer using the internal clock.
+    memory[0]->WriteByte(eRegSB, 0x42);
+    memory[0]->WriteByte(eRegSC, 0x81);
+
+    RunLinked(100000);
+
+    ASSERT_EQ(memory[0]->ReadByte(eRegSB), 0x99);
+    ASSERT_EQ(memory[1]->ReadByte(eRegSB), 0x42);
+
+    for (int i = 0; i < 2; i++)
+    {
+        ASSERT_EQ(memory[i]->ReadByte(eRegSC) & 0x80, 0);
+        ASSERT_NE(memory[i]->ReadByte(eRegIF) & (1 << eIntSerial), 0);
+    }
+
+    LinkCable::Stats stats = cable->GetStats(0);
+    ASSERT_EQ(stats.transfers, 1u);
+    ASSERT_GT(stats.syncs, 0u);
+}
+
+
+TEST_F(LinkTest, TEST_SlaveNotReady)
+{
+    // Side 1 hasn't started a transfer, so nothing is shifted in.
+    memory[1]->WriteByte(eRegSB, 0x99);
+
+    memory[0]->WriteByte(eRegSB, 0x42);
+    memory[0]->WriteByte(eRegSC, 0x81);
+
+    RunLinked(100000);
+
+    ASSERT_EQ(memory[0]->ReadByte(eRegSB), 0xFF);
+    ASSERT_EQ(memory[1]->ReadByte(eRegSB), 0x99);
+}
+
+
+TEST_F(LinkTest, TEST_Disconnected)
+{
+    cable->Disconnect(1);
+
+    memory[0]->WriteByte(eRegSB, 0x42);
+    memory[0]->WriteByte(eRegSC, 0x81);
+
+    for (int i = 0; i < 1000; i++)
+        timer[0]->AddCycle();
+
+    ASSERT_EQ(memory[0]->ReadByte(eRegSB), 0xFF);
+    ASSERT_EQ(memory[0]->ReadByte(eRegSC) & 0x80, 0);
+}
+
+
+TEST_F(LinkTest, TEST_SocketByteExchange)
+{
+    SocketLink links[2];
+    const std::string address = "/tmp/zlgb_link_test." + std::to_string(getpid());
+
+    bool listening = false;
+    std::thread listenThread([&]() {listening = links[0].Listen(address);});
+    ASSERT_TRUE(links[1].Connect(address));
+    listenThread.join();
+    ASSERT_TRUE(listening);
+
+    memory[1]->WriteByte(eRegSB, 0x99);
+    memory[1]->WriteByte(eRegSC, 0x80);
+    memory[0]->WriteByte(eRegSB, 0x42);
+    memory[0]->WriteByte(eRegSC, 0x81);
+
+    auto run = [&](int index)
+    {
+        serial[index]->SetLinkInterface(&links[index]);
+        for (int i = 0; i < 100000; i++)
+            timer[index]->AddCycle();
+        links[index].Disconnect();
+    };
+
+    std::thread thread0(run, 0);
+    std::thread thread1(run, 1);
+    thread0.join();
+    thread1.join();
+
+    ASSERT_EQ(memory[0]->ReadByte(eRegSB), 0x99);
+    ASSERT_EQ(memory[1]->ReadByte(eRegSB), 0x42);
+
+    SocketLink::Stats stats = links[0].GetStats();
+    ASSERT_EQ(stats.transfers, 1u);
+    ASSERT_EQ(stats.predictions, 0u);
+}
+
+
+TEST_F(LinkTest, TEST_SocketRollback)
+{
+    // The master waits a little, sends 0x11 using the internal clock, waits for the transfer to finish, and copies SB
+    // to 0xC000.
+    const std::vector<uint8_t> masterRom = TestEmulator::MakeRom({
+        0x06, 0x00,        // LD B, 0
+        0x05,              // DEC B
+        0x20, 0xFD,        // JR NZ, -3
+        0x3E, 0x11,        // LD A, 0x11
+        0xE0, 0x01,        // LDH (SB), A
+        0x3E, 0x81,        // LD A, 0x81
+        0xE0, 0x02,        // LDH (SC), A
+        0xF0, 0x02,        // LDH A, (SC)
+        0xCB, 0x7F,        // BIT 7, A
+        0x20, 0xFA,        // JR NZ, -6
+        0xF0, 0x01,        // LDH A, (SB)
+        0xEA, 0x00, 0xC0,  // LD (0xC000), A
+        0x00,              // NOP
+        0x18, 0xFD         // JR -3
+    });
+
+    // The slave waits for a transfer using the external clock, with 0x42 in SB.
+    const std::vector<uint8_t> slaveRom = TestEmulator::MakeRom({
+        0x3E, 0x42,        // LD A, 0x42
+        0xE0, 0x01,        // LDH (SB), A
+        0x3E, 0x80,        // LD A, 0x80
+        0xE0, 0x02,        // LDH (SC), A
+        0x00,              // NOP
+        0x18, 0xFD         // JR -3
+    });
+
+    // The master only hears back at quantum boundaries, so a quantum of several frames makes the rollback undo frames
+    // that were already recorded.
+    const uint quantum = CLOCKS_PER_FRAME * 4;
+    const uint frames = 30;
+
+    TestEmulator expected("link_expected"), expectedSlave("link_expected_slave");
+    TestEmulator actual("link_actual"), actualSlave("link_actual_slave");
+    SocketLink expectedLink(quantum, false), expectedSlaveLink(quantum, false);
+    SocketLink actualLink(quantum, true), actualSlaveLink(quantum, true);
+
+    for (TestEmulator *emulator : {&expected, &actual})
+    {
+        ASSERT_TRUE(emulator->LoadRom(masterRom));
+        ASSERT_TRUE(emulator->emulator->StartMovieRecording(emulator->GetFilename(".movie"), true));
+        ASSERT_TRUE(emulator->emulator->StartStateHashing(emulator->GetFilename(".hash")));
+    }
+    ASSERT_TRUE(expectedSlave.LoadRom(slaveRom));
+    ASSERT_TRUE(actualSlave.LoadRom(slaveRom));
+
+    // Without rollback, the master waits for the reply, so this is what the run with rollback has to end up as.
+    TestEmulator *expectedSides[2] = {&expected, &expectedSlave};
+    SocketLink *expectedLinks[2] = {&expectedLink, &expectedSlaveLink};
+    const uint64_t expectedClocks = RunSocketLinked(expectedSides, expectedLinks, frames);
+    ASSERT_EQ(expectedLink.GetStats().predictions, 0u);
+
+    // With rollback, the master predicts 0xFF, the reply it starts out with, and the slave replies 0x42.
+    TestEmulator *actualSides[2] = {&actual, &actualSlave};
+    SocketLink *actualLinks[2] = {&actualLink, &actualSlaveLink};
+    const uint64_t actualClocks = RunSocketLinked(actualSides, actualLinks, frames);
+    SocketLink::Stats stats = actualLink.GetStats();
+    ASSERT_EQ(stats.predictions, 1u);
+    ASSERT_EQ(stats.rollbacks, 1u);
+
+    // The frames after the transfer were drawn twice.
+    ASSERT_GT(actual.framesReady, expected.framesReady);
+
+    // SB holds the byte the slave really sent, and the game carried on with it.
+    const std::vector<uint8_t> snapshot = actual.GetSnapshot();
+    ASSERT_EQ(actual.ReadMemory(snapshot, eRegSB), 0x42);
+    ASSERT_EQ(actual.ReadMemory(snapshot, 0xC000), 0x42);
+    ASSERT_EQ(actual.serialOutput, std::vector<uint8_t>{0x11});
+    ASSERT_EQ(actual.serialOutput, expected.serialOutput);
+
+    // The frame and clock counts went back to the checkpoint, so the run ends on the same clock.
+    ASSERT_EQ(actualClocks, expectedClocks);
+    ASSERT_EQ(snapshot, expected.GetSnapshot());
+
+    // The re-run frames replaced the ones recorded before the rollback, instead of being added after them.
+    ASSERT_EQ(actual.emulator->GetMovieFrameCount(), frames);
+    ASSERT_TRUE(actual.emulator->StopMovie());
+    ASSERT_TRUE(expected.emulator->StopMovie());
+    ASSERT_EQ(ReadFile(actual.GetFilename(".movie")), ReadFile(expected.GetFilename(".movie")));
+
+    ASSERT_TRUE(actual.emulator->StopStateHashing());
+    ASSERT_TRUE(expected.emulator->StopStateHashing());
+    ASSERT_EQ(ReadFile(actual.GetFilename(".hash")), ReadFile(expected.GetFilename(".hash")));
+}
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+class Interrupt;
+class LinkCable;
+class Memory;
+class Serial;
+class Timer;
+
+class LinkTest : public ::testing::Test
+{
+protected:
+    LinkTest();
+    ~LinkTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+
+    // Runs both sides on their own threads for the given number of cycles.
+    void RunLinked(int cycles);
+
+    LinkCable *cable;
+    Memory *memory[2];
+    Interrupt *interrupts[2];
+    Timer *timer[2];
+    Serial *serial[2];
+};
\ No newline at end of file
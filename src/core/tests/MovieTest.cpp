@@ -0,0 +1,130 @@
+#include <fstream>
+#include <unistd.h>
+
+#include "main.h"
+#include "MovieTest.h"
+#include "../Movie.h"
+
+
+MovieTest::MovieTest() :
+    filename("/tmp/zlgb_movie_test." + std::to_string(getpid()))
+{
+
+}
+
+
+MovieTest::~MovieTest()
+{
+
+}
+
+
+void MovieTest::SetUp()
+{
+
+}
+
+
+void MovieTest::TearDown()
+{
+    unlink(filename.c_str());
+}
+
+
+TEST_F(MovieTest, TEST_RoundTrip)
+{
+    std::vector<uint8_t> state(1000);
+    for (size_t i = 0; i < state.size(); i++)
+        state[i] = i % 3;
+
+    Movie recording;
+    recording.StartRecording(state, 0x1234, true);
+    for (uint frame = 0; frame < 1000; frame++)
+        recording.RecordFrame(frame / 100 % 2 ? 0x81 : 0x00);
+    ASSERT_EQ(recording.GetFrameCount(), 1000u);
+    ASSERT_TRUE(recording.Save(filename));
+
+    // Buttons are stored once per change, not once per frame.
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    ASSERT_LT((size_t)file.tellg(), sizeof(MovieHeader) + state.size() / 2);
+
+    Movie playback;
+    ASSERT_TRUE(playback.Load(filename));
+    ASSERT_EQ(playback.GetStartState(), state);
+    ASSERT_EQ(playback.GetRomHash(), 0x1234u);
+    ASSERT_TRUE(playback.IsFromPowerOn());
+    ASSERT_EQ(playback.GetFrameCount(), 1000u);
+
+    for (uint frame = 0; frame < 1000; frame++)
+    {
+        uint8_t buttons;
+        ASSERT_TRUE(playback.PlayFrame(buttons));
+        ASSERT_EQ(buttons, frame / 100 % 2 ? 0x81 : 0x00);
+    }
+
+    uint8_t buttons;
+    ASSERT_FALSE(playback.PlayFrame(buttons));
+}
+
+
+TEST_F(MovieTest, TEST_Corrupt)
+{
+    Movie recording;
+    recording.StartRecording(std::vector<uint8_t>(100), 0, false);
+    recording.RecordFrame(0x01);
+    recording.RecordFrame(0x02);
+    ASSERT_TRUE(recording.Save(filename));
+
+    std::ifstream file(filename, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // A movie cut off anywhere is rejected.
+    Movie playback;
+    for (size_t size = 0; size < data.size(); size++)
+    {
+        std::ofstream truncated(filename, std::ios::binary | std::ios::trunc);
+        truncated.write(data.data(), size);
+        truncated.close();
+        ASSERT_FALSE(playback.Load(filename));
+    }
+
+    ASSERT_FALSE(playback.Load(filename + ".missing"));
+}
+
+TEST_F(MovieTest, TEST_Unrecord)
+{
+    Movie recording;
+    recording.StartRecording(std::vector<uint8_t>(100), 0, false);
+    for (uint frame = 0; frame < 10; frame++)
+        recording.RecordFrame(frame < 5 ? 0x01 : 0x02);
+
+    // Taking back frames across a change of buttons, then recording different ones.
+    recording.UnrecordFrames(7);
+    ASSERT_EQ(recording.GetFrameCount(), 3u);
+    recording.RecordFrame(0x04);
+    ASSERT_TRUE(recording.Save(filename));
+
+    Movie playback;
+    ASSERT_TRUE(playback.Load(filename));
+    ASSERT_EQ(playback.GetFrameCount(), 4u);
+
+    const uint8_t expected[] = {0x01, 0x01, 0x01, 0x04};
+    uint8_t buttons;
+    for (uint8_t value : expected)
+    {
+        ASSERT_TRUE(playback.PlayFrame(buttons));
+        ASSERT_EQ(buttons, value);
+    }
+    ASSERT_FALSE(playback.PlayFrame(buttons));
+
+    // Going back past the start of the movie stops at the first frame.
+    playback.UnplayFrames(3);
+    ASSERT_TRUE(playback.PlayFrame(buttons));
+    ASSERT_EQ(buttons, 0x01);
+    playback.UnplayFrames(10);
+    for (uint8_t value : expected)
+    {
+        ASSERT_TRUE(playback.PlayFrame(buttons));
+        ASSERT_EQ(buttons, value);
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+class MovieTest : public ::testing::Test
+{
+protected:
+    MovieTest();
+    ~MovieTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+
+    std::string filename;
+};
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "main.h"
+#include "PaletteTest.h"
+#include "../Palette.h"
+
+
+PaletteTest::PaletteTest()
+{
+
+}
+
+
+PaletteTest::~PaletteTest()
+{
+
+}
+
+
+void PaletteTest::SetUp()
+{
+
+}
+
+
+void PaletteTest::TearDown()
+{
+
+}
+
+
+TEST_F(PaletteTest, TEST_Register)
+{
+    Palette palette;
+
+    // Index 0 is the lowest 2 bits of the register.
+    palette.SetRegister(0xE4);
+    EXPECT_EQ(palette.GetColors()[0], 0xFFFFFFu);
+    EXPECT_EQ(palette.GetColors()[1], 0xB0B0B0u);
+    EXPECT_EQ(palette.GetColors()[2], 0x686868u);
+    EXPECT_EQ(palette.GetColors()[3], 0x000000u);
+
+    palette.SetRegister(0x1B);
+    EXPECT_EQ(palette.GetColors()[0], 0x000000u);
+    EXPECT_EQ(palette.GetColors()[1], 0x686868u);
+    EXPECT_EQ(palette.GetColors()[2], 0xB0B0B0u);
+    EXPECT_EQ(palette.GetColors()[3], 0xFFFFFFu);
+}
+
+
+TEST_F(PaletteTest, TEST_Shades)
+{
+    Palette palette;
+    palette.SetRegister(0x1B);
+
+    // Changing the shades keeps the register.
+    palette.SetShades(Palette::eShadesGreen);
+    for (uint i = 0; i < 4; i++)
+        EXPECT_EQ(palette.GetColors()[i], palette.GetShadeColor(3 - i));
+    EXPECT_NE(palette.GetShadeColor(0), 0xFFFFFFu);
+
+    palette.SetShades(Palette::eShadesGray);
+    EXPECT_EQ(palette.GetColors()[0], 0x000000u);
+    EXPECT_EQ(palette.GetColors()[3], 0xFFFFFFu);
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+class PaletteTest : public ::testing::Test
+{
+protected:
+    PaletteTest();
+    ~PaletteTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+};
\ No newline at end of file
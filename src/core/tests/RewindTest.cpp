@@ -0,0 +1,130 @@
+#include "main.h"
+#include "RewindTest.h"
+#include "../RewindBuffer.h"
+
+
+RewindTest::RewindTest()
+{
+
+}
+
+
+RewindTest::~RewindTest()
+{
+
+}
+
+
+void RewindTest::SetUp()
+{
+
+}
+
+
+void RewindTest::TearDown()
+{
+
+}
+
+
+std::vector<uint8_t> RewindTest::MakeSnapshot(uint frame)
+{
+    std::vector<uint8_t> snapshot(SNAPSHOT_SIZE);
+
+    // Mostly constant data, like ROM banks and unused RAM.
+    for (size_t i = 0; i < SNAPSHOT_SIZE; i++)
+        snapshot[i] = (i * 7) & 0xFF;
+
+    // A frame counter, and some bytes that move around from frame to frame.
+    snapshot[0] = frame & 0xFF;
+    snapshot[1] = frame >> 8;
+    for (uint i = 0; i < 16; i++)
+        snapshot[(frame * 37 + i * 101) % SNAPSHOT_SIZE] ^= frame + i;
+
+    return snapshot;
+}
+
+
+TEST_F(RewindTest, TEST_StepBack)
+{
+    RewindBuffer rewind(1024 * 1024, 4);
+    rewind.Reset(SNAPSHOT_SIZE);
+
+    const uint frameCount = 10;
+    for (uint frame = 0; frame < frameCount; frame++)
+    {
+        std::vector<uint8_t> snapshot = MakeSnapshot(frame);
+        memcpy(rewind.BeginCapture(), snapshot.data(), SNAPSHOT_SIZE);
+        rewind.EndCapture();
+    }
+
+    RewindBuffer::Stats stats = rewind.GetStats();
+    ASSERT_EQ(stats.frames, frameCount);
+    ASSERT_EQ(stats.captures, frameCount);
+
+    // Step back across deltas and keyframes, down to the first frame.
+    for (uint frame = frameCount - 1; frame-- > 0;)
+    {
+        const uint8_t *snapshot = rewind.StepBack();
+        ASSERT_NE(snapshot, nullptr);
+        ASSERT_EQ(MakeSnapshot(frame), std::vector<uint8_t>(snapshot, snapshot + SNAPSHOT_SIZE));
+    }
+
+    ASSERT_EQ(rewind.StepBack(), nullptr);
+}
+
+
+TEST_F(RewindTest, TEST_CaptureAfterStepBack)
+{
+    RewindBuffer rewind(1024 * 1024, 4);
+    rewind.Reset(SNAPSHOT_SIZE);
+
+    for (uint frame = 0; frame < 6; frame++)
+    {
+        std::vector<uint8_t> snapshot = MakeSnapshot(frame);
+        memcpy(rewind.BeginCapture(), snapshot.data(), SNAPSHOT_SIZE);
+        rewind.EndCapture();
+    }
+
+    // Go back two frames, then capture a different future.
+    rewind.StepBack();
+    rewind.StepBack();
+    std::vector<uint8_t> snapshot = MakeSnapshot(100);
+    memcpy(rewind.BeginCapture(), snapshot.data(), SNAPSHOT_SIZE);
+    rewind.EndCapture();
+
+    const uint8_t *previous = rewind.StepBack();
+    ASSERT_NE(previous, nullptr);
+    ASSERT_EQ(MakeSnapshot(3), std::vector<uint8_t>(previous, previous + SNAPSHOT_SIZE));
+}
+
+
+TEST_F(RewindTest, TEST_BoundedMemory)
+{
+    const size_t capacity = 16 * 1024;
+    RewindBuffer rewind(capacity, 8);
+    rewind.Reset(SNAPSHOT_SIZE);
+
+    const uint frameCount = 1000;
+    for (uint frame = 0; frame < frameCount; frame++)
+    {
+        std::vector<uint8_t> snapshot = MakeSnapshot(frame);
+        memcpy(rewind.BeginCapture(), snapshot.data(), SNAPSHOT_SIZE);
+        rewind.EndCapture();
+        ASSERT_LE(rewind.GetStats().bytesUsed, capacity);
+    }
+
+    // Old frames were dropped, and the ones that are left are still correct.
+    RewindBuffer::Stats stats = rewind.GetStats();
+    ASSERT_LT(stats.frames, frameCount);
+    ASSERT_GT(stats.frames, 8u);
+
+    for (uint frame = frameCount - 1; frame > frameCount - stats.frames; frame--)
+    {
+        const uint8_t *snapshot = rewind.StepBack();
+        ASSERT_NE(snapshot, nullptr);
+        ASSERT_EQ(MakeSnapshot(frame - 1), std::vector<uint8_t>(snapshot, snapshot + SNAPSHOT_SIZE));
+    }
+
+    ASSERT_EQ(rewind.StepBack(), nullptr);
+}
\ No newline at end of file
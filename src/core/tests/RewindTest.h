@@ -0,0 +1,20 @@
+#pragma once
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+class RewindTest : public ::testing::Test
+{
+protected:
+    RewindTest();
+    ~RewindTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+
+    // Returns a snapshot for the given frame, where a few bytes change every frame.
+    std::vector<uint8_t> MakeSnapshot(uint frame);
+
+    static const size_t SNAPSHOT_SIZE = 4096;
+};
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include <random>
+#include <vector>
+
+#include "main.h"
+#include "ScanlineCompositorTest.h"
+#include "../ScanlineCompositor.h"
+
+
+ScanlineCompositorTest::ScanlineCompositorTest()
+{
+
+}
+
+
+ScanlineCompositorTest::~ScanlineCompositorTest()
+{
+
+}
+
+
+void ScanlineCompositorTest::SetUp()
+{
+
+}
+
+
+void ScanlineCompositorTest::TearDown()
+{
+
+}
+
+
+TEST_F(ScanlineCompositorTest, TEST_Versions)
+{
+    ASSERT_TRUE(ScanlineCompositor::IsSupported(ScanlineCompositor::GetBestVersion()));
+
+    std::mt19937 random(1);
+    std::vector<uint8_t> indices(200);
+    for (uint8_t &index : indices)
+        index = random() & 0x03;
+    const uint32_t colors[4] = {0x00FFFFFF, 0x00B0B0B0, 0x00686868, 0x00000000};
+
+    // Every supported version gives the same pixels as the scalar one, for any length and alignment.
+    for (int version = 0; version < ScanlineCompositor::eVersionCount; version++)
+    {
+        ScanlineCompositor::ApplyPaletteFunc applyPalette =
+            ScanlineCompositor::GetApplyPalette(static_cast<ScanlineCompositor::Version>(version));
+        if (applyPalette == NULL)
+            continue;
+
+        for (uint start = 0; start < 4; start++)
+        {
+            for (uint count = 0; count <= 160; count++)
+            {
+                std::vector<uint32_t> pixels(count + 2, 0xDEADBEEF);
+                applyPalette(&indices[start], colors, &pixels[1], count);
+
+                ASSERT_EQ(pixels[0], 0xDEADBEEF);
+                ASSERT_EQ(pixels[count + 1], 0xDEADBEEF);
+                for (uint i = 0; i < count; i++)
+                    ASSERT_EQ(pixels[i + 1], colors[indices[start + i]]) << "version " << version << " count " << count;
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+class ScanlineCompositorTest : public ::testing::Test
+{
+protected:
+    ScanlineCompositorTest();
+    ~ScanlineCompositorTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+};
\ No newline at end of file
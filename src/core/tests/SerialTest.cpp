@@ -0,0 +1,85 @@
+#include "main.h"
+#include "SerialTest.h"
+#include "../Interrupt.h"
+#include "../Memory.h"
+#include "../Serial.h"
+#include "../SerialBuffer.h"
+#include "../Timer.h"
+
+
+SerialTest::SerialTest()
+{
+    memory = new Memory;
+    interrupts = new Interrupt(memory);
+    timer = new Timer(memory, interrupts);
+    serialBuffer = new SerialBuffer;
+    serial = new Serial(memory, interrupts, timer, serialBuffer);
+}
+
+
+SerialTest::~SerialTest()
+{
+    delete serial;
+    delete serialBuffer;
+    delete timer;
+    delete interrupts;
+    delete memory;
+}
+
+
+void SerialTest::SetUp()
+{
+    serialBuffer->Clear();
+}
+
+
+void SerialTest::TearDown()
+{
+
+}
+
+
+void SerialTest::SendByte(uint8_t byte)
+{
+    memory->WriteByte(eRegSB, byte);
+    memory->WriteByte(eRegSC, 0x81);
+
+    // A transfer takes 8 bits at 8 cycles per bit.
+    serial->UpdateTimer(8 * 8 * 4);
+}
+
+
+TEST_F(SerialTest, TEST_SentBytesReachInterface)
+{
+    SendByte('O');
+    SendByte('K');
+
+    ASSERT_EQ(serialBuffer->GetOutput(), "OK");
+
+    // Transfer start flag is cleared, and 0xFF is shifted in since nothing is connected.
+    ASSERT_EQ(memory->ReadByte(eRegSC) & 0x80, 0);
+    ASSERT_EQ(memory->ReadByte(eRegSB), 0xFF);
+}
+
+
+TEST_F(SerialTest, TEST_PatternCallback)
+{
+    std::vector<std::string> matches;
+    size_t matchLength = 0;
+    serialBuffer->AddPattern("Passed", [&](const std::string &pattern)
+    {
+        matches.push_back(pattern);
+        matchLength = serialBuffer->GetOutput().size();
+    });
+    serialBuffer->AddPattern("Failed", [&](const std::string &pattern) {matches.push_back(pattern);});
+
+    for (char c : std::string("Test\nPass"))
+        SendByte(c);
+    ASSERT_TRUE(matches.empty());
+
+    // The callback fires on the byte that completes the pattern.
+    for (char c : std::string("ed\n"))
+        SendByte(c);
+    ASSERT_EQ(matches, std::vector<std::string>{"Passed"});
+    ASSERT_EQ(matchLength, 11u);
+}
\ No newline at end of file
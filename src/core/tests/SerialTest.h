@@ -0,0 +1,27 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+class Interrupt;
+class Memory;
+class Serial;
+class SerialBuffer;
+class Timer;
+
+class SerialTest : public ::testing::Test
+{
+protected:
+    SerialTest();
+    ~SerialTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+
+    void SendByte(uint8_t byte);
+
+    Memory *memory;
+    Interrupt *interrupts;
+    Timer *timer;
+    SerialBuffer *serialBuffer;
+    Serial *serial;
+};
\ No newline at end of file
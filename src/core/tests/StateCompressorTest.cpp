@@ -0,0 +1,109 @@
+#include <stdlib.h>
+
+#include "main.h"
+#include "StateCompressorTest.h"
+#include "../StateCompressor.h"
+
+
+StateCompressorTest::StateCompressorTest()
+{
+
+}
+
+
+StateCompressorTest::~StateCompressorTest()
+{
+
+}
+
+
+void StateCompressorTest::SetUp()
+{
+
+}
+
+
+void StateCompressorTest::TearDown()
+{
+
+}
+
+
+size_t StateCompressorTest::RoundTrip(const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> compressed;
+    StateCompressor::Compress(data.data(), data.size(), compressed);
+    EXPECT_TRUE(StateCompressor::IsCompressed(compressed.data(), compressed.size()));
+
+    std::vector<uint8_t> decompressed;
+    EXPECT_TRUE(StateCompressor::Decompress(compressed.data(), compressed.size(), decompressed));
+    EXPECT_EQ(decompressed, data);
+
+    return compressed.size();
+}
+
+
+TEST_F(StateCompressorTest, TEST_RoundTrip)
+{
+    RoundTrip(std::vector<uint8_t>());
+    RoundTrip(std::vector<uint8_t>(3, 0));
+    RoundTrip(std::vector<uint8_t>(3, 0x55));
+
+    // Random bytes don't compress, but only grow by a little.
+    std::vector<uint8_t> data(0x4000);
+    srand(1);
+    for (uint8_t &byte : data)
+        byte = rand();
+    ASSERT_LT(RoundTrip(data), data.size() + 32);
+
+    // Mix in runs of zeros, and repeats of earlier bytes, including ones that overlap themselves.
+    for (size_t i = 0x1000; i < 0x1800; i++)
+        data[i] = 0;
+    for (size_t i = 0x2000; i < 0x2800; i++)
+        data[i] = data[i - 0x1F00];
+    for (size_t i = 0x3000; i < 0x3800; i++)
+        data[i] = data[i - 3];
+    ASSERT_LT(RoundTrip(data), data.size() * 3 / 4);
+}
+
+
+TEST_F(StateCompressorTest, TEST_Ratio)
+{
+    // Memory that is mostly zeros, with the same few tiles repeated.
+    std::vector<uint8_t> data(0x10000);
+    for (size_t i = 0; i < 0x1800; i++)
+        data[0x8000 + i] = (i % 48) * 5;
+    for (size_t i = 0; i < 0x400; i++)
+        data[0x9800 + i] = i % 3;
+
+    ASSERT_LT(RoundTrip(data), data.size() / 10);
+}
+
+
+TEST_F(StateCompressorTest, TEST_Corrupt)
+{
+    std::vector<uint8_t> data(0x1000);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = i % 7 ? 0 : i;
+
+    std::vector<uint8_t> compressed;
+    StateCompressor::Compress(data.data(), data.size(), compressed);
+
+    // Uncompressed data isn't mistaken for compressed data.
+    std::vector<uint8_t> decompressed;
+    ASSERT_FALSE(StateCompressor::IsCompressed(data.data(), data.size()));
+    ASSERT_FALSE(StateCompressor::Decompress(data.data(), data.size(), decompressed));
+
+    // Truncated data fails instead of reading past the end.
+    for (size_t size = 0; size < compressed.size(); size++)
+        ASSERT_FALSE(StateCompressor::Decompress(compressed.data(), size, decompressed));
+
+    // So does a match from before the start of the data.
+    const uint8_t badMatch[] = {'Z', 'L', 'G', 'Z', 8, 0, 0, 0, 8 << 2 | 2, 1};
+    ASSERT_FALSE(StateCompressor::Decompress(badMatch, sizeof(badMatch), decompressed));
+
+    // A size too large for any snapshot is rejected before anything is allocated for it.
+    const uint8_t hugeSize[] = {'Z', 'L', 'G', 'Z', 0xFF, 0xFF, 0xFF, 0xFF, 4 << 2 | 1};
+    ASSERT_FALSE(StateCompressor::Decompress(hugeSize, sizeof(hugeSize), decompressed));
+    ASSERT_LE(decompressed.capacity(), data.size());
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+class StateCompressorTest : public ::testing::Test
+{
+protected:
+    StateCompressorTest();
+    ~StateCompressorTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+
+    // Compresses data, checks it decompresses to the same bytes, and returns the compressed size.
+    size_t RoundTrip(const std::vector<uint8_t> &data);
+};
\ No newline at end of file
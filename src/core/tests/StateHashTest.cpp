@@ -0,0 +1,165 @@
+#include <set>
+#include <unistd.h>
+
+#include "main.h"
+#include "StateHashTest.h"
+#include "../StateHash.h"
+
+
+StateHashTest::StateHashTest() :
+    filename("/tmp/zlgb_state_hash_test." + std::to_string(getpid()))
+{
+
+}
+
+
+StateHashTest::~StateHashTest()
+{
+
+}
+
+
+void StateHashTest::SetUp()
+{
+
+}
+
+
+void StateHashTest::TearDown()
+{
+    unlink(filename.c_str());
+}
+
+
+// Writes a snapshot with a chunk for each tag, holding size bytes of value.
+static std::vector<uint8_t> MakeChunks(const std::vector<std::string> &tags, size_t size, uint8_t value)
+{
+    StateWriter counter(NULL, 0);
+    std::vector<uint8_t> data(size, value);
+    for (const std::string &tag : tags)
+    {
+        size_t chunkStart;
+        counter.BeginChunk(tag.c_str(), chunkStart);
+        counter.Write(data.data(), data.size());
+    }
+
+    std::vector<uint8_t> snapshot(counter.GetSize());
+    StateWriter writer(snapshot.data(), snapshot.size());
+    for (const std::string &tag : tags)
+    {
+        size_t chunkStart;
+        writer.BeginChunk(tag.c_str(), chunkStart);
+        writer.Write(data.data(), data.size());
+        writer.EndChunk(chunkStart);
+    }
+
+    return snapshot;
+}
+
+
+TEST_F(StateHashTest, TEST_Hash)
+{
+    std::vector<uint8_t> data(100);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = i * 7;
+
+    // Every length, and a flip of every bit, gives a different hash. That covers the stripes, words, and bytes at the
+    // end, which are hashed differently.
+    std::set<uint64_t> hashes;
+    for (size_t size = 0; size <= data.size(); size++)
+        hashes.insert(HashStateData(data.data(), size));
+    ASSERT_EQ(hashes.size(), data.size() + 1);
+
+    const uint64_t hash = HashStateData(data.data(), data.size());
+    ASSERT_EQ(HashStateData(data.data(), data.size()), hash);
+
+    for (size_t i = 0; i < data.size() * 8; i++)
+    {
+        data[i / 8] ^= 1 << (i % 8);
+        hashes.insert(HashStateData(data.data(), data.size()));
+        data[i / 8] ^= 1 << (i % 8);
+    }
+    ASSERT_EQ(hashes.size(), data.size() * 9 + 1);
+
+    // Zeros don't cancel out.
+    std::vector<uint8_t> zeros(64);
+    ASSERT_NE(HashStateData(zeros.data(), 32), HashStateData(zeros.data(), 64));
+}
+
+
+TEST_F(StateHashTest, TEST_RoundTrip)
+{
+    const std::vector<std::string> tags = {"ONE ", "TWO ", "MISS"};
+
+    StateHashRecorder recorder;
+    ASSERT_TRUE(recorder.Open(filename, tags));
+
+    // A chunk that isn't in the tags is skipped, and one that's missing is 0.
+    const std::vector<uint8_t> first = MakeChunks({"ONE ", "XTRA", "TWO "}, 1000, 0);
+    const std::vector<uint8_t> second = MakeChunks({"ONE ", "XTRA", "TWO "}, 1000, 1);
+    recorder.Record(10, StateReader(first.data(), first.size()));
+    recorder.Record(11, StateReader(second.data(), second.size()));
+    recorder.Record(12, StateReader(first.data(), first.size()));
+    ASSERT_EQ(recorder.GetRecordCount(), 3u);
+    ASSERT_TRUE(recorder.Close());
+
+    StateHashReader reader;
+    ASSERT_TRUE(reader.Open(filename));
+    ASSERT_EQ(reader.GetTags(), tags);
+
+    uint64_t frame;
+    std::vector<uint64_t> hashes[3];
+    for (uint i = 0; i < 3; i++)
+    {
+        ASSERT_TRUE(reader.Next(frame, hashes[i]));
+        ASSERT_EQ(frame, 10 + i);
+        ASSERT_EQ(hashes[i].size(), tags.size());
+        ASSERT_EQ(hashes[i][2], 0u);
+    }
+    ASSERT_FALSE(reader.Next(frame, hashes[0]));
+
+    const std::vector<uint8_t> data(1000, 0);
+    ASSERT_EQ(hashes[0][0], HashStateData(data.data(), data.size()));
+    ASSERT_EQ(hashes[0][0], hashes[0][1]);
+    ASSERT_NE(hashes[0][0], hashes[1][0]);
+    ASSERT_EQ(hashes[0], hashes[2]);
+
+    // A cut off record isn't returned.
+    ASSERT_EQ(truncate(filename.c_str(), sizeof(StateHashHeader) + 4 * tags.size() + 8 * 4 + 5), 0);
+    ASSERT_TRUE(reader.Open(filename));
+    ASSERT_TRUE(reader.Next(frame, hashes[0]));
+    ASSERT_FALSE(reader.Next(frame, hashes[0]));
+
+    ASSERT_EQ(truncate(filename.c_str(), sizeof(StateHashHeader) + 2), 0);
+    ASSERT_FALSE(reader.Open(filename));
+}
+
+
+TEST_F(StateHashTest, TEST_Truncate)
+{
+    const std::vector<std::string> tags = {"ONE "};
+    const std::vector<uint8_t> chunks = MakeChunks(tags, 100, 0);
+
+    StateHashRecorder recorder;
+    ASSERT_TRUE(recorder.Open(filename, tags));
+    for (uint64_t frame = 0; frame < 5; frame++)
+        recorder.Record(frame, StateReader(chunks.data(), chunks.size()));
+
+    // Frames 3 and 4 are undone and run again.
+    recorder.Truncate(3);
+    ASSERT_EQ(recorder.GetRecordCount(), 3u);
+    recorder.Record(3, StateReader(chunks.data(), chunks.size()));
+    ASSERT_TRUE(recorder.Close());
+
+    StateHashReader reader;
+    ASSERT_TRUE(reader.Open(filename));
+
+    uint64_t frame;
+    std::vector<uint64_t> hashes;
+    for (uint64_t i = 0; i < 4; i++)
+    {
+        ASSERT_TRUE(reader.Next(frame, hashes));
+        ASSERT_EQ(frame, i);
+    }
+    ASSERT_FALSE(reader.Next(frame, hashes));
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+class StateHashTest : public ::testing::Test
+{
+protected:
+    StateHashTest();
+    ~StateHashTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+
+    std::string filename;
+};
\ No newline at end of file
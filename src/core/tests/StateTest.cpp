@@ -0,0 +1,250 @@
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+
+#include "main.h"
+#include "StateTest.h"
+#include "../AsyncStateWriter.h"
+#include "../Cpu.h"
+#include "../DisplayInterface.h"
+#include "../Interrupt.h"
+#include "../Memory.h"
+#include "../StateBuffer.h"
+#include "../StateCompressor.h"
+#include "../Timer.h"
+
+
+// Records save state completions.
+class CompletionRecorder : public DisplayInterface
+{
+public:
+    virtual void FrameReady(const uint32_t *frameBuffer, const ScanlineMask &changedLines)
+    {
+        (void)frameBuffer;
+        (void)changedLines;
+    }
+    virtual void RequestMessageBox(const std::string &message) {(void)message;}
+    virtual void SaveStateComplete(const std::string &filename, bool success)
+    {
+        completed.push_back(std::make_pair(filename, success));
+    }
+
+    std::vector<std::pair<std::string, bool>> completed;
+};
+
+
+StateTest::StateTest()
+{
+    memory = new Memory;
+    interrupts = new Interrupt(memory);
+    timer = new Timer(memory, interrupts);
+    cpu = new Cpu(interrupts, memory, timer);
+
+    // A ROM with no MBC and no RAM.
+    std::vector<uint8_t> gameRomMemory(ROM_BANK_SIZE * 2);
+    memory->SetRomMemory(gameRomMemory);
+}
+
+
+StateTest::~StateTest()
+{
+    delete cpu;
+    delete timer;
+    delete interrupts;
+    delete memory;
+}
+
+
+void StateTest::SetUp()
+{
+
+}
+
+
+void StateTest::TearDown()
+{
+
+}
+
+
+size_t StateTest::SaveState(std::vector<uint8_t> &state)
+{
+    StateWriter writer(state.data(), state.size());
+
+    bool success = true;
+    success &= memory->SaveState(writer);
+    success &= interrupts->SaveState(writer);
+    success &= timer->SaveState(writer);
+    success &= cpu->SaveState(writer);
+
+    return success ? writer.GetSize() : 0;
+}
+
+
+bool StateTest::LoadState(const std::vector<uint8_t> &state, size_t size)
+{
+    StateReader reader(state.data(), size);
+
+    bool success = true;
+    success &= memory->LoadState(3, reader);
+    success &= interrupts->LoadState(3, reader);
+    success &= timer->LoadState(3, reader);
+    success &= cpu->LoadState(3, reader);
+
+    return success;
+}
+
+
+TEST_F(StateTest, TEST_RoundTrip)
+{
+    memory->WriteByte(0xC000, 0x12);
+    cpu->reg.pc = 0x1234;
+    cpu->reg.a = 0x56;
+
+    std::vector<uint8_t> state(MEM_SIZE * 2);
+    size_t size = SaveState(state);
+
+    // ROM isn't saved, so the state is smaller than memory.
+    ASSERT_GT(size, 0u);
+    ASSERT_LT(size, (size_t)MEM_SIZE);
+
+    memory->WriteByte(0xC000, 0x34);
+    cpu->reg.pc = 0x4321;
+    cpu->reg.a = 0x65;
+
+    ASSERT_TRUE(LoadState(state, size));
+    ASSERT_EQ(memory->ReadByte(0xC000), 0x12);
+    ASSERT_EQ(cpu->reg.pc, 0x1234);
+    ASSERT_EQ(cpu->reg.a, 0x56);
+}
+
+
+TEST_F(StateTest, TEST_CountSize)
+{
+    // A writer without a buffer only counts.
+    std::vector<uint8_t> state;
+    StateWriter counter(NULL, 0);
+    memory->SaveState(counter);
+    interrupts->SaveState(counter);
+    timer->SaveState(counter);
+    cpu->SaveState(counter);
+
+    state.resize(counter.GetSize());
+    ASSERT_EQ(SaveState(state), counter.GetSize());
+}
+
+
+TEST_F(StateTest, TEST_BufferTooSmall)
+{
+    std::vector<uint8_t> state(MEM_SIZE * 2);
+    size_t size = SaveState(state);
+
+    // Writing into a buffer that is a byte short fails instead of overflowing.
+    std::vector<uint8_t> smallState(size - 1);
+    ASSERT_EQ(SaveState(smallState), 0u);
+
+    // Reading a truncated state fails too.
+    ASSERT_FALSE(LoadState(state, size - 1));
+}
+
+
+TEST_F(StateTest, TEST_RomBankRestored)
+{
+    // A ROM with MBC1 and four banks, each starting with its bank number.
+    std::vector<uint8_t> gameRomMemory(ROM_BANK_SIZE * 4);
+    gameRomMemory[0x0147] = 0x01;
+    gameRomMemory[0x0148] = 0x01;
+    for (int bank = 1; bank < 4; bank++)
+        gameRomMemory[bank * ROM_BANK_SIZE] = bank;
+
+    memory->SetRomMemory(gameRomMemory);
+    memory->WriteByte(0x2000, 2);
+    ASSERT_EQ(memory->ReadByte(SWITCHABLE_ROM_BANK_OFFSET), 2);
+
+    std::vector<uint8_t> state(MEM_SIZE * 2);
+    size_t size = SaveState(state);
+
+    memory->WriteByte(0x2000, 3);
+    ASSERT_EQ(memory->ReadByte(SWITCHABLE_ROM_BANK_OFFSET), 3);
+
+    // The switchable bank is mapped again from the cartridge.
+    ASSERT_TRUE(LoadState(state, size));
+    ASSERT_EQ(memory->GetCurRomBank(), 2);
+    ASSERT_EQ(memory->ReadByte(SWITCHABLE_ROM_BANK_OFFSET), 2);
+}
+
+
+TEST_F(StateTest, TEST_Chunks)
+{
+    std::vector<uint8_t> state(64);
+    StateWriter writer(state.data(), state.size());
+
+    const uint32_t first = 0x12345678;
+    const uint16_t second = 0x9ABC;
+    size_t chunkStart;
+    ASSERT_TRUE(writer.BeginChunk("ONE ", chunkStart));
+    ASSERT_TRUE(writer.Write(&first, sizeof(first)));
+    writer.EndChunk(chunkStart);
+    ASSERT_TRUE(writer.BeginChunk("TWO ", chunkStart));
+    ASSERT_TRUE(writer.Write(&second, sizeof(second)));
+    writer.EndChunk(chunkStart);
+    ASSERT_EQ(writer.GetSize(), STATE_CHUNK_HEADER_SIZE * 2 + sizeof(first) + sizeof(second));
+
+    // Each chunk reads back on its own, so a reader can skip the ones it doesn't know.
+    StateReader reader(state.data(), writer.GetSize());
+    char tag[STATE_CHUNK_TAG_SIZE];
+    StateReader chunk;
+
+    ASSERT_TRUE(reader.ReadChunk(tag, chunk));
+    ASSERT_EQ(memcmp(tag, "ONE ", STATE_CHUNK_TAG_SIZE), 0);
+    ASSERT_EQ(chunk.GetRemaining(), sizeof(first));
+
+    uint16_t value;
+    ASSERT_TRUE(reader.ReadChunk(tag, chunk));
+    ASSERT_EQ(memcmp(tag, "TWO ", STATE_CHUNK_TAG_SIZE), 0);
+    ASSERT_TRUE(chunk.Read(&value, sizeof(value)));
+    ASSERT_EQ(value, second);
+    ASSERT_FALSE(chunk.Read(&value, sizeof(value)));
+
+    ASSERT_EQ(reader.GetRemaining(), 0u);
+
+    // A chunk cut off by the end of the buffer fails.
+    StateReader truncated(state.data(), writer.GetSize() - 1);
+    ASSERT_TRUE(truncated.ReadChunk(tag, chunk));
+    ASSERT_FALSE(truncated.ReadChunk(tag, chunk));
+}
+
+
+TEST_F(StateTest, TEST_AsyncWrite)
+{
+    std::vector<uint8_t> state(MEM_SIZE * 2);
+    state.resize(SaveState(state));
+
+    const std::string filename = "/tmp/zlgb_state_test." + std::to_string(getpid());
+    const std::string badFilename = "/nonexistent/zlgb_state_test";
+
+    CompletionRecorder recorder;
+    {
+        AsyncStateWriter writer(&recorder, NULL);
+        writer.Write(filename, std::vector<uint8_t>(state));
+        writer.Write(badFilename, std::vector<uint8_t>(state));
+        writer.Flush();
+
+        // Completions are reported in the order the writes were queued.
+        ASSERT_EQ(recorder.completed.size(), 2u);
+        ASSERT_EQ(recorder.completed[0], std::make_pair(filename, true));
+        ASSERT_EQ(recorder.completed[1], std::make_pair(badFilename, false));
+    }
+
+    std::ifstream file(filename, std::ios::binary);
+    std::vector<uint8_t> written((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    unlink(filename.c_str());
+
+    // The file is compressed.
+    std::vector<uint8_t> decompressed;
+    ASSERT_TRUE(StateCompressor::Decompress(written.data(), written.size(), decompressed));
+    ASSERT_LT(written.size(), state.size());
+    ASSERT_EQ(decompressed, state);
+    ASSERT_TRUE(LoadState(decompressed, decompressed.size()));
+}
\ No newline at end of file
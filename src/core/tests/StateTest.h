@@ -0,0 +1,29 @@
+#pragma once
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+class Cpu;
+class Interrupt;
+class Memory;
+class Timer;
+
+class StateTest : public ::testing::Test
+{
+protected:
+    StateTest();
+    ~StateTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+
+    // Saves the state of all objects into state. Returns the number of bytes written, or 0 on error.
+    size_t SaveState(std::vector<uint8_t> &state);
+    bool LoadState(const std::vector<uint8_t> &state, size_t size);
+
+    Memory *memory;
+    Interrupt *interrupts;
+    Timer *timer;
+    Cpu *cpu;
+};
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string.h>
+#include <unistd.h>
+
+#include "TestEmulator.h"
+#include "../EmulatorContext.h"
+#include "../EmulatorMgr.h"
+#include "../Interrupt.h"
+#include "../Memory.h"
+#include "../StateBuffer.h"
+#include "../Timer.h"
+
+// Snapshots start with a 4 byte magic number and a 2 byte version, followed by the chunks.
+const size_t SNAPSHOT_HEADER_SIZE = 6;
+const uint16_t SNAPSHOT_VERSION = 3;
+
+
+TestEmulator::TestEmulator(const std::string &name) :
+    emulator(NULL),
+    rom(),
+    filenames(),
+    framesReady(0),
+    lastFrame(),
+    serialOutput(),
+    audioOutput(),
+    messages(),
+    name(name)
+{
+    // Nothing is written outside the files this instance asks for.
+    EmulatorContext context;
+    context.persistRam = false;
+
+    emulator = new EmulatorMgr(this, this, NULL, NULL, NULL, this, context);
+}
+
+
+TestEmulator::~TestEmulator()
+{
+    delete emulator;
+
+    for (const std::string &filename : filenames)
+        unlink(filename.c_str());
+}
+
+
+std::vector<uint8_t> TestEmulator::MakeRom(const std::vector<uint8_t> &program, uint8_t mbcType, uint8_t romSizeCode)
+{
+    const size_t bankCount = 2u << romSizeCode;
+    std::vector<uint8_t> rom(bankCount * ROM_BANK_SIZE);
+
+    for (size_t bank = 1; bank < bankCount; bank++)
+        std::fill(&rom[bank * ROM_BANK_SIZE], &rom[bank * ROM_BANK_SIZE] + ROM_BANK_SIZE, bank);
+
+    // The entry point jumps over the header.
+    const uint8_t entry[] = {0x00, 0xC3, 0x50, 0x01};
+    std::copy(std::begin(entry), std::end(entry), &rom[0x100]);
+    rom[0x147] = mbcType;
+    rom[0x148] = romSizeCode;
+    rom[0x149] = 0;
+    std::copy(program.begin(), program.end(), &rom[0x150]);
+
+    return rom;
+}
+
+
+bool TestEmulator::LoadRom(const std::vector<uint8_t> &rom)
+{
+    this->rom = rom;
+
+    const std::string filename = GetFilename(".gb");
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char *>(rom.data()), rom.size());
+    file.close();
+
+    return file && emulator->LoadRom(filename, false);
+}
+
+
+std::string TestEmulator::GetFilename(const std::string &suffix)
+{
+    const std::string filename = "/tmp/zlgb_" + name + "." + std::to_string(getpid()) + suffix;
+    if (std::find(filenames.begin(), filenames.end(), filename) == filenames.end())
+        filenames.push_back(filename);
+
+    return filename;
+}
+
+
+std::vector<uint8_t> TestEmulator::GetSnapshot()
+{
+    std::vector<uint8_t> snapshot(emulator->GetSnapshotSize());
+    snapshot.resize(emulator->SaveSnapshot(snapshot.data(), snapshot.size()));
+
+    return snapshot;
+}
+
+
+bool TestEmulator::FindChunk(const std::vector<uint8_t> &snapshot, const char *tag, StateReader &chunk)
+{
+    if (snapshot.size() < SNAPSHOT_HEADER_SIZE)
+        return false;
+
+    StateReader chunks(&snapshot[SNAPSHOT_HEADER_SIZE], snapshot.size() - SNAPSHOT_HEADER_SIZE);
+    char chunkTag[STATE_CHUNK_TAG_SIZE];
+    while (chunks.ReadChunk(chunkTag, chunk))
+    {
+        if (memcmp(chunkTag, tag, STATE_CHUNK_TAG_SIZE) == 0)
+            return true;
+    }
+
+    return false;
+}
+
+
+uint8_t TestEmulator::ReadMemory(const std::vector<uint8_t> &snapshot, uint16_t address)
+{
+    Memory memory;
+    memory.SetRomMemory(rom);
+
+    StateReader chunk;
+    if (!FindChunk(snapshot, "MEM ", chunk) || !memory.LoadState(SNAPSHOT_VERSION, chunk))
+        throw std::runtime_error("Snapshot has no memory chunk");
+
+    return memory.ReadByte(address);
+}
+
+
+Registers TestEmulator::ReadRegisters(const std::vector<uint8_t> &snapshot)
+{
+    Memory memory;
+    Interrupt interrupts(&memory);
+    Timer timer(&memory, &interrupts);
+    Cpu cpu(&interrupts, &memory, &timer);
+
+    StateReader chunk;
+    if (!FindChunk(snapshot, "CPU ", chunk) || !cpu.LoadState(SNAPSHOT_VERSION, chunk))
+        throw std::runtime_error("Snapshot has no CPU chunk");
+
+    return cpu.reg;
+}
+
+
+void TestEmulator::FrameReady(const uint32_t *frameBuffer, const ScanlineMask &changedLines)
+{
+    (void)changedLines;
+
+    framesReady++;
+    lastFrame.assign(frameBuffer, frameBuffer + SCREEN_X * SCREEN_Y);
+}
+
+
+void TestEmulator::RequestMessageBox(const std::string &message)
+{
+    messages.push_back(message);
+}
+
+
+void TestEmulator::AudioDataReady(const std::array<int16_t, AudioInterface::BUFFER_LEN> &data)
+{
+    audioOutput.insert(audioOutput.end(), data.begin(), data.end());
+}
\ No newline at end of file
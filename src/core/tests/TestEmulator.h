@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../AudioInterface.h"
+#include "../Cpu.h"
+#include "../DisplayInterface.h"
+#include "../SerialInterface.h"
+
+class EmulatorMgr;
+class StateReader;
+
+
+// Runs a whole machine with a small ROM built by the test, and keeps what it outputs. Emulation runs on the calling
+// thread with EmulatorMgr::Run(), so tests can stop at exact frames.
+class TestEmulator : public DisplayInterface, public AudioInterface, public SerialInterface
+{
+public:
+    // name keeps the files of instances that exist at the same time apart.
+    explicit TestEmulator(const std::string &name);
+    virtual ~TestEmulator();
+
+    // Builds a ROM that runs program from 0x150. romSizeCode and mbcType go in the header. Every bank after the first
+    // is filled with its own number, so the mapped bank shows at 0x4000.
+    static std::vector<uint8_t> MakeRom(const std::vector<uint8_t> &program, uint8_t mbcType = 0,
+                                        uint8_t romSizeCode = 0);
+
+    bool LoadRom(const std::vector<uint8_t> &rom);
+
+    // A file for this instance, removed when it's destroyed.
+    std::string GetFilename(const std::string &suffix);
+
+    std::vector<uint8_t> GetSnapshot();
+    // Finds the chunk with the given tag in a snapshot.
+    static bool FindChunk(const std::vector<uint8_t> &snapshot, const char *tag, StateReader &chunk);
+    // Reads memory from a snapshot, by loading it into a scratch Memory with the same ROM.
+    uint8_t ReadMemory(const std::vector<uint8_t> &snapshot, uint16_t address);
+    static Registers ReadRegisters(const std::vector<uint8_t> &snapshot);
+
+    // DisplayInterface functions.
+    virtual void FrameReady(const uint32_t *frameBuffer, const ScanlineMask &changedLines);
+    virtual void RequestMessageBox(const std::string &message);
+    virtual void SaveStateComplete(const std::string &filename, bool success) {(void)filename; (void)success;}
+
+    // AudioInterface functions.
+    virtual void AudioDataReady(const std::array<int16_t, AudioInterface::BUFFER_LEN> &data);
+    virtual int GetAudioSampleRate() {return 48000;}
+    virtual bool GetAudioEnabled() {return true;}
+    virtual AudioInterface::Channels GetEnabledAudioChannels() {return Channels{true, true, true, true};}
+    virtual uint8_t GetAudioVolume() {return 100;}
+    virtual int GetGameSpeed() {return 60;}
+
+    // SerialInterface functions.
+    virtual void SerialDataSent(uint8_t byte) {serialOutput.push_back(byte);}
+
+    EmulatorMgr *emulator;
+    std::vector<uint8_t> rom;
+    std::vector<std::string> filenames;
+
+    uint64_t framesReady;
+    std::vector<uint32_t> lastFrame;
+    std::vector<uint8_t> serialOutput;
+    std::vector<int16_t> audioOutput;
+    std::vector<std::string> messages;
+
+    // Don't allow copy and assignment.
+    TestEmulator(const TestEmulator&) = delete;
+    void operator=(const TestEmulator&) = delete;
+
+private:
+    std::string name;
+};
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include <vector>
+
+#include "main.h"
+#include "TileCacheTest.h"
+#include "../Memory.h"
+#include "../StateBuffer.h"
+#include "../TileCache.h"
+
+
+TileCacheTest::TileCacheTest()
+{
+
+}
+
+
+TileCacheTest::~TileCacheTest()
+{
+
+}
+
+
+void TileCacheTest::SetUp()
+{
+
+}
+
+
+void TileCacheTest::TearDown()
+{
+
+}
+
+
+TEST_F(TileCacheTest, TEST_Decode)
+{
+    Memory memory;
+    TileCache tileCache(&memory);
+
+    // Row 3 of tile 0x101, at 0x9010: low bits 10110001, high bits 01100011.
+    memory.WriteByte(0x9016, 0xB1);
+    memory.WriteByte(0x9017, 0x63);
+
+    const uint8_t expected[TILE_PIXEL_SIZE] = {1, 2, 3, 1, 0, 0, 2, 3};
+    const uint8_t *row = tileCache.GetRow(0x101, 3);
+    const uint8_t *flippedRow = tileCache.GetRow(0x101, 3, true);
+    for (uint x = 0; x < TILE_PIXEL_SIZE; x++)
+    {
+        ASSERT_EQ(row[x], expected[x]);
+        ASSERT_EQ(flippedRow[x], expected[(TILE_PIXEL_SIZE - 1) - x]);
+    }
+    ASSERT_FALSE(memory.IsTileDirty(0x101));
+
+    // Writing the tile decodes it again.
+    memory.WriteByte(0x9017, 0x00);
+    ASSERT_TRUE(memory.IsTileDirty(0x101));
+    ASSERT_EQ(tileCache.GetRow(0x101, 3)[1], 0);
+}
+
+
+TEST_F(TileCacheTest, TEST_LoadState)
+{
+    Memory memory;
+    std::vector<uint8_t> gameRomMemory(ROM_BANK_SIZE * 2);
+    memory.SetRomMemory(gameRomMemory);
+    TileCache tileCache(&memory);
+
+    std::vector<uint8_t> state(MEM_SIZE * 2);
+    StateWriter writer(state.data(), state.size());
+    ASSERT_TRUE(memory.SaveState(writer));
+
+    memory.WriteByte(0x8020, 0xFF);
+    for (uint tile = 0; tile < VRAM_TILE_COUNT; tile++)
+        tileCache.GetRow(tile, 0);
+
+    // Only the tile that's different in the state needs decoding again.
+    StateReader reader(state.data(), writer.GetSize());
+    ASSERT_TRUE(memory.LoadState(3, reader));
+    for (uint tile = 0; tile < VRAM_TILE_COUNT; tile++)
+        ASSERT_EQ(memory.IsTileDirty(tile), tile == 2);
+    ASSERT_EQ(tileCache.GetRow(2, 0)[0], 0);
+}
\ No newline at end of file
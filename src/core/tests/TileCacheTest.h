@@ -0,0 +1,13 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+class TileCacheTest : public ::testing::Test
+{
+protected:
+    TileCacheTest();
+    ~TileCacheTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+};
\ No newline at end of file
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <iterator>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "main.h"
+#include "TraceTest.h"
+#include "../Cpu.h"
+#include "../Interrupt.h"
+#include "../Memory.h"
+#include "../OpcodeLength.h"
+#include "../Timer.h"
+#include "../TraceReader.h"
+#include "../TraceRecorder.h"
+
+
+TraceTest::TraceTest()
+{
+
+}
+
+
+TraceTest::~TraceTest()
+{
+
+}
+
+
+void TraceTest::SetUp()
+{
+    char tempFilename[] = "/tmp/zlgb_trace.XXXXXX";
+    int fd = mkstemp(tempFilename);
+    close(fd);
+    filename = tempFilename;
+}
+
+
+void TraceTest::TearDown()
+{
+    unlink(filename.c_str());
+}
+
+
+TEST_F(TraceTest, TEST_RoundTrip)
+{
+    Registers reg;
+    reg.af = 0x01B0;
+    reg.bc = 0x0013;
+    reg.sp = 0xFFFE;
+    reg.pc = 0x0100;
+
+    const uint8_t nop[3] = {0x00, 0x00, 0x00};
+    const uint8_t jp[3] = {0xC3, 0x50, 0x01};
+    const uint8_t bit[3] = {0xCB, 0x7C, 0x00};
+
+    {
+        TraceRecorder recorder;
+        ASSERT_TRUE(recorder.Open(filename));
+
+        recorder.Record(reg, nop, 1, 100);
+        reg.pc = 0x0101;
+        recorder.Record(reg, jp, 1, 104);
+        reg.pc = 0x0150;
+        reg.hl = 0x8000;
+        recorder.Record(reg, bit, 2, 1000);
+
+        ASSERT_EQ(3u, recorder.GetRecordCount());
+    }
+
+    TraceReader reader;
+    ASSERT_TRUE(reader.Open(filename));
+    ASSERT_EQ(3u, reader.GetRecordCount());
+
+    TraceEntry entry;
+    ASSERT_TRUE(reader.Next(entry));
+    ASSERT_EQ(100u, entry.clock);
+    ASSERT_EQ(0x0100, entry.pc);
+    ASSERT_EQ(0x01B0, entry.af);
+    ASSERT_EQ(0x0013, entry.bc);
+    ASSERT_EQ(0xFFFE, entry.sp);
+    ASSERT_EQ(1, entry.bank);
+    ASSERT_EQ(1, entry.opcodeLength);
+
+    ASSERT_TRUE(reader.Next(entry));
+    ASSERT_EQ(104u, entry.clock);
+    ASSERT_EQ(0x0101, entry.pc);
+    ASSERT_EQ(3, entry.opcodeLength);
+    ASSERT_EQ(0xC3, entry.opcode[0]);
+    ASSERT_EQ(0x50, entry.opcode[1]);
+    ASSERT_EQ(0x01, entry.opcode[2]);
+
+    ASSERT_TRUE(reader.Next(entry));
+    ASSERT_EQ(1000u, entry.clock);
+    ASSERT_EQ(0x0150, entry.pc);
+    ASSERT_EQ(0x8000, entry.hl);
+    ASSERT_EQ(0x01B0, entry.af);
+    ASSERT_EQ(2, entry.bank);
+    ASSERT_EQ(2, entry.opcodeLength);
+    ASSERT_EQ(0x7C, entry.opcode[1]);
+
+    ASSERT_FALSE(reader.Next(entry));
+}
+
+
+TEST_F(TraceTest, TEST_SequentialRecordsAreSmall)
+{
+    Registers reg;
+    const uint8_t nop[3] = {0x00, 0x00, 0x00};
+
+    TraceRecorder recorder;
+    ASSERT_TRUE(recorder.Open(filename));
+
+    recorder.Record(reg, nop, 0, 0);
+    uint64_t size = recorder.GetDataSize();
+
+    // Nothing but the clock changed, so the record is just flags, clock delta, and opcode.
+    reg.pc++;
+    recorder.Record(reg, nop, 0, 4);
+    ASSERT_EQ(size + 3, recorder.GetDataSize());
+}
+
+
+TEST_F(TraceTest, TEST_OnlyInstructionsAreRecorded)
+{
+    Memory memory;
+    Interrupt interrupts(&memory);
+    Timer timer(&memory, &interrupts);
+    Cpu cpu(&interrupts, &memory, &timer);
+
+    memory.ClearMemory();
+    memory.EnableRam(true);
+    memory.GetBytePtr(0)[0x0000] = 0x76; // HALT
+    memory.GetBytePtr(0)[0x0040] = 0x00; // NOP in the VBlank handler
+    memory.WriteByte(eRegIE, eIntBitVBlank);
+    interrupts.SetEnabled(true);
+
+    TraceRecorder recorder;
+    ASSERT_TRUE(recorder.Open(filename));
+    cpu.SetTraceRecorder(&recorder);
+
+    cpu.ProcessOpCode();
+    ASSERT_EQ(1u, recorder.GetRecordCount());
+
+    // Halted cycles aren't instructions.
+    for (int i = 0; i < 10; i++)
+        cpu.ProcessOpCode();
+    ASSERT_EQ(1u, recorder.GetRecordCount());
+
+    // Neither is the jump to the interrupt handler.
+    interrupts.RequestInterrupt(eIntVBlank);
+    cpu.ProcessOpCode();
+    ASSERT_EQ(0x0040, cpu.reg.pc);
+    ASSERT_EQ(1u, recorder.GetRecordCount());
+
+    cpu.ProcessOpCode();
+    ASSERT_EQ(2u, recorder.GetRecordCount());
+    recorder.Close();
+
+    TraceReader reader;
+    ASSERT_TRUE(reader.Open(filename));
+
+    TraceEntry entry;
+    ASSERT_TRUE(reader.Next(entry));
+    ASSERT_EQ(0x0000, entry.pc);
+    ASSERT_EQ(0x76, entry.opcode[0]);
+    ASSERT_TRUE(reader.Next(entry));
+    ASSERT_EQ(0x0040, entry.pc);
+    ASSERT_EQ(0x00, entry.opcode[0]);
+    ASSERT_FALSE(reader.Next(entry));
+}
+
+
+TEST_F(TraceTest, TEST_OpcodeLengths)
+{
+    // Opcodes with an 8 bit immediate or relative jump.
+    const uint8_t twoBytes[] = {
+        0x06, 0x0E, 0x16, 0x1E, 0x26, 0x2E, 0x36, 0x3E,  // LD r, d8
+        0x18, 0x20, 0x28, 0x30, 0x38,                           // JR
+        0xC6, 0xCE, 0xD6, 0xDE, 0xE6, 0xEE, 0xF6, 0xFE,         // ALU A, d8
+        0xE0, 0xF0, 0xE8, 0xF8,                                 // LDH, ADD SP, LD HL SP+
+        0xCB                                                    // Prefix
+    };
+    // Opcodes with a 16 bit immediate.
+    const uint8_t threeBytes[] = {
+        0x01, 0x11, 0x21, 0x31, 0x08,                           // LD rr, d16, LD (a16), SP
+        0xC2, 0xC3, 0xCA, 0xD2, 0xDA,                           // JP
+        0xC4, 0xCC, 0xCD, 0xD4, 0xDC,                           // CALL
+        0xEA, 0xFA                                              // LD (a16), A, LD A, (a16)
+    };
+
+    for (int opcode = 0; opcode < 256; opcode++)
+    {
+        uint8_t expected = 1;
+        if (std::find(std::begin(twoBytes), std::end(twoBytes), opcode) != std::end(twoBytes))
+            expected = 2;
+        else if (std::find(std::begin(threeBytes), std::end(threeBytes), opcode) != std::end(threeBytes))
+            expected = 3;
+
+        ASSERT_EQ(expected, GetOpcodeLength(opcode)) << "opcode " << opcode;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <string>
+
+class TraceTest : public ::testing::Test
+{
+protected:
+    TraceTest();
+    ~TraceTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+
+    std::string filename;
+};
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "main.h"
+#include "TripleFrameBufferTest.h"
+#include "../TripleFrameBuffer.h"
+
+
+TripleFrameBufferTest::TripleFrameBufferTest()
+{
+
+}
+
+
+TripleFrameBufferTest::~TripleFrameBufferTest()
+{
+
+}
+
+
+void TripleFrameBufferTest::SetUp()
+{
+
+}
+
+
+void TripleFrameBufferTest::TearDown()
+{
+
+}
+
+
+TEST_F(TripleFrameBufferTest, TEST_Latest)
+{
+    TripleFrameBuffer frameBuffers;
+
+    const uint32_t *before = frameBuffers.Acquire();
+    ASSERT_EQ(frameBuffers.Acquire(), before);
+
+    // The reader gets the newest frame, and frames it didn't get to are dropped.
+    for (uint32_t frame = 1; frame <= 3; frame++)
+    {
+        std::fill_n(frameBuffers.GetBackBuffer(), SCREEN_X * SCREEN_Y, frame);
+        const uint32_t *published = frameBuffers.Publish();
+        ASSERT_EQ(published[0], frame);
+        ASSERT_NE(frameBuffers.GetBackBuffer(), published);
+    }
+
+    const uint32_t *latest = frameBuffers.Acquire();
+    ASSERT_EQ(latest[0], 3u);
+    ASSERT_EQ(frameBuffers.GetDroppedFrames(), 2u);
+
+    // Without a new frame, the reader keeps the one it has, and the writer never draws into it.
+    ASSERT_EQ(frameBuffers.Acquire(), latest);
+    for (uint i = 0; i < 3; i++)
+    {
+        ASSERT_NE(frameBuffers.GetBackBuffer(), latest);
+        frameBuffers.Publish();
+    }
+    ASSERT_EQ(latest[0], 3u);
+}
+
+
+TEST_F(TripleFrameBufferTest, TEST_Threads)
+{
+    TripleFrameBuffer frameBuffers;
+    const uint32_t FRAMES = 20000;
+
+    // Each frame is filled with its number. A frame the reader gets must never be partly drawn, and frames must never
+    // go backwards.
+    std::thread writer([&frameBuffers, FRAMES]()
+    {
+        for (uint32_t frame = 1; frame <= FRAMES; frame++)
+        {
+            std::fill_n(frameBuffers.GetBackBuffer(), SCREEN_X * SCREEN_Y, frame);
+            frameBuffers.Publish();
+        }
+    });
+
+    uint32_t last = 0;
+    uint64_t framesRead = 0;
+    bool torn = false;
+    bool backwards = false;
+    while (last < FRAMES && !torn && !backwards)
+    {
+        const uint32_t *frame = frameBuffers.Acquire();
+        const uint32_t number = frame[0];
+        torn = std::count(frame, frame + SCREEN_X * SCREEN_Y, number) != SCREEN_X * SCREEN_Y;
+        backwards = number < last;
+
+        if (number != last)
+            framesRead++;
+        last = number;
+    }
+
+    writer.join();
+
+    ASSERT_FALSE(torn);
+    ASSERT_FALSE(backwards);
+    ASSERT_EQ(framesRead + frameBuffers.GetDroppedFrames(), FRAMES);
+}
+
+
+TEST_F(TripleFrameBufferTest, TEST_ChangedLines)
+{
+    TripleFrameBuffer frameBuffers;
+    const uint32_t FRAMES = 20000;
+
+    // Each frame changes one line to its number. The reader keeps its own copy of the frame, and only copies the lines
+    // it's told changed, so lines that changed in dropped frames have to be passed on to the next frame.
+    std::thread writer([&frameBuffers, FRAMES]()
+    {
+        std::vector<uint32_t> frame(SCREEN_X * SCREEN_Y, 0);
+        for (uint32_t number = 1; number <= FRAMES; number++)
+        {
+            const uint line = (number * 7) % SCREEN_Y;
+            std::fill_n(&frame[line * SCREEN_X], SCREEN_X, number);
+            std::copy(frame.begin(), frame.end(), frameBuffers.GetBackBuffer());
+
+            ScanlineMask changedLines;
+            changedLines[line] = true;
+            frameBuffers.Publish(number == 1 ? ScanlineMask().set() : changedLines);
+        }
+    });
+
+    std::vector<uint32_t> copy(SCREEN_X * SCREEN_Y, 0);
+    bool mismatch = false;
+    bool done = false;
+    while (!done && !mismatch)
+    {
+        ScanlineMask changedLines;
+        const uint32_t *frame = frameBuffers.Acquire(&changedLines);
+        for (uint line = 0; line < SCREEN_Y; line++)
+        {
+            if (changedLines[line])
+                std::copy_n(&frame[line * SCREEN_X], SCREEN_X, &copy[line * SCREEN_X]);
+        }
+
+        mismatch = !std::equal(copy.begin(), copy.end(), frame);
+        done = std::find(frame, frame + SCREEN_X * SCREEN_Y, FRAMES) != frame + SCREEN_X * SCREEN_Y;
+    }
+
+    writer.join();
+
+    ASSERT_FALSE(mismatch);
+
+    // Without a new frame, nothing changed.
+    ScanlineMask changedLines;
+    frameBuffers.Acquire(&changedLines);
+    ASSERT_TRUE(changedLines.none());
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+class TripleFrameBufferTest : public ::testing::Test
+{
+protected:
+    TripleFrameBufferTest();
+    ~TripleFrameBufferTest() override;
+
+    void SetUp() override;
+    void TearDown() override;
+};
\ No newline at end of file
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "core/StateHash.h"
+
+// Exit codes, the same as cmp and diff use.
+const int EXIT_SAME = 0;
+const int EXIT_DIFFERENT = 1;
+const int EXIT_ERROR = 2;
+
+
+void PrintUsage(const char *name)
+{
+    printf("Usage: %s [options] hashfile1 hashfile2\n", name);
+    printf("  -n, --count COUNT    Print the first COUNT frames that differ, defaults to 1. 0 prints all of them\n");
+    printf("  -s, --summary        Only print the number of frames that differ\n");
+    printf("\n");
+    printf("Exit status is %d if the files match, %d if they differ, and %d on error.\n", EXIT_SAME, EXIT_DIFFERENT,
+           EXIT_ERROR);
+}
+
+
+int main(int argc, char *argv[])
+{
+    uint64_t maxCount = 1;
+    bool summary = false;
+
+    const struct option longOptions[] = {
+        {"count", required_argument, NULL, 'n'},
+        {"summary", no_argument, NULL, 's'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "n:sh", longOptions, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'n':
+                maxCount = strtoull(optarg, NULL, 0);
+                if (maxCount == 0)
+                    maxCount = UINT64_MAX;
+                break;
+            case 's':
+                summary = true;
+                break;
+            default:
+                PrintUsage(argv[0]);
+                return c == 'h' ? EXIT_SAME : EXIT_ERROR;
+        }
+    }
+
+    if (optind + 2 != argc)
+    {
+        PrintUsage(argv[0]);
+        return EXIT_ERROR;
+    }
+
+    StateHashReader readers[2];
+    for (int i = 0; i < 2; i++)
+    {
+        if (!readers[i].Open(argv[optind + i]))
+        {
+            fprintf(stderr, "Error opening state hash file %s\n", argv[optind + i]);
+            return EXIT_ERROR;
+        }
+    }
+
+    // Chunks are matched up by tag, so files from builds that save different parts of the machine can still be
+    // compared on the parts they share.
+    const std::vector<std::string> &tags = readers[0].GetTags();
+    const std::vector<std::string> &otherTags = readers[1].GetTags();
+    std::vector<std::pair<size_t, size_t>> common;
+    for (size_t i = 0; i < tags.size(); i++)
+    {
+        size_t j = 0;
+        while (j < otherTags.size() && otherTags[j] != tags[i])
+            j++;
+
+        if (j < otherTags.size())
+            common.push_back(std::make_pair(i, j));
+        else
+            fprintf(stderr, "%s is only in %s, not compared\n", tags[i].c_str(), argv[optind]);
+    }
+    for (const std::string &tag : otherTags)
+    {
+        if (std::find(tags.begin(), tags.end(), tag) == tags.end())
+            fprintf(stderr, "%s is only in %s, not compared\n", tag.c_str(), argv[optind + 1]);
+    }
+
+    uint64_t frames[2];
+    std::vector<uint64_t> hashes[2];
+    uint64_t records = 0;
+    uint64_t count = 0;
+    int shorter = -1;  // Index of the file that ends first, if they're different lengths.
+
+    while (true)
+    {
+        const bool more0 = readers[0].Next(frames[0], hashes[0]);
+        const bool more1 = readers[1].Next(frames[1], hashes[1]);
+        if (!more0 || !more1)
+        {
+            if (more0 != more1)
+                shorter = more0 ? 1 : 0;
+            break;
+        }
+
+        records++;
+
+        std::string differences;
+        for (const std::pair<size_t, size_t> &chunk : common)
+        {
+            if (hashes[0][chunk.first] != hashes[1][chunk.second])
+                differences += " " + tags[chunk.first].substr(0, tags[chunk.first].find_last_not_of(' ') + 1);
+        }
+
+        if (differences.empty())
+            continue;
+
+        count++;
+
+        if (summary || count > maxCount)
+            continue;
+
+        // Frames are numbered from when the emulator started, so runs started differently can number them differently.
+        if (frames[0] == frames[1])
+            printf("Frame %llu (record %llu) differs in:%s\n", (unsigned long long)frames[0],
+                   (unsigned long long)records, differences.c_str());
+        else
+            printf("Frames %llu and %llu (record %llu) differ in:%s\n", (unsigned long long)frames[0],
+                   (unsigned long long)frames[1], (unsigned long long)records, differences.c_str());
+    }
+
+    if (count == 0)
+        printf("%llu frames match\n", (unsigned long long)records);
+    else if (summary || count > maxCount)
+        printf("%llu of %llu frames differ\n", (unsigned long long)count, (unsigned long long)records);
+
+    if (shorter >= 0)
+        printf("%s ends after %llu frames\n", argv[optind + shorter], (unsigned long long)records);
+
+    return count || shorter >= 0 ? EXIT_DIFFERENT : EXIT_SAME;
+}
\ No newline at end of file
@@ -0,0 +1,272 @@
+#include <algorithm>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "core/EmulatorContext.h"
+#include "core/EmulatorMgr.h"
+#include "core/Exceptions.h"
+#include "core/Logger.h"
+
+#include "HeadlessEmulator.h"
+
+
+HeadlessEmulator::HeadlessEmulator(const Options &options) :
+    options(options),
+    loggerConfig({options.loggerOutput ? this : NULL, options.logLevel}),
+    emulator(NULL),
+    result(eResultComplete),
+    serialBuffer(),
+    errorMessage(),
+    clocksRun(0),
+    rewindStats(),
+    runAheadStats()
+{
+    memset(frame, 0, sizeof(frame));
+
+    // The fail pattern is added first, so it wins if both patterns match on the same byte.
+    serialBuffer.AddPattern(options.failPattern, [this](const std::string &) {PatternMatched(eResultFail);});
+    serialBuffer.AddPattern(options.passPattern, [this](const std::string &) {PatternMatched(eResultPass);});
+
+    // Each instance logs through its own config, and doesn't touch files other than the ones in options, so
+    // instances can run on different threads at the same time.
+    EmulatorContext context;
+    context.loggerConfig = &loggerConfig;
+    context.persistRam = options.persistRam;
+
+    emulator = new EmulatorMgr(this, this, NULL, NULL, NULL, &serialBuffer, context);
+    emulator->SetLinkInterface(options.link);
+    emulator->SetRewindBuffer(options.rewindBufferSize);
+    emulator->SetRunAhead(options.runAheadFrames);
+    if (options.renderInterval != 1)
+        emulator->SetFastForward(true, options.renderInterval);
+}
+
+
+HeadlessEmulator::~HeadlessEmulator()
+{
+    delete emulator;
+}
+
+
+HeadlessEmulator::Result HeadlessEmulator::Run()
+{
+    ScopedLoggerConfig scopedLoggerConfig(&loggerConfig);
+
+    result = eResultComplete;
+    serialBuffer.Clear();
+    errorMessage.clear();
+
+    // EmulatorMgr doesn't check that the ROM exists, so check here to give a useful error.
+    FILE *romFile = fopen(options.romFilename.c_str(), "rb");
+    if (romFile == NULL)
+    {
+        errorMessage = "Error opening ROM " + options.romFilename + ": " + strerror(errno);
+        return eResultError;
+    }
+    fclose(romFile);
+
+    try
+    {
+        if (!options.bootRomFilename.empty())
+            emulator->LoadBootRom(options.bootRomFilename);
+
+        if (!emulator->LoadRom(options.romFilename, false))
+        {
+            errorMessage = "Error loading ROM " + options.romFilename;
+            return eResultError;
+        }
+
+        if (!options.loadStateFilename.empty() && !emulator->LoadStateFromFile(options.loadStateFilename))
+        {
+            errorMessage = "Error loading state " + options.loadStateFilename;
+            return eResultError;
+        }
+
+        if (!options.playMovieFilename.empty() && !emulator->StartMoviePlayback(options.playMovieFilename))
+        {
+            errorMessage = "Error playing movie " + options.playMovieFilename;
+            return eResultError;
+        }
+
+        if (!options.recordMovieFilename.empty() &&
+            !emulator->StartMovieRecording(options.recordMovieFilename, options.loadStateFilename.empty()))
+        {
+            errorMessage = "Error recording movie " + options.recordMovieFilename;
+            return eResultError;
+        }
+
+        if (!options.stateHashFilename.empty() && !emulator->StartStateHashing(options.stateHashFilename))
+        {
+            errorMessage = "Error writing state hashes to " + options.stateHashFilename;
+            return eResultError;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        errorMessage = e.what();
+        return eResultError;
+    }
+
+    // A movie without a limit plays to its end.
+    uint64_t maxFrames = options.maxFrames;
+    if (!options.playMovieFilename.empty() && maxFrames == 0 && options.maxClocks == 0)
+        maxFrames = std::max<uint64_t>(emulator->GetMovieFrameCount(), 1);
+
+    clocksRun = emulator->Run(options.maxClocks, maxFrames);
+
+    if (!options.recordMovieFilename.empty() && !emulator->StopMovie())
+        result = eResultError;
+
+    if (!options.stateHashFilename.empty() && !emulator->StopStateHashing())
+        result = eResultError;
+
+    // Run() only returns before hitting a limit if a pattern matched or there was an error.
+    if (result == eResultComplete && (!options.passPattern.empty() || !options.failPattern.empty()))
+        result = eResultTimeout;
+
+    // Stats are taken before stepping back, so they describe the history the run built up.
+    rewindStats = emulator->GetRewindStats();
+    runAheadStats = emulator->GetRunAheadStats();
+    for (uint i = 0; i < options.rewindFrames; i++)
+    {
+        if (!emulator->RewindFrame())
+        {
+            LogError("Only %u frames of rewind history", i);
+            break;
+        }
+    }
+
+    if (!options.frameFilename.empty() && !WriteFrame(options.frameFilename))
+        result = eResultError;
+
+    if (!options.stateFilename.empty() && !emulator->SaveStateToFile(options.stateFilename))
+        result = eResultError;
+
+    if (!options.serialFilename.empty() && !WriteSerial(options.serialFilename))
+        result = eResultError;
+
+    emulator->EndEmulation();
+
+    return result;
+}
+
+
+const char *HeadlessEmulator::GetResultString(Result result)
+{
+    switch (result)
+    {
+        case eResultComplete:
+            return "complete";
+        case eResultPass:
+            return "pass";
+        case eResultFail:
+            return "fail";
+        case eResultTimeout:
+            return "timeout";
+        case eResultError:
+            return "error";
+        default:
+            return "unknown";
+    }
+}
+
+
+void HeadlessEmulator::FrameReady(const uint32_t *frameBuffer, const ScanlineMask &changedLines)
+{
+    // The copy already has the lines that didn't change.
+    for (uint line = 0; line < SCREEN_Y; line++)
+    {
+        if (changedLines[line])
+            memcpy(&frame[line * SCREEN_X], &frameBuffer[line * SCREEN_X], SCREEN_X * sizeof(uint32_t));
+    }
+}
+
+
+void HeadlessEmulator::RequestMessageBox(const std::string &message)
+{
+    LogError("%s", message.c_str());
+
+    errorMessage = message;
+    result = eResultError;
+}
+
+
+void HeadlessEmulator::PatternMatched(Result patternResult)
+{
+    // Keep the first match, since more output can be sent before emulation stops.
+    if (result != eResultComplete)
+        return;
+
+    result = patternResult;
+    emulator->StopRun();
+}
+
+
+void HeadlessEmulator::Output(std::unique_ptr<LogEntry> entry)
+{
+    if (!options.logPrefix.empty())
+        entry->message = options.logPrefix + entry->message;
+
+    options.loggerOutput->Output(std::move(entry));
+}
+
+
+bool HeadlessEmulator::WriteFrame(const std::string &filename) const
+{
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (file == NULL)
+    {
+        LogError("Error opening frame file %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    fprintf(file, "P6\n%u %u\n255\n", SCREEN_X, SCREEN_Y);
+
+    // Framebuffer pixels are 0x00RRGGBB.
+    uint8_t line[SCREEN_X * 3];
+    bool success = true;
+    for (uint y = 0; y < SCREEN_Y; y++)
+    {
+        for (uint x = 0; x < SCREEN_X; x++)
+        {
+            uint32_t pixel = frame[(y * SCREEN_X) + x];
+            line[(x * 3) + 0] = (pixel >> 16) & 0xFF;
+            line[(x * 3) + 1] = (pixel >> 8) & 0xFF;
+            line[(x * 3) + 2] = pixel & 0xFF;
+        }
+        success &= fwrite(line, sizeof(line), 1, file) == 1;
+    }
+
+    fclose(file);
+
+    if (!success)
+        LogError("Error writing frame file %s", filename.c_str());
+
+    return success;
+}
+
+
+bool HeadlessEmulator::WriteSerial(const std::string &filename) const
+{
+    const std::string &output = serialBuffer.GetOutput();
+
+    if (filename == "-")
+    {
+        fwrite(output.data(), 1, output.size(), stdout);
+        fflush(stdout);
+        return true;
+    }
+
+    FILE *file = fopen(filename.c_str(), "wb");
+    if (file == NULL)
+    {
+        LogError("Error opening serial file %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    bool success = fwrite(output.data(), 1, output.size(), file) == output.size();
+    fclose(file);
+
+    return success;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <string>
+
+#include "core/AudioInterface.h"
+#include "core/Display.h"
+#include "core/DisplayInterface.h"
+#include "core/EmulatorMgr.h"
+#include "core/Logger.h"
+#include "core/RewindBuffer.h"
+#include "core/SerialBuffer.h"
+
+class LinkInterface;
+
+
+// Runs a single ROM without any UI, as fast as the core allows.
+class HeadlessEmulator : public DisplayInterface, public AudioInterface, public LoggerOutput
+{
+public:
+    enum Result
+    {
+        eResultComplete,  // The frame or cycle limit was reached, and no patterns were given.
+        eResultPass,      // The serial output matched the pass pattern.
+        eResultFail,      // The serial output matched the fail pattern.
+        eResultTimeout,   // The frame or cycle limit was reached before a pattern matched.
+        eResultError      // The ROM couldn't be loaded, or emulation stopped with an error.
+    };
+
+    struct Options
+    {
+        std::string romFilename;
+        std::string bootRomFilename;
+        uint64_t maxFrames = 0;        // 0 means no limit.
+        uint64_t maxClocks = 0;        // 0 means no limit.
+        std::string passPattern;
+        std::string failPattern;
+        std::string serialFilename;    // "-" for stdout.
+        std::string frameFilename;     // Final frame is written as a binary PPM.
+        std::string stateFilename;     // Final state is written as a save state.
+        std::string loadStateFilename; // Save state loaded before running.
+        bool persistRam = false;       // Load and save battery backed RAM.
+        LoggerOutput *loggerOutput = NULL;
+        LogLevel logLevel = LogLevel::eError;
+        std::string logPrefix;         // Prepended to log messages, to tell instances apart.
+        LinkInterface *link = NULL;    // Link cable port for the serial port.
+        size_t rewindBufferSize = 0;   // Bytes of rewind history, 0 disables rewind.
+        uint rewindFrames = 0;         // Frames to step back after the run, before writing output files.
+        uint runAheadFrames = 0;       // Frames to run ahead of each real frame, 0 disables run-ahead.
+        uint renderInterval = 1;       // Only every Nth frame is drawn, 0 draws none.
+        std::string recordMovieFilename; // Movie recorded from power on, or from the loaded state.
+        std::string playMovieFilename;   // Movie played back. Without a limit, the run stops at its end.
+        std::string stateHashFilename;   // Hash of the state at the end of every frame is written here.
+    };
+
+    explicit HeadlessEmulator(const Options &options);
+    virtual ~HeadlessEmulator();
+
+    Result Run();
+
+    const std::string &GetSerialOutput() const {return serialBuffer.GetOutput();}
+    const std::string &GetErrorMessage() const {return errorMessage;}
+    uint64_t GetClocksRun() const {return clocksRun;}
+    const RewindBuffer::Stats &GetRewindStats() const {return rewindStats;}
+    const EmulatorMgr::RunAheadStats &GetRunAheadStats() const {return runAheadStats;}
+
+    static const char *GetResultString(Result result);
+
+    // DisplayInterface functions.
+    virtual void FrameReady(const uint32_t *frameBuffer, const ScanlineMask &changedLines);
+    // The last frame is already copied.
+    virtual void FrameUnchanged(const uint32_t *frameBuffer) {(void)frameBuffer;}
+    virtual void RequestMessageBox(const std::string &message);
+    virtual void SaveStateComplete(const std::string &filename, bool success) {(void)filename; (void)success;}
+
+    // AudioInterface functions.
+    virtual void AudioDataReady(const std::array<int16_t, AudioInterface::BUFFER_LEN> &data) {(void)data;}
+    virtual int GetAudioSampleRate() {return 48000;}
+    virtual bool GetAudioEnabled() {return false;}
+    virtual AudioInterface::Channels GetEnabledAudioChannels() {return AudioInterface::Channels{false, false, false, false};}
+    virtual uint8_t GetAudioVolume() {return 0;}
+    virtual int GetGameSpeed() {return 60;}
+
+    // LoggerOutput functions.
+    virtual void Output(std::unique_ptr<LogEntry> entry);
+
+    // Don't allow copy and assignment.
+    HeadlessEmulator(const HeadlessEmulator&) = delete;
+    void operator=(const HeadlessEmulator&) = delete;
+
+private:
+    void PatternMatched(Result patternResult);
+    bool WriteFrame(const std::string &filename) const;
+    bool WriteSerial(const std::string &filename) const;
+
+    Options options;
+    LoggerConfig loggerConfig;
+    EmulatorMgr *emulator;
+
+    Result result;
+    SerialBuffer serialBuffer;
+    std::string errorMessage;
+    uint64_t clocksRun;
+    RewindBuffer::Stats rewindStats;
+    EmulatorMgr::RunAheadStats runAheadStats;
+
+    uint32_t frame[SCREEN_X * SCREEN_Y];
+};
\ No newline at end of file
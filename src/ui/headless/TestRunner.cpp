@@ -0,0 +1,302 @@
+#include <chrono>
+#include <errno.h>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+
+#include "core/Logger.h"
+
+#include "TestRunner.h"
+#include "ThreadPool.h"
+
+
+static std::string EscapeJson(const std::string &str)
+{
+    std::string out;
+    for (unsigned char c : str)
+    {
+        switch (c)
+        {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\r':
+                out += "\\r";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                // Serial output isn't necessarily valid UTF-8, so escape everything outside printable ASCII.
+                if (c < 0x20 || c >= 0x7F)
+                {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04X", c);
+                    out += buf;
+                }
+                else
+                {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+
+static std::string EscapeXml(const std::string &str)
+{
+    std::string out;
+    for (unsigned char c : str)
+    {
+        switch (c)
+        {
+            case '&':
+                out += "&amp;";
+                break;
+            case '<':
+                out += "&lt;";
+                break;
+            case '>':
+                out += "&gt;";
+                break;
+            case '"':
+                out += "&quot;";
+                break;
+            default:
+                // Control characters other than whitespace aren't allowed in XML, and high bytes may not be valid UTF-8.
+                if ((c < 0x20 && c != '\n' && c != '\r' && c != '\t') || c >= 0x7F)
+                    out += '?';
+                else
+                    out += c;
+        }
+    }
+    return out;
+}
+
+
+TestRunner::TestRunner() :
+    tests(),
+    results(),
+    totalSeconds(0)
+{
+
+}
+
+
+bool TestRunner::LoadManifest(const std::string &filename, const HeadlessEmulator::Options &baseOptions, uint64_t defaultCycles)
+{
+    std::ifstream file(filename);
+    if (!file)
+    {
+        LogError("Error opening manifest %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    std::string dir;
+    size_t slash = filename.rfind('/');
+    if (slash != std::string::npos)
+        dir = filename.substr(0, slash + 1);
+
+    std::string line;
+    int lineNum = 0;
+    while (std::getline(file, line))
+    {
+        lineNum++;
+
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, '\t'))
+            fields.push_back(field);
+
+        if (fields.empty() || fields[0].empty())
+        {
+            LogError("%s:%d: Missing ROM filename", filename.c_str(), lineNum);
+            return false;
+        }
+
+        Test test;
+        test.name = fields[0];
+        test.options = baseOptions;
+        test.options.logPrefix = fields[0] + ": ";
+        test.options.romFilename = fields[0][0] == '/' ? fields[0] : dir + fields[0];
+        test.options.maxClocks = defaultCycles * 4;
+        if (fields.size() > 1 && !fields[1].empty())
+        {
+            char *end;
+            test.options.maxClocks = strtoull(fields[1].c_str(), &end, 0) * 4;
+            if (*end != '\0')
+            {
+                LogError("%s:%d: Invalid cycle count '%s'", filename.c_str(), lineNum, fields[1].c_str());
+                return false;
+            }
+        }
+        if (fields.size() > 2)
+            test.options.passPattern = fields[2];
+        if (fields.size() > 3)
+            test.options.failPattern = fields[3];
+
+        if (test.options.maxClocks == 0 && test.options.passPattern.empty() && test.options.failPattern.empty())
+        {
+            LogError("%s:%d: Test needs a cycle budget or a pattern", filename.c_str(), lineNum);
+            return false;
+        }
+
+        tests.push_back(test);
+    }
+
+    return true;
+}
+
+
+void TestRunner::Run(unsigned threadCount, ResultCallback callback)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+
+    results.assign(tests.size(), TestResult());
+
+    std::mutex callbackMutex;
+    auto start = std::chrono::steady_clock::now();
+
+    {
+        ThreadPool pool(threadCount);
+
+        for (size_t i = 0; i < tests.size(); i++)
+        {
+            pool.AddJob([this, i, &callback, &callbackMutex]()
+            {
+                auto testStart = std::chrono::steady_clock::now();
+
+                // Each emulator has its own serial sink, so tests can't see each other's output.
+                HeadlessEmulator emulator(tests[i].options);
+                TestResult &result = results[i];
+                result.result = emulator.Run();
+                result.serialOutput = emulator.GetSerialOutput();
+                result.errorMessage = emulator.GetErrorMessage();
+                result.cycles = emulator.GetClocksRun() / 4;
+                result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - testStart).count();
+
+                if (callback)
+                {
+                    std::lock_guard<std::mutex> lock(callbackMutex);
+                    callback(tests[i], result);
+                }
+            });
+        }
+
+        pool.WaitForJobs();
+    }
+
+    totalSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+unsigned TestRunner::GetResultCount(HeadlessEmulator::Result result) const
+{
+    unsigned count = 0;
+    for (const TestResult &testResult : results)
+    {
+        if (testResult.result == result)
+            count++;
+    }
+    return count;
+}
+
+
+bool TestRunner::WriteJsonReport(const std::string &filename) const
+{
+    FILE *file = fopen(filename.c_str(), "w");
+    if (file == NULL)
+    {
+        LogError("Error opening report %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    fprintf(file, "{\n");
+    fprintf(file, "  \"total\": %zu,\n", results.size());
+    fprintf(file, "  \"passed\": %u,\n", GetResultCount(HeadlessEmulator::eResultPass) + GetResultCount(HeadlessEmulator::eResultComplete));
+    fprintf(file, "  \"failed\": %u,\n", GetResultCount(HeadlessEmulator::eResultFail));
+    fprintf(file, "  \"timedOut\": %u,\n", GetResultCount(HeadlessEmulator::eResultTimeout));
+    fprintf(file, "  \"errors\": %u,\n", GetResultCount(HeadlessEmulator::eResultError));
+    fprintf(file, "  \"seconds\": %.3f,\n", totalSeconds);
+    fprintf(file, "  \"tests\": [\n");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const TestResult &result = results[i];
+        fprintf(file, "    {\"rom\": \"%s\", \"result\": \"%s\", \"cycles\": %llu, \"seconds\": %.3f, \"serial\": \"%s\"",
+                EscapeJson(tests[i].name).c_str(), HeadlessEmulator::GetResultString(result.result),
+                (unsigned long long)result.cycles, result.seconds, EscapeJson(result.serialOutput).c_str());
+        if (!result.errorMessage.empty())
+            fprintf(file, ", \"error\": \"%s\"", EscapeJson(result.errorMessage).c_str());
+        fprintf(file, "}%s\n", i + 1 < results.size() ? "," : "");
+    }
+
+    fprintf(file, "  ]\n");
+    fprintf(file, "}\n");
+
+    bool success = !ferror(file);
+    fclose(file);
+    return success;
+}
+
+
+bool TestRunner::WriteJUnitReport(const std::string &filename) const
+{
+    FILE *file = fopen(filename.c_str(), "w");
+    if (file == NULL)
+    {
+        LogError("Error opening report %s: %s", filename.c_str(), strerror(errno));
+        return false;
+    }
+
+    fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    fprintf(file, "<testsuite name=\"zlgb\" tests=\"%zu\" failures=\"%u\" errors=\"%u\" time=\"%.3f\">\n",
+            results.size(), GetResultCount(HeadlessEmulator::eResultFail) + GetResultCount(HeadlessEmulator::eResultTimeout),
+            GetResultCount(HeadlessEmulator::eResultError), totalSeconds);
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const TestResult &result = results[i];
+        fprintf(file, "  <testcase name=\"%s\" time=\"%.3f\">\n", EscapeXml(tests[i].name).c_str(), result.seconds);
+
+        switch (result.result)
+        {
+            case HeadlessEmulator::eResultFail:
+                fprintf(file, "    <failure message=\"Serial output matched the fail pattern\"/>\n");
+                break;
+            case HeadlessEmulator::eResultTimeout:
+                fprintf(file, "    <failure message=\"Timed out after %llu cycles\"/>\n", (unsigned long long)result.cycles);
+                break;
+            case HeadlessEmulator::eResultError:
+                fprintf(file, "    <error message=\"%s\"/>\n", EscapeXml(result.errorMessage).c_str());
+                break;
+            default:
+                break;
+        }
+
+        fprintf(file, "    <system-out>%s</system-out>\n", EscapeXml(result.serialOutput).c_str());
+        fprintf(file, "  </testcase>\n");
+    }
+
+    fprintf(file, "</testsuite>\n");
+
+    bool success = !ferror(file);
+    fclose(file);
+    return success;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "HeadlessEmulator.h"
+
+
+// Runs a manifest of test ROMs in parallel, one HeadlessEmulator per ROM.
+//
+// Manifest files have one test per line, with tab separated fields:
+//
+//   ROM  CYCLES  PASS  FAIL
+//
+// CYCLES is the machine cycle budget, and PASS and FAIL are serial output patterns. Trailing fields can be left out.
+// Relative ROM paths are relative to the manifest. Empty lines and lines starting with # are ignored.
+class TestRunner
+{
+public:
+    struct Test
+    {
+        std::string name;
+        HeadlessEmulator::Options options;
+    };
+
+    struct TestResult
+    {
+        HeadlessEmulator::Result result;
+        std::string serialOutput;
+        std::string errorMessage;
+        uint64_t cycles;
+        double seconds;
+    };
+
+    // Called from worker threads as each test finishes. Calls are serialized.
+    typedef std::function<void(const Test &test, const TestResult &result)> ResultCallback;
+
+    TestRunner();
+
+    // Options for every test are copied from baseOptions, then the ROM, cycle budget, and patterns are set from the
+    // manifest.
+    bool LoadManifest(const std::string &filename, const HeadlessEmulator::Options &baseOptions, uint64_t defaultCycles);
+    void AddTest(const Test &test) {tests.push_back(test);}
+
+    // Runs all tests using threadCount threads, or one thread per core if threadCount is 0.
+    void Run(unsigned threadCount, ResultCallback callback);
+
+    bool WriteJsonReport(const std::string &filename) const;
+    bool WriteJUnitReport(const std::string &filename) const;
+
+    const std::vector<Test> &GetTests() const {return tests;}
+    const std::vector<TestResult> &GetResults() const {return results;}
+    unsigned GetResultCount(HeadlessEmulator::Result result) const;
+    double GetTotalSeconds() const {return totalSeconds;}
+
+private:
+    std::vector<Test> tests;
+    std::vector<TestResult> results;
+    double totalSeconds;
+};
\ No newline at end of file
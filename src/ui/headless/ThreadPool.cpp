@@ -0,0 +1,75 @@
+#include "ThreadPool.h"
+
+
+ThreadPool::ThreadPool(unsigned threadCount) :
+    threads(),
+    jobs(),
+    activeJobs(0),
+    quit(false)
+{
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (unsigned i = 0; i < threadCount; i++)
+        threads.push_back(std::thread(&ThreadPool::ThreadFunc, this));
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    WaitForJobs();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    jobAdded.notify_all();
+
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+
+void ThreadPool::AddJob(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push(std::move(job));
+    }
+    jobAdded.notify_one();
+}
+
+
+void ThreadPool::WaitForJobs()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    jobFinished.wait(lock, [this]() {return jobs.empty() && activeJobs == 0;});
+}
+
+
+void ThreadPool::ThreadFunc()
+{
+    while (true)
+    {
+        std::function<void()> job;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAdded.wait(lock, [this]() {return quit || !jobs.empty();});
+            if (jobs.empty())
+                return;
+
+            job = std::move(jobs.front());
+            jobs.pop();
+            activeJobs++;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeJobs--;
+        }
+        jobFinished.notify_all();
+    }
+}
\ No newline at end of file
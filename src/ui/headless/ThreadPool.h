@@ -0,0 +1,40 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+// Fixed size pool of worker threads that run queued jobs in the order they were added.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(unsigned threadCount);
+    ~ThreadPool();
+
+    void AddJob(std::function<void()> job);
+
+    // Blocks until the queue is empty and no jobs are running.
+    void WaitForJobs();
+
+    unsigned GetThreadCount() const {return threads.size();}
+
+    // Don't allow copy and assignment.
+    ThreadPool(const ThreadPool&) = delete;
+    void operator=(const ThreadPool&) = delete;
+
+private:
+    void ThreadFunc();
+
+    std::vector<std::thread> threads;
+    std::queue<std::function<void()>> jobs;
+    unsigned activeJobs;
+    bool quit;
+
+    std::mutex mutex;
+    std::condition_variable jobAdded;
+    std::condition_variable jobFinished;
+};
\ No newline at end of file
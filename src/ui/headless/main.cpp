@@ -0,0 +1,475 @@
+#include <algorithm>
+#include <chrono>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+#include "core/LinkCable.h"
+#include "core/Logger.h"
+#include "core/SocketLink.h"
+
+#include "HeadlessEmulator.h"
+#include "TestRunner.h"
+
+// Exit codes, so scripts can tell results apart without parsing output.
+const int EXIT_PASS = 0;
+const int EXIT_FAIL = 1;
+const int EXIT_TIMEOUT = 2;
+const int EXIT_ERROR = 3;
+
+
+class StderrLoggerOutput : public LoggerOutput
+{
+public:
+    virtual void Output(std::unique_ptr<LogEntry> entry)
+    {
+        fprintf(stderr, "%s\n", entry->message.c_str());
+    }
+};
+
+
+void PrintUsage(const char *name)
+{
+    printf("Usage: %s [options] romfile\n", name);
+    printf("       %s [options] --manifest FILE\n", name);
+    printf("  -f, --frames N         Stop after N frames\n");
+    printf("  -c, --cycles N         Stop after N machine cycles\n");
+    printf("  -p, --pass PATTERN     Stop and exit with %d when the serial output ends with PATTERN\n", EXIT_PASS);
+    printf("  -F, --fail PATTERN     Stop and exit with %d when the serial output ends with PATTERN\n", EXIT_FAIL);
+    printf("  -s, --serial FILE      Write serial output to FILE, or stdout if FILE is -\n");
+    printf("  -d, --dump-frame FILE  Write the final frame to FILE as a PPM image\n");
+    printf("  -S, --dump-state FILE  Write the final state to FILE as a save state\n");
+    printf("  -T, --load-state FILE  Load the save state in FILE before running\n");
+    printf("  -b, --boot-rom FILE    Run the boot ROM in FILE before the game\n");
+    printf("  -r, --save-ram         Load and save battery backed RAM next to the ROM\n");
+    printf("  -w, --rewind MIB       Keep up to MIB MiB of rewind history, and print how much it holds\n");
+    printf("  -W, --rewind-frames N  Step back N frames at the end of the run, before writing output files\n");
+    printf("  -a, --run-ahead N      Run N frames ahead of each frame and show the last one, and print how many\n");
+    printf("                         frames ahead would fit in a frame\n");
+    printf("  -k, --frame-skip N     Only draw every Nth frame, or none if N is 0, like fast-forward. --dump-frame\n");
+    printf("                         writes the last frame that was drawn\n");
+    printf("  -M, --record-movie FILE  Record the buttons on every frame to FILE, from power on or from the\n");
+    printf("                         state loaded with --load-state\n");
+    printf("  -P, --play-movie FILE  Play the movie in FILE as fast as possible. Without --frames or --cycles,\n");
+    printf("                         stop at its end\n");
+    printf("  -H, --hash-states FILE Write a hash of the state at the end of every frame to FILE, for comparing\n");
+    printf("                         runs with zlgb_hashdiff\n");
+    printf("  -v, --verbose          Print log messages to stderr, repeat for more detail\n");
+    printf("\n");
+    printf("  -l, --link FILE        Run FILE as a second instance, connected with a link cable\n");
+    printf("  -L, --link-listen ADDR Wait for another process to connect a link cable to ADDR, a TCP port on\n");
+    printf("                         localhost or a Unix socket path\n");
+    printf("  -C, --link-connect ADDR  Connect a link cable to another process listening on ADDR\n");
+    printf("  -R, --rollback         Don't wait for the other process on transfers. Predict its reply, and roll\n");
+    printf("                         back if the prediction was wrong\n");
+    printf("  -Q, --link-quantum N   Don't let either linked instance run more than N cycles ahead of the other\n");
+    printf("\n");
+    printf("  -m, --manifest FILE    Run all tests in FILE in parallel. Each line is a tab separated list of\n");
+    printf("                         ROM, cycle budget, pass pattern, and fail pattern. --cycles sets the\n");
+    printf("                         default cycle budget\n");
+    printf("  -j, --jobs N           Run N tests at a time, defaults to the number of cores\n");
+    printf("  -J, --json FILE        Write a JSON summary of the manifest results to FILE\n");
+    printf("  -U, --junit FILE       Write a JUnit XML summary of the manifest results to FILE\n");
+    printf("\n");
+    printf("Exit status is %d on pass or when a limit is reached with no patterns given, %d on fail,\n", EXIT_PASS, EXIT_FAIL);
+    printf("%d when a limit is reached before a pattern matched, and %d on error.\n", EXIT_TIMEOUT, EXIT_ERROR);
+    printf("With a manifest, the exit status is the worst status of all tests.\n");
+}
+
+
+int GetExitCode(HeadlessEmulator::Result result)
+{
+    switch (result)
+    {
+        case HeadlessEmulator::eResultComplete:
+        case HeadlessEmulator::eResultPass:
+            return EXIT_PASS;
+        case HeadlessEmulator::eResultFail:
+            return EXIT_FAIL;
+        case HeadlessEmulator::eResultTimeout:
+            return EXIT_TIMEOUT;
+        default:
+            return EXIT_ERROR;
+    }
+}
+
+
+int RunManifest(const std::string &manifestFilename, const HeadlessEmulator::Options &options, uint64_t defaultCycles,
+                unsigned jobs, const std::string &jsonFilename, const std::string &junitFilename)
+{
+    TestRunner runner;
+    if (!runner.LoadManifest(manifestFilename, options, defaultCycles))
+    {
+        fprintf(stderr, "Error loading manifest %s\n", manifestFilename.c_str());
+        return EXIT_ERROR;
+    }
+
+    int exitCode = EXIT_PASS;
+
+    runner.Run(jobs, [&exitCode](const TestRunner::Test &test, const TestRunner::TestResult &result)
+    {
+        printf("%-8s %s (%llu cycles, %.2fs)\n", HeadlessEmulator::GetResultString(result.result), test.name.c_str(),
+               (unsigned long long)result.cycles, result.seconds);
+        if (result.result == HeadlessEmulator::eResultError)
+            printf("         %s\n", result.errorMessage.c_str());
+        fflush(stdout);
+
+        exitCode = std::max(exitCode, GetExitCode(result.result));
+    });
+
+    printf("%zu tests, %u passed, %u failed, %u timed out, %u errors in %.2fs\n", runner.GetTests().size(),
+           runner.GetResultCount(HeadlessEmulator::eResultPass) + runner.GetResultCount(HeadlessEmulator::eResultComplete),
+           runner.GetResultCount(HeadlessEmulator::eResultFail), runner.GetResultCount(HeadlessEmulator::eResultTimeout),
+           runner.GetResultCount(HeadlessEmulator::eResultError), runner.GetTotalSeconds());
+
+    if (!jsonFilename.empty() && !runner.WriteJsonReport(jsonFilename))
+    {
+        fprintf(stderr, "Error writing %s\n", jsonFilename.c_str());
+        exitCode = EXIT_ERROR;
+    }
+
+    if (!junitFilename.empty() && !runner.WriteJUnitReport(junitFilename))
+    {
+        fprintf(stderr, "Error writing %s\n", junitFilename.c_str());
+        exitCode = EXIT_ERROR;
+    }
+
+    return exitCode;
+}
+
+
+int RunLinked(const HeadlessEmulator::Options &options, const std::string &linkRomFilename, uint quantum)
+{
+    LinkCable cable(quantum * 4);
+
+    HeadlessEmulator::Options linkOptions[2] = {options, options};
+    linkOptions[1].romFilename = linkRomFilename;
+    linkOptions[1].serialFilename.clear();
+    linkOptions[1].frameFilename.clear();
+    linkOptions[1].stateFilename.clear();
+    linkOptions[1].loadStateFilename.clear();
+    linkOptions[1].recordMovieFilename.clear();
+    linkOptions[1].playMovieFilename.clear();
+    linkOptions[1].stateHashFilename.clear();
+
+    HeadlessEmulator::Result results[2];
+    uint64_t clocksRun[2];
+    std::string errorMessages[2];
+
+    auto run = [&](int index)
+    {
+        linkOptions[index].link = cable.GetPort(index);
+        linkOptions[index].logPrefix = std::to_string(index + 1) + ": ";
+
+        HeadlessEmulator emulator(linkOptions[index]);
+        results[index] = emulator.Run();
+        clocksRun[index] = emulator.GetClocksRun();
+        errorMessages[index] = emulator.GetErrorMessage();
+
+        // Let the other instance keep running without waiting on this one.
+        cable.Disconnect(index);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread thread0(run, 0);
+    std::thread thread1(run, 1);
+    thread0.join();
+    thread1.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int exitCode = EXIT_PASS;
+    for (int i = 0; i < 2; i++)
+    {
+        LinkCable::Stats stats = cable.GetStats(i);
+        fprintf(stderr, "%s: %s after %llu cycles\n", linkOptions[i].romFilename.c_str(),
+                HeadlessEmulator::GetResultString(results[i]), (unsigned long long)clocksRun[i] / 4);
+        fprintf(stderr, "    %llu transfers, %llu syncs, blocked %llu times for %.3fs of %.3fs\n",
+                (unsigned long long)stats.transfers, (unsigned long long)stats.syncs, (unsigned long long)stats.waits,
+                stats.waitNanoseconds / 1e9, seconds);
+        if (results[i] == HeadlessEmulator::eResultError)
+            fprintf(stderr, "    %s\n", errorMessages[i].c_str());
+
+        exitCode = std::max(exitCode, GetExitCode(results[i]));
+    }
+
+    return exitCode;
+}
+
+
+int RunSocketLinked(HeadlessEmulator::Options &options, const std::string &address, bool listen, uint quantum,
+                    bool rollback)
+{
+    SocketLink link(quantum * 4, rollback);
+    if (!(listen ? link.Listen(address) : link.Connect(address)))
+    {
+        fprintf(stderr, "Error connecting link cable on %s\n", address.c_str());
+        return EXIT_ERROR;
+    }
+
+    options.link = &link;
+
+    auto start = std::chrono::steady_clock::now();
+    HeadlessEmulator::Result result;
+    uint64_t clocksRun;
+    std::string errorMessage;
+    {
+        HeadlessEmulator emulator(options);
+        result = emulator.Run();
+        clocksRun = emulator.GetClocksRun();
+        errorMessage = emulator.GetErrorMessage();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Let the other process keep running without waiting on this one.
+    link.Disconnect();
+
+    SocketLink::Stats stats = link.GetStats();
+    fprintf(stderr, "%s: %s after %llu cycles\n", options.romFilename.c_str(), HeadlessEmulator::GetResultString(result),
+            (unsigned long long)clocksRun / 4);
+    fprintf(stderr, "    %llu transfers, %llu syncs, blocked %llu times for %.3fs of %.3fs\n",
+            (unsigned long long)stats.transfers, (unsigned long long)stats.syncs, (unsigned long long)stats.waits,
+            stats.waitNanoseconds / 1e9, seconds);
+    if (rollback)
+        fprintf(stderr, "    %llu predicted transfers, %llu rollbacks\n", (unsigned long long)stats.predictions,
+                (unsigned long long)stats.rollbacks);
+    if (result == HeadlessEmulator::eResultError)
+        fprintf(stderr, "    %s\n", errorMessage.c_str());
+
+    return GetExitCode(result);
+}
+
+
+int main(int argc, char *argv[])
+{
+    HeadlessEmulator::Options options;
+    int verbosity = 0;
+    uint64_t cycles = 0;
+    std::string manifestFilename;
+    unsigned jobs = 0;
+    std::string jsonFilename;
+    std::string junitFilename;
+    std::string linkRomFilename;
+    uint linkQuantum = LinkCable::DEFAULT_QUANTUM / 4;
+    std::string linkAddress;
+    bool linkListen = false;
+    bool linkRollback = false;
+
+    const struct option longOptions[] = {
+        {"frames", required_argument, NULL, 'f'},
+        {"cycles", required_argument, NULL, 'c'},
+        {"pass", required_argument, NULL, 'p'},
+        {"fail", required_argument, NULL, 'F'},
+        {"serial", required_argument, NULL, 's'},
+        {"dump-frame", required_argument, NULL, 'd'},
+        {"dump-state", required_argument, NULL, 'S'},
+        {"load-state", required_argument, NULL, 'T'},
+        {"boot-rom", required_argument, NULL, 'b'},
+        {"save-ram", no_argument, NULL, 'r'},
+        {"rewind", required_argument, NULL, 'w'},
+        {"rewind-frames", required_argument, NULL, 'W'},
+        {"run-ahead", required_argument, NULL, 'a'},
+        {"frame-skip", required_argument, NULL, 'k'},
+        {"record-movie", required_argument, NULL, 'M'},
+        {"play-movie", required_argument, NULL, 'P'},
+        {"hash-states", required_argument, NULL, 'H'},
+        {"verbose", no_argument, NULL, 'v'},
+        {"link", required_argument, NULL, 'l'},
+        {"link-listen", required_argument, NULL, 'L'},
+        {"link-connect", required_argument, NULL, 'C'},
+        {"rollback", no_argument, NULL, 'R'},
+        {"link-quantum", required_argument, NULL, 'Q'},
+        {"manifest", required_argument, NULL, 'm'},
+        {"jobs", required_argument, NULL, 'j'},
+        {"json", required_argument, NULL, 'J'},
+        {"junit", required_argument, NULL, 'U'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "f:c:p:F:s:d:S:T:b:rw:W:a:k:M:P:H:vl:L:C:RQ:m:j:J:U:h", longOptions, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'f':
+                options.maxFrames = strtoull(optarg, NULL, 0);
+                break;
+            case 'c':
+                // Convert machine cycles to clocks.
+                cycles = strtoull(optarg, NULL, 0);
+                options.maxClocks = cycles * 4;
+                break;
+            case 'p':
+                options.passPattern = optarg;
+                break;
+            case 'F':
+                options.failPattern = optarg;
+                break;
+            case 's':
+                options.serialFilename = optarg;
+                break;
+            case 'd':
+                options.frameFilename = optarg;
+                break;
+            case 'S':
+                options.stateFilename = optarg;
+                break;
+            case 'T':
+                options.loadStateFilename = optarg;
+                break;
+            case 'b':
+                options.bootRomFilename = optarg;
+                break;
+            case 'r':
+                options.persistRam = true;
+                break;
+            case 'w':
+                options.rewindBufferSize = strtoull(optarg, NULL, 0) * 1024 * 1024;
+                break;
+            case 'W':
+                options.rewindFrames = strtoul(optarg, NULL, 0);
+                break;
+            case 'a':
+                options.runAheadFrames = strtoul(optarg, NULL, 0);
+                break;
+            case 'k':
+                options.renderInterval = strtoul(optarg, NULL, 0);
+                break;
+            case 'M':
+                options.recordMovieFilename = optarg;
+                break;
+            case 'P':
+                options.playMovieFilename = optarg;
+                break;
+            case 'H':
+                options.stateHashFilename = optarg;
+                break;
+            case 'v':
+                verbosity++;
+                break;
+            case 'l':
+                linkRomFilename = optarg;
+                break;
+            case 'L':
+            case 'C':
+                linkAddress = optarg;
+                linkListen = c == 'L';
+                break;
+            case 'R':
+                linkRollback = true;
+                break;
+            case 'Q':
+                linkQuantum = strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                manifestFilename = optarg;
+                break;
+            case 'j':
+                jobs = strtoul(optarg, NULL, 0);
+                break;
+            case 'J':
+                jsonFilename = optarg;
+                break;
+            case 'U':
+                junitFilename = optarg;
+                break;
+            default:
+                PrintUsage(argv[0]);
+                return c == 'h' ? EXIT_PASS : EXIT_ERROR;
+        }
+    }
+
+    StderrLoggerOutput loggerOutput;
+    if (verbosity > 0)
+    {
+        Logger::SetOutput(&loggerOutput);
+        Logger::SetLogLevel(verbosity == 1 ? LogLevel::eInfo : LogLevel::eDebug);
+        options.loggerOutput = &loggerOutput;
+        options.logLevel = Logger::GetLogLevel();
+    }
+
+    if (!manifestFilename.empty())
+    {
+        // Patterns, limits, and output files given on the command line don't apply to manifest tests.
+        options.passPattern.clear();
+        options.failPattern.clear();
+        options.maxFrames = 0;
+        options.serialFilename.clear();
+        options.frameFilename.clear();
+        options.stateFilename.clear();
+        options.loadStateFilename.clear();
+        options.recordMovieFilename.clear();
+        options.playMovieFilename.clear();
+        options.stateHashFilename.clear();
+        int exitCode = RunManifest(manifestFilename, options, cycles, jobs, jsonFilename, junitFilename);
+        Logger::SetOutput(NULL);
+        return exitCode;
+    }
+
+    if (optind >= argc)
+    {
+        PrintUsage(argv[0]);
+        return EXIT_ERROR;
+    }
+    options.romFilename = argv[optind];
+
+    // Without any limit or pattern, the ROM would run forever.
+    if (options.maxFrames == 0 && options.maxClocks == 0 && options.passPattern.empty() && options.failPattern.empty() &&
+        options.playMovieFilename.empty())
+    {
+        fprintf(stderr, "At least one of --frames, --cycles, --pass, --fail, or --play-movie is required\n");
+        return EXIT_ERROR;
+    }
+
+    if (!linkRomFilename.empty())
+    {
+        int exitCode = RunLinked(options, linkRomFilename, linkQuantum);
+        Logger::SetOutput(NULL);
+        return exitCode;
+    }
+
+    if (!linkAddress.empty())
+    {
+        int exitCode = RunSocketLinked(options, linkAddress, linkListen, linkQuantum, linkRollback);
+        Logger::SetOutput(NULL);
+        return exitCode;
+    }
+
+    HeadlessEmulator emulator(options);
+    auto start = std::chrono::steady_clock::now();
+    HeadlessEmulator::Result result = emulator.Run();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    fprintf(stderr, "%s: %s after %llu cycles\n", options.romFilename.c_str(), HeadlessEmulator::GetResultString(result),
+            (unsigned long long)emulator.GetClocksRun() / 4);
+    if (result == HeadlessEmulator::eResultError)
+        fprintf(stderr, "%s\n", emulator.GetErrorMessage().c_str());
+
+    if (!options.playMovieFilename.empty() && result != HeadlessEmulator::eResultError)
+        fprintf(stderr, "    played movie in %.3fs, %.1fx real time\n", seconds,
+                seconds > 0 ? emulator.GetClocksRun() / (double)CLOCKS_PER_SECOND / seconds : 0.0);
+
+    if (options.rewindBufferSize)
+    {
+        const RewindBuffer::Stats &stats = emulator.GetRewindStats();
+        fprintf(stderr, "    rewind holds %u frames (%.1fs) in %zu of %zu KiB\n", stats.frames, stats.frames / 60.0,
+                stats.bytesUsed / 1024, stats.capacity / 1024);
+        fprintf(stderr, "    %llu captures, %.1fus average, %.1fus max\n", (unsigned long long)stats.captures,
+                stats.captures ? stats.totalCaptureNanoseconds / 1e3 / stats.captures : 0.0,
+                stats.maxCaptureNanoseconds / 1e3);
+    }
+
+    if (options.runAheadFrames)
+    {
+        const EmulatorMgr::RunAheadStats &stats = emulator.GetRunAheadStats();
+        fprintf(stderr, "    ran %u frames ahead %llu times, %.1fus average, %.1fus max\n", stats.frames,
+                (unsigned long long)stats.hostFrames, stats.hostFrames ? stats.totalNanoseconds / 1e3 / stats.hostFrames : 0.0,
+                stats.maxNanoseconds / 1e3);
+        fprintf(stderr, "    %u frames ahead would fit in a frame\n", stats.affordableFrames);
+    }
+
+    Logger::SetOutput(NULL);
+
+    return GetExitCode(result);
+}
\ No newline at end of file
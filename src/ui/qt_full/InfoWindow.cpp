@@ -9,7 +9,6 @@
 
 #include "core/Memory.h"
 
-const uint8_t palette[4][3] = {{0xFF, 0xFF, 0xFF}, {0xB0, 0xB0, 0xB0}, {0x68, 0x68, 0x68}, {0x00, 0x00, 0x00}};
 const int SCALE = 3;
 const QMap<MbcTypes, QString> MBC_NAMES {
     {eMbcNone, "None"},
@@ -28,7 +27,8 @@ InfoWindow::InfoWindow(QWidget *parent) :
     ramBanks(0),
     mappedRomBank(0),
     mappedRamBank(0),
-    batteryBackedRam(false)
+    batteryBackedRam(false),
+    palette()
 {
     ui->setupUi(this);
 
@@ -89,7 +89,8 @@ void InfoWindow::UpdateTileView()
     if (memory != NULL)
     {
         const uint8_t * const tilesetData = &memory[0x8000];
-        const uint8_t regBGP = memory[eRegBGP];
+        palette.SetRegister(memory[eRegBGP]);
+        const uint32_t * const colors = palette.GetColors();
 
         for (int tile = 0; tile < 384; tile++)
         {
@@ -104,9 +105,7 @@ void InfoWindow::UpdateTileView()
                     const uint8_t lowBit = ((tileData[0] >> (7 - x)) & 0x01);
                     const uint8_t highBit = ((tileData[1] >> (7 - x)) & 0x01);
                     const uint8_t pixelVal = lowBit | (highBit << 1);
-                    const uint8_t * const color = ::palette[(regBGP >> (pixelVal * 2)) & 0x03];
-
-                    img.setPixel(x, y, (color[0] << 16) | (color[1] << 8) | color[2]);
+                    img.setPixel(x, y, colors[pixelVal]);
                 }
             }
 
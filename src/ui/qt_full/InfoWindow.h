@@ -3,6 +3,7 @@
 #include <QtWidgets/QDialog>
 
 #include "core/InfoInterface.h"
+#include "core/Palette.h"
 
 namespace Ui {
 class InfoWindow;
@@ -26,6 +27,9 @@ public:
     virtual void SetMappedRamBank(int bank) {mappedRamBank = bank;}
     virtual void SetBatteryBackedRam(bool hasBattery) {batteryBackedRam = hasBattery;}
 
+    // Tiles are drawn in the same colors as the screen.
+    void SetShades(Palette::Shades shades) {palette.SetShades(shades);}
+
     void DrawFrame();
 
 protected:
@@ -47,6 +51,8 @@ private:
     int mappedRamBank;
     bool batteryBackedRam;
 
+    Palette palette;
+
 private slots:
     void SlotDrawFrame();
 
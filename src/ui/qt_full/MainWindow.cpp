@@ -1,6 +1,5 @@
 #include <QtWidgets/QtWidgets>
 #include <stdint.h>
-#include <thread>
 
 #include "debugger/DebuggerWindow.h"
 #include "InfoWindow.h"
@@ -24,19 +23,30 @@ MainWindow::MainWindow(QWidget *parent) :
     emulator(NULL),
     fpsTimer(),
     frameCount(0),
+    droppedFrames(0),
+    frameSignalPending(false),
+    screenPixmap(),
+    screenItem(NULL),
     frameCapTimer(),
     frameCapSetting(60),
+    fastForwardInterval(EmulatorMgr::DEFAULT_FAST_FORWARD_INTERVAL),
+    fastForwardAudio(false),
 #ifdef QT_GAMEPAD_LIB
     gamepad(NULL),
 #endif
+    displayShades(Palette::eShadesGray),
     infoWindow(NULL),
     displayInfoWindowAction(NULL),
     logWindow(NULL),
     displayLogWindowAction(NULL),
     debuggerWindow(NULL),
     displayDebuggerWindowAction(NULL),
+    emuFastForwardAction(NULL),
     emuSaveStateAction(NULL),
     emuLoadStateAction(NULL),
+    emuRecordTraceAction(NULL),
+    emuRecordMovieAction(NULL),
+    emuPlayMovieAction(NULL),
     audioEnabled(true),
     audioOutput(NULL),
     audioBuffer(NULL),
@@ -48,6 +58,9 @@ MainWindow::MainWindow(QWidget *parent) :
 
     QSettings settings;
     displayScale = settings.value(SETTINGS_VIDEO_SCALE, 5).toInt();
+    const int shadesSetting = settings.value(SETTINGS_VIDEO_SHADES, Palette::eShadesGray).toInt();
+    if (shadesSetting >= 0 && shadesSetting < Palette::eShadesCount)
+        displayShades = static_cast<Palette::Shades>(shadesSetting);
 
     // Setup logger before anything else.
     Logger::SetLogLevel(static_cast<LogLevel>(settings.value(SETTINGS_LOGGER_LEVEL, 0).toInt()));
@@ -71,6 +84,7 @@ MainWindow::MainWindow(QWidget *parent) :
     graphicsView->setScene(scene);
 
     infoWindow = new InfoWindow(this);
+    infoWindow->SetShades(displayShades);
     if (settings.value(SETTINGS_INFOWINDOW_DISPLAY, false).toBool())
         infoWindow->show();
 
@@ -82,6 +96,11 @@ MainWindow::MainWindow(QWidget *parent) :
     frameCapTimer.start();
 
     emulator = new EmulatorMgr(this, this, infoWindow, debuggerWindow, this);
+    emulator->SetRewindBuffer(RewindBuffer::DEFAULT_CAPACITY);
+    emulator->SetRunAhead(settings.value(SETTINGS_EMULATOR_RUNAHEAD, 0).toUInt());
+    emulator->SetFrameRate(FRAMES_PER_SECOND * frameCapSetting / 60);
+    emulator->SetAudioPacing(settings.value(SETTINGS_EMULATOR_AUDIOSYNC, false).toBool());
+    emulator->SetShades(displayShades);
 
     if (qApp->arguments().size() >= 2)
     {
@@ -94,6 +113,7 @@ MainWindow::MainWindow(QWidget *parent) :
 
     connect(this, SIGNAL(SignalFrameReady()), this, SLOT(SlotDrawFrame()));
     connect(this, SIGNAL(SignalShowMessageBox(const QString&)), this, SLOT(SlotShowMessageBox(const QString &)));
+    connect(this, SIGNAL(SignalSaveStateComplete(const QString&, bool)), this, SLOT(SlotSaveStateComplete(const QString&, bool)));
 }
 
 
@@ -112,6 +132,12 @@ void MainWindow::keyPressEvent(QKeyEvent *event)
     {
         emulator->ButtonPressed(button);
     }
+    else if (event->key() == Qt::Key_Backspace)
+    {
+        // Holding backspace steps back one frame at a time.
+        if (!event->isAutoRepeat())
+            emulator->SetRewinding(true);
+    }
     else
     {
         QMainWindow::keyPressEvent(event);
@@ -126,6 +152,19 @@ void MainWindow::keyReleaseEvent(QKeyEvent *event)
     {
         emulator->ButtonReleased(button);
     }
+    else if (event->key() == Qt::Key_Backspace)
+    {
+        if (!event->isAutoRepeat())
+        {
+            emulator->SetRewinding(false);
+
+            RewindBuffer::Stats stats = emulator->GetRewindStats();
+            statusBar()->showMessage(QString("Rewind: %1s of history in %2 KiB, capture %3us average, %4us max")
+                                     .arg(stats.frames / 60.0, 0, 'f', 1).arg(stats.bytesUsed / 1024)
+                                     .arg(stats.captures ? stats.totalCaptureNanoseconds / 1e3 / stats.captures : 0.0, 0, 'f', 1)
+                                     .arg(stats.maxCaptureNanoseconds / 1e3, 0, 'f', 1), 5000);
+        }
+    }
     else
     {
         QMainWindow::keyReleaseEvent(event);
@@ -222,6 +261,65 @@ void MainWindow::SetupMenuBar()
         connect(emuSpeedActions[i], SIGNAL(triggered()), this, SLOT(SlotSetFpsCap()));
     }
 
+    // Emulator | Speed | Sync to Audio
+    emuSpeedMenu->addSeparator();
+    QAction *emuAudioSyncAction = new QAction("Sync to &Audio", this);
+    emuAudioSyncAction->setCheckable(true);
+    emuAudioSyncAction->setChecked(settings.value(SETTINGS_EMULATOR_AUDIOSYNC, false).toBool());
+    emuSpeedMenu->addAction(emuAudioSyncAction);
+    connect(emuAudioSyncAction, SIGNAL(triggered(bool)), this, SLOT(SlotSetAudioSync(bool)));
+
+    // Emulator | Fast Forward
+    emuFastForwardAction = new QAction("&Fast Forward", this);
+    emuFastForwardAction->setShortcut(Qt::Key_Tab);
+    emuFastForwardAction->setCheckable(true);
+    emuMenu->addAction(emuFastForwardAction);
+    connect(emuFastForwardAction, SIGNAL(triggered()), this, SLOT(SlotSetFastForward()));
+
+    // Emulator | Fast Forward Options
+    QMenu *emuFastForwardMenu = emuMenu->addMenu("Fast Forward &Options");
+    QActionGroup *emuFastForwardGroup = new QActionGroup(this);
+    fastForwardInterval = settings.value(SETTINGS_EMULATOR_FASTFORWARDINTERVAL,
+                                         EmulatorMgr::DEFAULT_FAST_FORWARD_INTERVAL).toUInt();
+    std::pair<std::string, uint> intervalVals[4] = {{"Show Every &4th Frame", 4}, {"Show Every &8th Frame", 8},
+                                                    {"Show Every &16th Frame", 16}, {"Show &No Frames", 0}};
+    for (int i = 0; i < 4; i++)
+    {
+        QAction *action = new QAction(intervalVals[i].first.c_str(), this);
+        action->setCheckable(true);
+        action->setData(intervalVals[i].second);
+        if (intervalVals[i].second == fastForwardInterval)
+            action->setChecked(true);
+        emuFastForwardMenu->addAction(action);
+        emuFastForwardGroup->addAction(action);
+        connect(action, SIGNAL(triggered()), this, SLOT(SlotSetFastForwardInterval()));
+    }
+
+    // Emulator | Fast Forward Options | Play Audio
+    emuFastForwardMenu->addSeparator();
+    fastForwardAudio = settings.value(SETTINGS_EMULATOR_FASTFORWARDAUDIO, false).toBool();
+    QAction *emuFastForwardAudioAction = new QAction("Play &Audio", this);
+    emuFastForwardAudioAction->setCheckable(true);
+    emuFastForwardAudioAction->setChecked(fastForwardAudio);
+    emuFastForwardMenu->addAction(emuFastForwardAudioAction);
+    connect(emuFastForwardAudioAction, SIGNAL(triggered(bool)), this, SLOT(SlotSetFastForwardAudio(bool)));
+
+    // Emulator | Run Ahead
+    QMenu *emuRunAheadMenu = emuMenu->addMenu("&Run Ahead");
+    QActionGroup *emuRunAheadGroup = new QActionGroup(this);
+    const uint runAheadSetting = settings.value(SETTINGS_EMULATOR_RUNAHEAD, 0).toUInt();
+    for (uint i = 0; i < 4; i++)
+    {
+        QAction *action = new QAction(i == 0 ? QString("&Off") : QString("&%1 Frame%2").arg(i).arg(i > 1 ? "s" : ""), this);
+        action->setCheckable(true);
+        action->setData(i);
+        if (i == runAheadSetting)
+            action->setChecked(true);
+        emuRunAheadMenu->addAction(action);
+        emuRunAheadGroup->addAction(action);
+        connect(action, SIGNAL(triggered()), this, SLOT(SlotSetRunAhead()));
+    }
+
     // Emulator | Save State
     emuSaveStateAction = new QAction("&Save State", this);
     emuSaveStateAction->setShortcut(Qt::Key_F1);
@@ -236,6 +334,24 @@ void MainWindow::SetupMenuBar()
     emuMenu->addAction(emuLoadStateAction);
     connect(emuLoadStateAction, SIGNAL(triggered()), this, SLOT(SlotLoadState()));
 
+    // Emulator | Record Trace
+    emuRecordTraceAction = new QAction("Record &Trace...", this);
+    emuRecordTraceAction->setCheckable(true);
+    emuMenu->addAction(emuRecordTraceAction);
+    connect(emuRecordTraceAction, SIGNAL(triggered(bool)), this, SLOT(SlotRecordTrace(bool)));
+
+    // Emulator | Record Movie
+    emuRecordMovieAction = new QAction("Record &Movie...", this);
+    emuRecordMovieAction->setCheckable(true);
+    emuMenu->addAction(emuRecordMovieAction);
+    connect(emuRecordMovieAction, SIGNAL(triggered(bool)), this, SLOT(SlotRecordMovie(bool)));
+
+    // Emulator | Play Movie
+    emuPlayMovieAction = new QAction("Pla&y Movie...", this);
+    emuPlayMovieAction->setCheckable(true);
+    emuMenu->addAction(emuPlayMovieAction);
+    connect(emuPlayMovieAction, SIGNAL(triggered(bool)), this, SLOT(SlotPlayMovie(bool)));
+
     ///////////////////////////////////////////////////////////////////////////
 
     // Display Menu
@@ -257,6 +373,23 @@ void MainWindow::SetupMenuBar()
         connect(displaySizeActions[i], SIGNAL(triggered()), this, SLOT(SlotSetDisplayScale()));
     }
 
+    // Display | Colors
+    QMenu *displayShadesMenu = displayMenu->addMenu("&Colors");
+    QActionGroup *displayShadesGroup = new QActionGroup(this);
+    std::pair<std::string, Palette::Shades> shadesVals[Palette::eShadesCount] = {{"&Gray", Palette::eShadesGray},
+                                                                                 {"G&reen", Palette::eShadesGreen}};
+    for (int i = 0; i < Palette::eShadesCount; i++)
+    {
+        QAction *action = new QAction(shadesVals[i].first.c_str(), this);
+        action->setCheckable(true);
+        action->setData(shadesVals[i].second);
+        if (shadesVals[i].second == displayShades)
+            action->setChecked(true);
+        displayShadesMenu->addAction(action);
+        displayShadesGroup->addAction(action);
+        connect(action, SIGNAL(triggered()), this, SLOT(SlotSetDisplayShades()));
+    }
+
     // Display | Info Window
     displayInfoWindowAction = displayMenu->addAction("&Info Window");
     displayInfoWindowAction->setCheckable(true);
@@ -408,6 +541,7 @@ void MainWindow::UpdateRecentFilesActions()
 void MainWindow::SetDisplayScale(int scale)
 {
     graphicsView->scene()->clear();
+    screenItem = NULL;
     graphicsView->setSceneRect(0, 0, SCREEN_X*scale, SCREEN_Y*scale);
     graphicsView->setFixedSize(SCREEN_X*scale, SCREEN_Y*scale);
     adjustSize();
@@ -441,29 +575,18 @@ void MainWindow::OpenRom(const QString &filename)
 }
 
 
-void MainWindow::FrameReady(uint32_t *displayFrameBuffer)
+void MainWindow::FrameReady(const uint32_t *displayFrameBuffer, const ScanlineMask &changedLines)
 {
     // This function runs in the thread context of the Emulator worker thread.
+    (void)displayFrameBuffer;
+    (void)changedLines;
 
-    // Copy data so Emulator thread doesn't change data while we're drawing the screen.
-    memcpy(frameBuffer, displayFrameBuffer, sizeof(frameBuffer));
-
-    // Signal the main thread to draw the screen.
-    emit SignalFrameReady();
-
-    int64_t elapsedTime = frameCapTimer.elapsed();
-
-    if (frameCapSetting > 0)
-    {
-        const float frameMillis = 1.0 / frameCapSetting * 1000;
-
-        if (elapsedTime < frameMillis)
-        {
-            // Block the Emulator from running to limit frame rate.
-            std::this_thread::sleep_for(std::chrono::milliseconds((int)(frameMillis - elapsedTime)));
-        }
-    }
+    // Signal the main thread to draw the screen. It takes the newest frame from the emulator's triple buffer when it
+    // gets to it, so nothing is copied here, and there's no need to signal again until it has.
+    if (!frameSignalPending.exchange(true))
+        emit SignalFrameReady();
 
+    // The emulator waits for the next frame itself, after this returns.
     NotifyGameSpeedObservers(frameCapTimer.elapsed());
 
     frameCapTimer.restart();
@@ -478,6 +601,13 @@ void MainWindow::RequestMessageBox(const std::string &message)
 }
 
 
+void MainWindow::SaveStateComplete(const std::string &filename, bool success)
+{
+    // This function runs in the thread context of the save state writer thread.
+    emit SignalSaveStateComplete(QString::fromStdString(filename), success);
+}
+
+
 void MainWindow::AudioDataReady(const std::array<int16_t, AudioInterface::BUFFER_LEN> &data)
 {
     // This function runs in the thread context of the Emulator worker thread.
@@ -495,6 +625,17 @@ void MainWindow::AudioDataReady(const std::array<int16_t, AudioInterface::BUFFER
 }
 
 
+double MainWindow::GetAudioBufferFill()
+{
+    // This function runs in the thread context of the Emulator worker thread.
+
+    if (audioOutput == NULL || audioOutput->bufferSize() <= 0)
+        return -1;
+
+    return 1 - (double)audioOutput->bytesFree() / audioOutput->bufferSize();
+}
+
+
 void MainWindow::SlotOpenRom()
 {
     QSettings settings;
@@ -541,6 +682,7 @@ void MainWindow::SlotEndEmulation()
 {
     emulator->EndEmulation();
     graphicsView->scene()->clear();
+    screenItem = NULL;
 
     emuSaveStateAction->setEnabled(false);
     emuLoadStateAction->setEnabled(false);
@@ -553,6 +695,60 @@ void MainWindow::SlotSetFpsCap()
     if (action)
     {
         frameCapSetting = action->data().toInt();
+        emulator->SetFrameRate(FRAMES_PER_SECOND * frameCapSetting / 60);
+    }
+}
+
+
+void MainWindow::SlotSetAudioSync(bool checked)
+{
+    emulator->SetAudioPacing(checked);
+
+    QSettings settings;
+    settings.setValue(SETTINGS_EMULATOR_AUDIOSYNC, checked);
+}
+
+
+void MainWindow::SlotSetFastForward()
+{
+    emulator->SetFastForward(emuFastForwardAction->isChecked(), fastForwardInterval, fastForwardAudio);
+}
+
+
+void MainWindow::SlotSetFastForwardInterval()
+{
+    QAction *action = qobject_cast<QAction *>(sender());
+    if (action)
+    {
+        fastForwardInterval = action->data().toUInt();
+        SlotSetFastForward();
+
+        QSettings settings;
+        settings.setValue(SETTINGS_EMULATOR_FASTFORWARDINTERVAL, fastForwardInterval);
+    }
+}
+
+
+void MainWindow::SlotSetFastForwardAudio(bool checked)
+{
+    fastForwardAudio = checked;
+    SlotSetFastForward();
+
+    QSettings settings;
+    settings.setValue(SETTINGS_EMULATOR_FASTFORWARDAUDIO, checked);
+}
+
+
+void MainWindow::SlotSetRunAhead()
+{
+    QAction *action = qobject_cast<QAction *>(sender());
+    if (action)
+    {
+        uint frames = action->data().toUInt();
+        emulator->SetRunAhead(frames);
+
+        QSettings settings;
+        settings.setValue(SETTINGS_EMULATOR_RUNAHEAD, frames);
     }
 }
 
@@ -566,12 +762,31 @@ void MainWindow::SlotQuit()
 
 void MainWindow::SlotDrawFrame()
 {
+    frameSignalPending = false;
+
     uint64_t elapsedTime = fpsTimer.elapsed();
 
     if (elapsedTime > 1000)
     {
         int fps = frameCount / (elapsedTime / 1000.0);
         labelFps->setText(QString::number(fps) + " FPS");
+
+        // Frames finished while the last one was still being drawn are skipped.
+        const uint64_t totalDroppedFrames = emulator->GetDroppedFrames();
+        if (totalDroppedFrames != droppedFrames)
+            labelFps->setText(labelFps->text() + QString(", %1 dropped").arg(totalDroppedFrames - droppedFrames));
+        droppedFrames = totalDroppedFrames;
+
+        // Show how far ahead this machine could run, so the setting can be tuned.
+        EmulatorMgr::RunAheadStats runAheadStats = emulator->GetRunAheadStats();
+        if (runAheadStats.frames)
+            labelFps->setText(labelFps->text() + QString(", run-ahead %1 of %2 frames").arg(runAheadStats.frames)
+                              .arg(runAheadStats.affordableFrames));
+
+        // Movies also stop when the game is reset or a state is loaded, and playback stops at the end of the movie.
+        emuRecordMovieAction->setChecked(emulator->IsMovieRecording());
+        emuPlayMovieAction->setChecked(emulator->IsMoviePlaying());
+
         fpsTimer.restart();
         frameCount = 0;
     }
@@ -580,10 +795,40 @@ void MainWindow::SlotDrawFrame()
         frameCount++;
     }
 
-    QImage img((uchar *)(frameBuffer), 160, 144, QImage::Format_RGB32);
-    graphicsView->scene()->clear();
-    QGraphicsPixmapItem *pixmap = graphicsView->scene()->addPixmap(QPixmap::fromImage(img));
-    pixmap->setScale(displayScale);
+    ScanlineMask changedLines;
+    const uint32_t *frame = emulator->AcquireFrame(&changedLines);
+    if (screenItem == NULL)
+    {
+        screenPixmap = QPixmap(SCREEN_X, SCREEN_Y);
+        screenItem = graphicsView->scene()->addPixmap(screenPixmap);
+        screenItem->setScale(displayScale);
+        changedLines.set();
+    }
+
+    // Only the lines that changed are drawn, a run of lines at a time. Static screens, such as menus, aren't drawn at
+    // all, and the HUD of a scrolling game is left alone.
+    if (changedLines.any())
+    {
+        QImage img((const uchar *)frame, SCREEN_X, SCREEN_Y, QImage::Format_RGB32);
+        QPainter painter(&screenPixmap);
+        uint line = 0;
+        while (line < SCREEN_Y)
+        {
+            if (!changedLines[line])
+            {
+                line++;
+                continue;
+            }
+
+            uint endLine = line + 1;
+            while (endLine < SCREEN_Y && changedLines[endLine])
+                endLine++;
+            painter.drawImage(QPoint(0, line), img, QRect(0, line, SCREEN_X, endLine - line));
+            line = endLine;
+        }
+        painter.end();
+        screenItem->setPixmap(screenPixmap);
+    }
 
     // Only update infoWindow 60 time a second, this stops the program locking up when frame cap is off.
     if ((elapsedTime & 0x0F) == 0)
@@ -615,6 +860,23 @@ void MainWindow::SlotSetDisplayScale()
 }
 
 
+void MainWindow::SlotSetDisplayShades()
+{
+    QAction *action = qobject_cast<QAction *>(sender());
+    if (action)
+    {
+        displayShades = static_cast<Palette::Shades>(action->data().toInt());
+
+        emulator->SetShades(displayShades);
+        infoWindow->SetShades(displayShades);
+        infoWindow->DrawFrame();
+
+        QSettings settings;
+        settings.setValue(SETTINGS_VIDEO_SHADES, displayShades);
+    }
+}
+
+
 void MainWindow::SlotSetDisplayInfoWindow(bool checked)
 {
     QSettings settings;
@@ -675,12 +937,100 @@ void MainWindow::SlotSaveState()
 }
 
 
+void MainWindow::SlotSaveStateComplete(const QString &filename, bool success)
+{
+    if (success)
+        statusBar()->showMessage("Saved state to " + filename, 5000);
+    else
+        UiUtils::MessageBox("Error saving state to " + filename);
+}
+
+
 void MainWindow::SlotLoadState()
 {
     emulator->LoadState(1);
 }
 
 
+void MainWindow::SlotRecordTrace(bool checked)
+{
+    if (!checked)
+    {
+        emulator->StopTrace();
+        statusBar()->showMessage("Trace stopped", 5000);
+        return;
+    }
+
+    QString filename = QFileDialog::getSaveFileName(this, "Record Trace", "", "Trace files (*.trace)");
+    if (filename == "" || !emulator->StartTrace(filename.toStdString()))
+    {
+        emuRecordTraceAction->setChecked(false);
+        return;
+    }
+
+    statusBar()->showMessage("Recording trace to " + filename, 5000);
+}
+
+
+void MainWindow::SlotRecordMovie(bool checked)
+{
+    if (!checked)
+    {
+        if (emulator->StopMovie())
+            statusBar()->showMessage("Movie saved", 5000);
+        else
+            UiUtils::MessageBox("Error saving movie");
+        return;
+    }
+
+    emuPlayMovieAction->setChecked(false);
+
+    QString filename = QFileDialog::getSaveFileName(this, "Record Movie", "", "Movie files (*.movie)");
+    if (filename == "")
+    {
+        emuRecordMovieAction->setChecked(false);
+        return;
+    }
+
+    QMessageBox::StandardButton answer = QMessageBox::question(this, "Record Movie",
+        "Start recording from power on? Otherwise recording starts from the current state.",
+        QMessageBox::Yes | QMessageBox::No);
+    if (!emulator->StartMovieRecording(filename.toStdString(), answer == QMessageBox::Yes))
+    {
+        emuRecordMovieAction->setChecked(false);
+        UiUtils::MessageBox("Error recording movie");
+        return;
+    }
+
+    statusBar()->showMessage("Recording movie to " + filename, 5000);
+}
+
+
+void MainWindow::SlotPlayMovie(bool checked)
+{
+    if (!checked)
+    {
+        emulator->StopMovie();
+        statusBar()->showMessage("Movie stopped", 5000);
+        return;
+    }
+
+    // Starting playback ends a recording, which is saved.
+    emuRecordMovieAction->setChecked(false);
+
+    QString filename = QFileDialog::getOpenFileName(this, "Play Movie", "", "Movie files (*.movie)");
+    if (filename == "" || !emulator->StartMoviePlayback(filename.toStdString()))
+    {
+        emuPlayMovieAction->setChecked(false);
+        if (filename != "")
+            UiUtils::MessageBox("Error playing movie " + filename);
+        return;
+    }
+
+    statusBar()->showMessage("Playing movie " + filename, 5000);
+}
+
+
 void MainWindow::SlotOpenSettings()
 {
     SettingsDialog dialog(this);
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <QtCore/QElapsedTimer>
 #ifdef QT_GAMEPAD_LIB
 #include <QtGamepad/QtGamepad>
 #endif
+#include <QtGui/QPixmap>
 #include <QtMultimedia/QAudioOutput>
+#include <QtWidgets/QGraphicsPixmapItem>
 #include <QtWidgets/QGraphicsView>
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QMainWindow>
@@ -33,9 +36,11 @@ public:
 
     // DisplayInterface functions.
     // Callback for Emulator to signal a frame is ready to be drawn.
-    virtual void FrameReady(uint32_t *displayFrameBuffer);
+    virtual void FrameReady(const uint32_t *displayFrameBuffer, const ScanlineMask &changedLines);
     // Callback for Emulator to show message box.
     virtual void RequestMessageBox(const std::string &message);
+    // Callback for Emulator to report a save state was written.
+    virtual void SaveStateComplete(const std::string &filename, bool success);
 
     // AudioInterface functions.
     virtual void AudioDataReady(const std::array<int16_t, AudioInterface::BUFFER_LEN> &data);
@@ -44,6 +49,7 @@ public:
     virtual AudioInterface::Channels GetEnabledAudioChannels() {return enabledAudioChannels;}
     virtual uint8_t GetAudioVolume() {return audioVolume;}
     virtual int GetGameSpeed() {return frameCapSetting;}
+    virtual double GetAudioBufferFill();
 
     // Don't allow copy and assignment.
     MainWindow(const MainWindow&) = delete;
@@ -77,19 +83,31 @@ private:
     // FPS variables.
     QElapsedTimer fpsTimer;
     int frameCount;
+    uint64_t droppedFrames;
 
-    // Frame cap variables.
+    // Set while a SignalFrameReady() is queued, so frames the main thread can't keep up with aren't queued as well.
+    std::atomic<bool> frameSignalPending;
+    // The screen is kept in a pixmap, and only the lines of a frame that changed are drawn into it. screenItem shows
+    // it in the scene, and is NULL when the scene was cleared, so the whole frame has to be drawn again.
+    QPixmap screenPixmap;
+    QGraphicsPixmapItem *screenItem;
+
+    // Frame cap variables. The emulator paces the frames, frameCapTimer only measures them for the audio.
     QElapsedTimer frameCapTimer;
     int frameCapSetting;
 
+    // Fast-forward settings, see EmulatorMgr::SetFastForward().
+    uint fastForwardInterval;
+    bool fastForwardAudio;
+
     QHash<Qt::Key, Buttons::Button> keyboardBindings;
 #ifdef QT_GAMEPAD_LIB
     QHash<QGamepadManager::GamepadButton, Buttons::Button> gamepadBindings;
     QGamepad *gamepad;
 #endif
 
-    uint32_t frameBuffer[SCREEN_X * SCREEN_Y];
     int displayScale;
+    Palette::Shades displayShades;
 
     InfoWindow *infoWindow;
     QAction *displayInfoWindowAction;
@@ -98,8 +116,12 @@ private:
     DebuggerWindow *debuggerWindow;
     QAction *displayDebuggerWindowAction;
 
+    QAction *emuFastForwardAction;
     QAction *emuSaveStateAction;
     QAction *emuLoadStateAction;
+    QAction *emuRecordTraceAction;
+    QAction *emuRecordMovieAction;
+    QAction *emuPlayMovieAction;
 
     QAction *recentFilesActions[MAX_RECENT_FILES];
 
@@ -117,10 +139,16 @@ private slots:
     void SlotTogglePause(bool checked);
     void SlotEndEmulation();
     void SlotSetFpsCap();
+    void SlotSetAudioSync(bool checked);
+    void SlotSetFastForward();
+    void SlotSetFastForwardInterval();
+    void SlotSetFastForwardAudio(bool checked);
+    void SlotSetRunAhead();
     void SlotQuit();
     void SlotDrawFrame();
     void SlotShowMessageBox(const QString &message);
     void SlotSetDisplayScale();
+    void SlotSetDisplayShades();
     void SlotSetDisplayInfoWindow(bool checked);
     void SlotInfoWindowClosed();
     void SlotSetDisplayLogWindow(bool checked);
@@ -128,7 +156,11 @@ private slots:
     void SlotSetDisplayDebuggerWindow(bool checked);
     void SlotDebuggerWindowClosed();
     void SlotSaveState();
+    void SlotSaveStateComplete(const QString &filename, bool success);
     void SlotLoadState();
+    void SlotRecordTrace(bool checked);
+    void SlotRecordMovie(bool checked);
+    void SlotPlayMovie(bool checked);
     void SlotOpenSettings();
     void SlotAudioStateChanged(QAudio::State state);
 #ifdef QT_GAMEPAD_LIB
@@ -139,4 +171,5 @@ private slots:
 signals:
     void SignalFrameReady();
     void SignalShowMessageBox(const QString &message);
+    void SignalSaveStateComplete(const QString &filename, bool success);
 };
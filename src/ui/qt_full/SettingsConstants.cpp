@@ -14,6 +14,11 @@ const char *SETTINGS_DEBUGGERWINDOW_GEOMETRY = "DebuggerWindow/Geometry";
 const char *SETTINGS_DEBUGGERWINDOW_STATE = "DebuggerWindow/State";
 const char *SETTINGS_DEBUGGERWINDOW_DISPLAY = "DebuggerWindow/Display";
 
+const char *SETTINGS_EMULATOR_RUNAHEAD = "Emulator/RunAhead";
+const char *SETTINGS_EMULATOR_AUDIOSYNC = "Emulator/AudioSync";
+const char *SETTINGS_EMULATOR_FASTFORWARDINTERVAL = "Emulator/FastForwardInterval";
+const char *SETTINGS_EMULATOR_FASTFORWARDAUDIO = "Emulator/FastForwardAudio";
+
 const char *SETTINGS_FILES_OPENROMDIR = "Files/OpenRomDir";
 const char *SETTINGS_FILES_RECENTFILELIST = "Files/RecentFileList";
 
@@ -44,4 +49,5 @@ const char *SETTINGS_LOGWINDOW_DISPLAY = "LogWindow/Display";
 
 const char *SETTINGS_MAINWINDOW_GEOMETRY = "MainWindow/Geometry";
 
-const char *SETTINGS_VIDEO_SCALE = "Video/Scale";
\ No newline at end of file
+const char *SETTINGS_VIDEO_SCALE = "Video/Scale";
+const char *SETTINGS_VIDEO_SHADES = "Video/Shades";
\ No newline at end of file
@@ -14,6 +14,11 @@ extern const char *SETTINGS_DEBUGGERWINDOW_GEOMETRY;
 extern const char *SETTINGS_DEBUGGERWINDOW_STATE;
 extern const char *SETTINGS_DEBUGGERWINDOW_DISPLAY;
 
+extern const char *SETTINGS_EMULATOR_RUNAHEAD;
+extern const char *SETTINGS_EMULATOR_AUDIOSYNC;
+extern const char *SETTINGS_EMULATOR_FASTFORWARDINTERVAL;
+extern const char *SETTINGS_EMULATOR_FASTFORWARDAUDIO;
+
 extern const char *SETTINGS_FILES_OPENROMDIR;
 extern const char *SETTINGS_FILES_RECENTFILELIST;
 
@@ -44,4 +49,5 @@ extern const char *SETTINGS_LOGWINDOW_DISPLAY;
 
 extern const char *SETTINGS_MAINWINDOW_GEOMETRY;
 
-extern const char *SETTINGS_VIDEO_SCALE;
\ No newline at end of file
+extern const char *SETTINGS_VIDEO_SCALE;
+extern const char *SETTINGS_VIDEO_SHADES;
\ No newline at end of file
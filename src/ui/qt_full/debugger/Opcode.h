@@ -18,7 +18,7 @@ public:
     int GetByteCount() const {return byteCount;}
 
 private:
-    Opcode(int byteCount, const QString &opcodeStr, const QString &arg1Str = "", const QString &arg2Str = "");
+    Opcode(const QString &opcodeStr, const QString &arg1Str = "", const QString &arg2Str = "");
     void FormatArg(QString& str, uint16_t pc, const uint8_t *memory);
 
     QString bytesStr;
@@ -0,0 +1,131 @@
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../debugger/Opcode.h"
+
+#include "core/TraceReader.h"
+
+
+void PrintUsage(const char *name)
+{
+    printf("Usage: %s [options] tracefile\n", name);
+    printf("  -r, --regs           Print register values for each instruction\n");
+    printf("  -p, --pc START[-END] Only print instructions with PC in the range (hex)\n");
+    printf("  -b, --bank BANK      Only print instructions executed with ROM bank BANK mapped\n");
+    printf("  -o, --opcode OP      Only print instructions with opcode OP (hex, use CBxx for CB opcodes)\n");
+    printf("  -n, --count COUNT    Stop after printing COUNT instructions\n");
+    printf("  -s, --summary        Only print the number of matching instructions\n");
+}
+
+
+int main(int argc, char *argv[])
+{
+    bool printRegs = false;
+    bool summary = false;
+    uint32_t pcStart = 0x0000;
+    uint32_t pcEnd = 0xFFFF;
+    int bank = -1;
+    int opcode = -1;
+    uint64_t maxCount = UINT64_MAX;
+
+    const struct option longOptions[] = {
+        {"regs", no_argument, NULL, 'r'},
+        {"pc", required_argument, NULL, 'p'},
+        {"bank", required_argument, NULL, 'b'},
+        {"opcode", required_argument, NULL, 'o'},
+        {"count", required_argument, NULL, 'n'},
+        {"summary", no_argument, NULL, 's'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0}
+    };
+
+    int c;
+    while ((c = getopt_long(argc, argv, "rp:b:o:n:sh", longOptions, NULL)) != -1)
+    {
+        switch (c)
+        {
+            case 'r':
+                printRegs = true;
+                break;
+            case 'p':
+            {
+                char *end;
+                pcStart = strtoul(optarg, &end, 16);
+                pcEnd = (*end == '-') ? strtoul(end + 1, NULL, 16) : pcStart;
+                break;
+            }
+            case 'b':
+                bank = strtol(optarg, NULL, 0);
+                break;
+            case 'o':
+                opcode = strtol(optarg, NULL, 16);
+                break;
+            case 'n':
+                maxCount = strtoull(optarg, NULL, 0);
+                break;
+            case 's':
+                summary = true;
+                break;
+            default:
+                PrintUsage(argv[0]);
+                return c == 'h' ? 0 : 1;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    TraceReader reader;
+    if (!reader.Open(argv[optind]))
+    {
+        fprintf(stderr, "Error opening trace file %s\n", argv[optind]);
+        return 1;
+    }
+
+    TraceEntry entry;
+    uint64_t total = 0;
+    uint64_t count = 0;
+
+    while (count < maxCount && reader.Next(entry))
+    {
+        total++;
+
+        if (entry.pc < pcStart || entry.pc > pcEnd)
+            continue;
+        if (bank >= 0 && entry.bank != bank)
+            continue;
+        if (opcode > 0xFF && (entry.opcode[0] != 0xCB || entry.opcode[1] != (opcode & 0xFF)))
+            continue;
+        if (opcode >= 0 && opcode <= 0xFF && entry.opcode[0] != opcode)
+            continue;
+
+        count++;
+
+        if (summary)
+            continue;
+
+        Opcode op = Opcode::GetOpcode(entry.pc, entry.opcode);
+        printf("%12llu %02X:%-28s %-6s", (unsigned long long)entry.clock, entry.bank,
+               op.ToString().toLatin1().data(), op.GetBytesStr().toLatin1().data());
+
+        if (printRegs)
+        {
+            printf(" af=%04X bc=%04X de=%04X hl=%04X sp=%04X", entry.af, entry.bc, entry.de, entry.hl, entry.sp);
+        }
+
+        printf("\n");
+    }
+
+    if (total < reader.GetRecordCount() && count < maxCount)
+        fprintf(stderr, "Trace ended early, read %llu of %llu records\n",
+                (unsigned long long)total, (unsigned long long)reader.GetRecordCount());
+
+    if (summary)
+        printf("%llu of %llu instructions matched\n", (unsigned long long)count, (unsigned long long)total);
+
+    return 0;
+}
\ No newline at end of file